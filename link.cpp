@@ -3,7 +3,17 @@
 // make sure rule linked to executable
 extern int HelloXY;
 extern int BlockMerge;
+extern int Mem2Reg;
+extern int DominatorTree;
+extern int SCCP;
+extern int GVN;
+extern int ADCE;
 
 int HelloLinked          = HelloXY;
 int BlockMergeLinked     = BlockMerge;
+int Mem2RegLinked        = Mem2Reg;
+int DominatorTreeLinked  = DominatorTree;
+int SCCPLinked           = SCCP;
+int GVNLinked            = GVN;
+int ADCELinked           = ADCE;
 
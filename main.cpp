@@ -1,38 +1,256 @@
 #include <iostream>
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
 #include <sys/mman.h>
 
 #include "front/lexer.h"
 #include "front/parser.h"
+#include "lib/buildid.h"
+#include "lib/hash.h"
 #include "opt/pass_manager.h"
+#include "mid/ir/serialize.h"
 #include "mid/walker/analyzer/sema.h"
 #include "mid/walker/irbuilder/irbuilder.h"
 
+#ifdef BUILD_RJIT
+#include "back/jit/jit.h"
+#include "back/interp/interpreter.h"
+#endif
+#include "back/cache/cache.h"
+
+#ifndef RJIT_VERSION
+#define RJIT_VERSION "unknown"
+#endif
+
 using namespace RJIT::front;
 using namespace RJIT::mid;
 using namespace RJIT::mid::analyzer;
 using namespace RJIT::opt;
 
-int main(int argc, char *argv[]) {
-  std::string file = argv[1];
-  Lexer lexer(file);
-  Parser parser(&lexer);
-  parser.Parse();
+static void PrintUsage(const char *prog) {
+  std::cerr << "usage: " << prog << " [options] <file>\n"
+            << "options:\n"
+#ifdef BUILD_RJIT
+            << "  --jit       compile to native code and run 'main'\n"
+            << "  --interp    run 'main' with the bytecode interpreter\n"
+            << "  --tiered    interpret first, compile hot functions to native code\n"
+#endif
+            << "  -O<n>       set optimization level (default 0)\n"
+            << "  --threads <n>         run function passes on <n> threads (default 1)\n"
+            << "  --time-passes         print time and run counts of passes\n"
+            << "  --emit-bin <file>     write optimized IR to binary IR file <file>\n"
+            << "  --cache-dir <dir>     reuse compilation results cached in <dir>\n"
+            << "  --cache-size <bytes>  limit size of cache (default 64 MiB)\n"
+            << "  --cache-stats         print statistics of cache\n"
+            << "  -h, --help  print this message" << std::endl;
+}
+
+// get key of compilation result in cache, empty if source or executable
+// is unreadable
+static std::string CacheKey(const std::string &file, std::string_view mode) {
+  std::ifstream ifs(file, std::ios::binary);
+  if (!ifs || RJIT::lib::BuildId().empty()) return "";
+  std::string source(std::istreambuf_iterator<char>(ifs), {});
 
-  SemAnalyzer semAnalyzer(parser.ast());
-  semAnalyzer.Analyze();
+  // names of passes that will be run
+  std::vector<std::string> passes;
+  for (const auto &[name, info] : PassManager::GetPasses()) {
+    if (!info->is_analysis() && PassManager::opt_level() >= info->min_opt_level()) {
+      passes.push_back(name);
+    }
+  }
+  std::sort(passes.begin(), passes.end());
 
-//  parser.DumpAST();
+  RJIT::lib::Hasher hasher;
+  hasher.Update(source).Update(RJIT_VERSION).Update(RJIT::lib::BuildId())
+        .Update(mode).Update(static_cast<uint64_t>(PassManager::opt_level()));
+  for (const auto &it : passes) hasher.Update(it);
+  return hasher.HexDigest();
+}
 
-  IRBuilder irBuilder(parser.ast());
+// binary IR files are loaded instead of being compiled
+static bool IsBinaryFile(const std::string &file) {
+  constexpr std::string_view ext = ".xyb";
+  return file.size() > ext.size() &&
+         file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+}
 
-  irBuilder.EmitIR();
+static void PrintCacheStats(const RJIT::back::CompileCache &cache) {
+  auto stats = cache.GetStats();
+  std::cerr << "cache: " << stats.hits << " hits, " << stats.misses
+            << " misses, " << stats.entries << " entries, "
+            << stats.bytes << " bytes" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  std::string file, cache_dir, emit_bin;
+  std::size_t opt_level = 0, threads = 1, cache_size = std::size_t(64) << 20;
+  bool cache_stats = false, time_passes = false;
+  [[maybe_unused]] bool run_jit = false, run_interp = false, run_tiered = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-h") || !std::strcmp(argv[i], "--help")) {
+      PrintUsage(argv[0]);
+      return 0;
+    } else if (!std::strncmp(argv[i], "-O", 2) && std::isdigit(argv[i][2])) {
+      opt_level = std::strtoul(argv[i] + 2, nullptr, 10);
+    } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (!std::strcmp(argv[i], "--time-passes")) {
+      time_passes = true;
+    } else if (!std::strcmp(argv[i], "--emit-bin") && i + 1 < argc) {
+      emit_bin = argv[++i];
+    } else if (!std::strcmp(argv[i], "--cache-dir") && i + 1 < argc) {
+      cache_dir = argv[++i];
+    } else if (!std::strcmp(argv[i], "--cache-size") && i + 1 < argc) {
+      cache_size = std::strtoull(argv[++i], nullptr, 10);
+    } else if (!std::strcmp(argv[i], "--cache-stats")) {
+      cache_stats = true;
+#ifdef BUILD_RJIT
+    } else if (!std::strcmp(argv[i], "--jit")) {
+      run_jit = true;
+    } else if (!std::strcmp(argv[i], "--interp")) {
+      run_interp = true;
+    } else if (!std::strcmp(argv[i], "--tiered")) {
+      run_tiered = true;
+#endif
+    } else if (argv[i][0] == '-' || !file.empty()) {
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      file = argv[i];
+    }
+  }
+  if (cache_stats && !cache_dir.empty() && file.empty()) {
+    PrintCacheStats(RJIT::back::CompileCache(cache_dir, cache_size));
+    return 0;
+  }
+  if (file.empty() || run_jit + run_interp + run_tiered > 1 ||
+      (cache_stats && cache_dir.empty())) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
 
   PassManager::Initialize();
-  PassManager::SetModule(irBuilder.module());
-  PassManager::RunPasses();
-  irBuilder.module().Dump(std::cout);
+  PassManager::SetOptLevel(opt_level);
+  PassManager::SetThreads(threads);
+
+  // interpreter needs IR, so only IR dump and native code are cached
+  std::unique_ptr<RJIT::back::CompileCache> cache;
+  std::string cache_key, cached;
+  if (!cache_dir.empty() && emit_bin.empty() && !run_interp && !run_tiered) {
+    cache = std::make_unique<RJIT::back::CompileCache>(cache_dir, cache_size);
+    cache_key = CacheKey(file, run_jit ? "jit" : "ir");
+    if (cache_key.empty()) cache.reset();
+  }
+  if (cache && cache->Lookup(cache_key, cached)) {
+    if (cache_stats) PrintCacheStats(*cache);
+    if (!run_jit) {
+      std::cout << cached;
+      return 0;
+    }
+#ifdef BUILD_RJIT
+    Module module;
+    RJIT::back::JIT jit(module);
+    // fall back to compiling if image is broken
+    if (jit.LoadImage(cached) && jit.GetFunction("main")) return jit.RunMain();
+#endif
+  }
+
+  // load precompiled module, or compile source file
+  std::unique_ptr<Lexer> lexer;
+  std::unique_ptr<Parser> parser;
+  std::unique_ptr<IRBuilder> irBuilder;
+  Module binary_module;
+  Module *module = &binary_module;
+  if (IsBinaryFile(file)) {
+    if (!ReadModule(file, binary_module)) {
+      std::cerr << file << ": error: invalid binary IR file" << std::endl;
+      return 1;
+    }
+  } else {
+    lexer = std::make_unique<Lexer>(file);
+    parser = std::make_unique<Parser>(lexer.get());
+    parser->Parse();
+    if (Logger::errorNum()) return 1;
+
+    SemAnalyzer semAnalyzer(parser->ast());
+    semAnalyzer.Analyze();
+    if (Logger::errorNum()) return 1;
+
+//    parser->DumpAST();
+
+    irBuilder = std::make_unique<IRBuilder>(parser->ast());
+
+    irBuilder->EmitIR();
+    if (Logger::errorNum()) return 1;
+    module = &irBuilder->module();
+  }
+
+  PassManager::SetModule(*module);
+  // tiered mode only optimizes hot functions, binary IR is already
+  // optimized, so that its functions are only loaded when used
+  if (!run_tiered && irBuilder) PassManager::RunPasses();
+  if (time_passes && !run_tiered) PassManager::PrintStats(std::cerr);
+
+  if (!emit_bin.empty()) {
+    if (WriteModule(*module, emit_bin)) return 0;
+    std::cerr << emit_bin << ": error: failed to write binary IR" << std::endl;
+    return 1;
+  }
+
+#ifdef BUILD_RJIT
+  if (run_jit) {
+    // only compile 'main' and its callees
+    auto main_func = module->GetFunction("main");
+    if (!main_func) {
+      std::cerr << file << ": error: function 'main' undefined" << std::endl;
+      return 1;
+    }
+    RJIT::back::JIT jit(*module);
+    if (!jit.Compile({main_func})) return 1;
+    if (cache) {
+      jit.SaveImage(cached);
+      cache->Store(cache_key, cached);
+      if (cache_stats) PrintCacheStats(*cache);
+    }
+    return jit.RunMain();
+  }
+  if (run_interp || run_tiered) {
+    RJIT::back::JIT jit(*module);
+    RJIT::back::interp::Interpreter interp(*module);
+    if (!interp.Compile()) return 1;
+    if (run_tiered) {
+      RJIT::back::interp::TierOptions opts;
+      opts.optimize = [](Function *F) { PassManager::RunPasses(F); };
+      interp.EnableTiering(jit, opts);
+    }
+    if (!interp.GetFunction("main")) {
+      std::cerr << file << ": error: function 'main' undefined" << std::endl;
+      return 1;
+    }
+    auto ret = interp.RunMain();
+    if (time_passes && run_tiered) PassManager::PrintStats(std::cerr);
+    return interp.trapped() ? 1 : ret;
+  }
+#endif
+
+  if (cache) {
+    std::ostringstream oss;
+    module->Dump(oss);
+    cached = oss.str();
+    cache->Store(cache_key, cached);
+    if (cache_stats) PrintCacheStats(*cache);
+    std::cout << cached;
+    return 0;
+  }
+  module->Dump(std::cout);
+  return 0;
 
 //
 //    RJIT::lib::Nested::NestedMapPtr<int, int *> ptr = MakeNestedMap<int, int *>();
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "front/logger.h"
+#include "opt/pass_manager.h"
+#include "mid/ir/irparser.h"
+#include "mid/ir/serialize.h"
+
+using namespace RJIT::front;
+using namespace RJIT::mid;
+using namespace RJIT::opt;
+
+// xycc-opt: read textual or binary IR, run passes and print the result
+
+static void PrintUsage(const char *prog) {
+  std::cerr << "usage: " << prog << " [options] <file>\n"
+            << "options:\n"
+            << "  --passes <a,b,...>    run only the listed passes, in order\n"
+            << "  -O<n>       set optimization level of default passes (default 0)\n"
+            << "  --threads <n>         run function passes on <n> threads (default 1)\n"
+            << "  --time-passes         print time and run counts of passes\n"
+            << "  --list-passes         print names of all registered passes\n"
+            << "  --emit-bin <file>     write IR to binary IR file <file>\n"
+            << "  -h, --help  print this message" << std::endl;
+}
+
+static bool IsBinaryFile(const std::string &file) {
+  constexpr std::string_view ext = ".xyb";
+  return file.size() > ext.size() &&
+         file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+// get passes listed in 'names', return false if any pass is unknown
+static bool GetPassList(const std::string &names, PassPtrList &passes) {
+  std::istringstream iss(names);
+  for (std::string name; std::getline(iss, name, ',');) {
+    if (name.empty()) continue;
+    auto it = PassManager::GetPasses().find(name);
+    if (it == PassManager::GetPasses().end()) {
+      std::cerr << "error: unknown pass '" << name << "'" << std::endl;
+      return false;
+    }
+    passes.push_back(it->second);
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  std::string file, emit_bin, pass_names;
+  std::size_t opt_level = 0, threads = 1;
+  bool list_passes = false, has_passes = false, time_passes = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-h") || !std::strcmp(argv[i], "--help")) {
+      PrintUsage(argv[0]);
+      return 0;
+    } else if (!std::strncmp(argv[i], "-O", 2) && std::isdigit(argv[i][2])) {
+      opt_level = std::strtoul(argv[i] + 2, nullptr, 10);
+    } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (!std::strcmp(argv[i], "--time-passes")) {
+      time_passes = true;
+    } else if (!std::strcmp(argv[i], "--passes") && i + 1 < argc) {
+      pass_names = argv[++i];
+      has_passes = true;
+    } else if (!std::strcmp(argv[i], "--list-passes")) {
+      list_passes = true;
+    } else if (!std::strcmp(argv[i], "--emit-bin") && i + 1 < argc) {
+      emit_bin = argv[++i];
+    } else if (argv[i][0] == '-' || !file.empty()) {
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      file = argv[i];
+    }
+  }
+
+  PassManager::Initialize();
+  PassManager::SetOptLevel(opt_level);
+  PassManager::SetThreads(threads);
+  if (list_passes) {
+    std::vector<std::string> names;
+    for (const auto &[name, info] : PassManager::GetPasses()) {
+      if (!info->is_analysis()) names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    for (const auto &it : names) std::cout << it << std::endl;
+    return 0;
+  }
+  if (file.empty()) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  PassPtrList passes;
+  if (!GetPassList(pass_names, passes)) return 1;
+
+  Module module;
+  if (IsBinaryFile(file)) {
+    if (!ReadModule(file, module)) {
+      std::cerr << file << ": error: invalid binary IR file" << std::endl;
+      return 1;
+    }
+  } else if (!ParseIR(file, module)) {
+    return 1;
+  }
+
+  // run default passes of current optimization level if no pass is listed
+  PassManager::SetModule(module);
+  if (!has_passes) {
+    PassManager::RunPasses();
+  } else if (!passes.empty()) {
+    if (!module.MaterializeAll()) return 1;
+    PassManager::RunPasses(passes);
+  }
+  if (Logger::errorNum()) return 1;
+  if (time_passes) PassManager::PrintStats(std::cerr);
+
+  if (!emit_bin.empty()) {
+    if (WriteModule(module, emit_bin)) return 0;
+    std::cerr << emit_bin << ": error: failed to write binary IR" << std::endl;
+    return 1;
+  }
+  module.Dump(std::cout);
+  return 0;
+}
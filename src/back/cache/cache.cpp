@@ -0,0 +1,123 @@
+#include <unistd.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "back/cache/cache.h"
+
+namespace fs = std::filesystem;
+
+namespace RJIT::back {
+
+namespace {
+
+constexpr const char *kEntryExt = ".xyc";
+constexpr const char *kStatsFile = "stats";
+
+bool ReadFile(const fs::path &path, std::string &data) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) return false;
+  data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+  return !ifs.bad();
+}
+
+// write to a temporary file of current process, then rename
+bool WriteFile(const fs::path &path, const std::string &data) {
+  auto tmp = path;
+  tmp += ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+    if (!ofs.write(data.data(), data.size())) return false;
+  }
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+  if (ec) fs::remove(tmp, ec);
+  return !ec;
+}
+
+bool IsEntry(const fs::directory_entry &entry) {
+  std::error_code ec;
+  return entry.is_regular_file(ec) && entry.path().extension() == kEntryExt;
+}
+
+}
+
+std::string CompileCache::EntryPath(const std::string &key) const {
+  return (fs::path(_dir) / (key + kEntryExt)).string();
+}
+
+bool CompileCache::Lookup(const std::string &key, std::string &data) {
+  auto path = EntryPath(key);
+  bool hit = ReadFile(path, data);
+  if (hit) {
+    // refresh time of entry for LRU eviction
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+  }
+  UpdateStats(hit);
+  return hit;
+}
+
+bool CompileCache::Store(const std::string &key, const std::string &data) {
+  std::error_code ec;
+  fs::create_directories(_dir, ec);
+  if (ec || !WriteFile(EntryPath(key), data)) return false;
+  Evict();
+  return true;
+}
+
+void CompileCache::UpdateStats(bool hit) {
+  std::error_code ec;
+  fs::create_directories(_dir, ec);
+  if (ec) return;
+  auto path = fs::path(_dir) / kStatsFile;
+  CacheStats stats;
+  std::ifstream(path) >> stats.hits >> stats.misses;
+  ++(hit ? stats.hits : stats.misses);
+  WriteFile(path, std::to_string(stats.hits) + " " +
+                  std::to_string(stats.misses) + "\n");
+}
+
+void CompileCache::Evict() {
+  struct Entry {
+    fs::path            path;
+    fs::file_time_type  time;
+    std::uintmax_t      size;
+  };
+  std::vector<Entry> entries;
+  std::uintmax_t total = 0;
+  std::error_code ec;
+  for (const auto &it : fs::directory_iterator(_dir, ec)) {
+    if (!IsEntry(it)) continue;
+    auto time = it.last_write_time(ec);
+    auto size = it.file_size(ec);
+    if (ec) continue;
+    entries.push_back({it.path(), time, size});
+    total += size;
+  }
+  if (total <= _max_bytes) return;
+
+  // remove least recently used entries first
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &lhs, const Entry &rhs) { return lhs.time < rhs.time; });
+  for (const auto &it : entries) {
+    if (total <= _max_bytes) break;
+    if (fs::remove(it.path, ec)) total -= it.size;
+  }
+}
+
+CacheStats CompileCache::GetStats() const {
+  CacheStats stats;
+  std::ifstream(fs::path(_dir) / kStatsFile) >> stats.hits >> stats.misses;
+  std::error_code ec;
+  for (const auto &it : fs::directory_iterator(_dir, ec)) {
+    if (!IsEntry(it)) continue;
+    ++stats.entries;
+    stats.bytes += it.file_size(ec);
+  }
+  return stats;
+}
+
+}
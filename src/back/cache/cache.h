@@ -0,0 +1,50 @@
+#ifndef RJIT_BACK_CACHE_H
+#define RJIT_BACK_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RJIT::back {
+
+// statistics of a cache directory
+struct CacheStats {
+  std::uint64_t hits    = 0;
+  std::uint64_t misses  = 0;
+  std::uint64_t entries = 0;
+  std::uint64_t bytes   = 0;
+};
+
+/* CompileCache
+ * Persistent cache of compilation results in a directory, one file per
+ * key. Entries are written to a temporary file and renamed, so readers
+ * never see partial entries. Hit/miss counters are kept in file 'stats'.
+ * When the total size exceeds the limit, least recently used entries
+ * (by modification time, which is refreshed on hit) are removed.
+ * All operations are best effort, failures only cause misses.
+ */
+class CompileCache {
+private:
+  std::string _dir;
+  std::size_t _max_bytes;
+
+  std::string EntryPath(const std::string &key) const;
+  void        UpdateStats(bool hit);
+  void        Evict();
+
+public:
+  CompileCache(std::string dir, std::size_t max_bytes)
+      : _dir(std::move(dir)), _max_bytes(max_bytes) {}
+
+  // read cached data of key, return false if not found
+  bool Lookup(const std::string &key, std::string &data);
+
+  // store data of key, then evict entries if cache is too large
+  bool Store(const std::string &key, const std::string &data);
+
+  CacheStats GetStats() const;
+};
+
+}
+
+#endif //RJIT_BACK_CACHE_H
@@ -0,0 +1,266 @@
+#include "back/interp/bytecode.h"
+#include "mid/ir/castssa.h"
+#include "mid/ir/constant.h"
+
+namespace RJIT::back::interp {
+
+namespace {
+
+// size of a value in memory, same as native code
+uint32_t MemSize(const TYPE::TypeInfoPtr &type) {
+  if (!type) return 4;
+  if (type->IsPointer()) return 8;
+  return type->GetSize() == 1 ? 1 : 4;
+}
+
+bool IsSigned(const TYPE::TypeInfoPtr &type) {
+  return type && !type->IsUnsigned() && !type->IsBool();
+}
+
+bool HasPHI(const mid::BasicBlock *block) {
+  return !block->insts().empty() &&
+         block->insts().front()->opcode() == mid::Instruction::PHI;
+}
+
+Opcode BinaryOpcode(unsigned opcode) {
+  using Op = mid::Instruction;
+  switch (opcode) {
+    case Op::Add:  return Opcode::Add;
+    case Op::Sub:  return Opcode::Sub;
+    case Op::Mul:  return Opcode::Mul;
+    case Op::UDiv: return Opcode::UDiv;
+    case Op::SDiv: return Opcode::SDiv;
+    case Op::URem: return Opcode::URem;
+    case Op::SRem: return Opcode::SRem;
+    case Op::Shl:  return Opcode::Shl;
+    case Op::LShr: return Opcode::LShr;
+    case Op::AShr: return Opcode::AShr;
+    case Op::And:  return Opcode::And;
+    case Op::Or:   return Opcode::Or;
+    case Op::Xor:  return Opcode::Xor;
+    default:
+      DBG_ASSERT(0, "unknown binary operator");
+      return Opcode::Trap;
+  }
+}
+
+}
+
+uint32_t BytecodeCompiler::NewSlot(uint64_t init) {
+  _bc->frame.push_back(init);
+  return static_cast<uint32_t>(_bc->frame.size() - 1);
+}
+
+uint32_t BytecodeCompiler::SlotOf(mid::Value *value) {
+  DBG_ASSERT(value != nullptr, "slot of null value");
+  auto it = _slots.find(value);
+  if (it != _slots.end()) return it->second;
+
+  uint32_t slot;
+  if (auto cint = dynamic_cast<mid::ConstantInt *>(value)) {
+    slot = NewSlot(cint->value());
+  } else if (auto cstr = dynamic_cast<mid::ConstantString *>(value)) {
+    // string data is owned by module
+    slot = NewSlot(reinterpret_cast<uint64_t>(cstr->value().c_str()));
+  } else {
+    if (!value->isInstruction()) {
+      value->logger().LogError("unsupported value in interpreter");
+      _error = true;
+    }
+    slot = NewSlot();
+  }
+  _slots.insert({value, slot});
+  return slot;
+}
+
+void BytecodeCompiler::Emit(Opcode op, std::initializer_list<uint32_t> operands) {
+  _bc->code.push_back(static_cast<uint32_t>(op));
+  _bc->code.insert(_bc->code.end(), operands);
+}
+
+void BytecodeCompiler::EmitTarget(const mid::SSAPtr &block) {
+  _fixups.push_back({_bc->code.size(), CastTo<mid::BasicBlock>(block)});
+  _bc->code.push_back(0);
+}
+
+void BytecodeCompiler::EmitPhiCopies(const mid::BasicBlock *from,
+                                     const mid::BasicBlock *to) {
+  std::vector<std::pair<uint32_t, uint32_t>> copies;
+  for (const auto &inst : to->insts()) {
+    if (inst->opcode() != mid::Instruction::PHI) break;
+    auto phi = static_cast<mid::PHINode *>(inst);
+    auto value = phi->GetIncomingValueFor(from);
+    if (value && value != phi) copies.push_back({SlotOf(phi), SlotOf(value)});
+  }
+
+  // all copies happen at the same time, so a source that is overwritten
+  // by another copy is saved to a temporary slot first
+  std::size_t temp_num = 0;
+  for (auto &[dst, src] : copies) {
+    for (const auto &it : copies) {
+      if (it.first != src || it.first == dst) continue;
+      if (temp_num == _temp_slots.size()) _temp_slots.push_back(NewSlot());
+      Emit(Opcode::Move, {_temp_slots[temp_num], src});
+      src = _temp_slots[temp_num++];
+      break;
+    }
+  }
+  for (const auto &[dst, src] : copies) Emit(Opcode::Move, {dst, src});
+}
+
+bool BytecodeCompiler::CompileFunction(mid::Function *F, BcFunction &bc) {
+  _bc = &bc;
+  _slots.clear();
+  _block_pcs.clear();
+  _fixups.clear();
+  _temp_slots.clear();
+  _error = false;
+  bc.func = F;
+  bc.code.clear();
+  bc.frame.clear();
+  bc.loops.clear();
+  bc.loop_headers.clear();
+  bc.slots.clear();
+  bc.calls = 0;
+  bc.native = nullptr;
+  auto ret_type = F->type()->GetReturnType();
+  bc.ret_mask = ret_type->IsPointer() ? UINT64_MAX : UINT32_MAX;
+
+  // arguments take the first slots
+  const auto &args = F->args();
+  bc.frame.resize(args.size());
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i]) _slots.insert({args[i], static_cast<uint32_t>(i)});
+  }
+
+  for (const auto &it : *F) {
+    auto block = CastTo<mid::BasicBlock>(it.get());
+    _block_pcs[block] = static_cast<uint32_t>(bc.code.size());
+    for (const auto &inst : block->insts()) {
+      if (!CompileInst(inst, block)) return false;
+    }
+    // block without terminator should never be reached
+    if (block->insts().empty() || !block->insts().back()->isTerminator()) {
+      Emit(Opcode::Trap);
+    }
+  }
+
+  for (const auto &it : _fixups) {
+    auto pc = _block_pcs.find(it.second);
+    DBG_ASSERT(pc != _block_pcs.end(), "jump to block '%s' outside of function",
+               it.second->name().c_str());
+    bc.code[it.first] = pc->second;
+  }
+  // allocas are already mapped to their variables
+  bc.slots.insert(_slots.begin(), _slots.end());
+  return !_error;
+}
+
+bool BytecodeCompiler::CompileInst(mid::Instruction *inst,
+                                   const mid::BasicBlock *block) {
+  using Op = mid::Instruction;
+  switch (inst->opcode()) {
+    case Op::Alloca: {
+      // the variable itself lives in a slot of the frame
+      auto dst = SlotOf(inst), var = NewSlot();
+      Emit(Opcode::Alloca, {dst, var});
+      _bc->slots.insert({inst, var});
+      break;
+    }
+    case Op::Load: {
+      auto load = static_cast<mid::LoadInst *>(inst);
+      auto size = MemSize(inst->type());
+      if (size != 8 && IsSigned(inst->type())) size |= kLoadSigned;
+      auto ptr = SlotOf(load->Pointer());
+      Emit(Opcode::Load, {SlotOf(inst), ptr, size});
+      break;
+    }
+    case Op::Store: {
+      auto store = static_cast<mid::StoreInst *>(inst);
+      auto size = MemSize(store->pointer()->type()->GetDereferenceType());
+      auto src = SlotOf(store->value());
+      Emit(Opcode::Store, {src, SlotOf(store->pointer()), size});
+      break;
+    }
+    case Op::ICmp: {
+      auto icmp = static_cast<mid::ICmpInst *>(inst);
+      auto lhs = SlotOf(icmp->LHS()), rhs = SlotOf(icmp->RHS());
+      Emit(Opcode::ICmp, {SlotOf(inst), lhs, rhs,
+                          static_cast<uint32_t>(icmp->op())});
+      break;
+    }
+    case Op::PHI: SlotOf(inst); break;    // assigned by predecessors
+    case Op::Call: CompileCall(static_cast<mid::CallInst *>(inst)); break;
+    case Op::Br: {
+      auto br = static_cast<mid::BranchInst *>(inst);
+      Emit(Opcode::Br, {SlotOf(br->cond())});
+      auto pos = _bc->code.size();
+      _bc->code.resize(pos + 2);
+      // edges to blocks with phi nodes go through stubs placed after branch
+      for (std::size_t i = 0; i < 2; ++i) {
+        auto succ = CastTo<mid::BasicBlock>((*br)[i + 1].get());
+        if (!HasPHI(succ)) _fixups.push_back({pos + i, succ});
+      }
+      for (std::size_t i = 0; i < 2; ++i) {
+        auto succ = CastTo<mid::BasicBlock>((*br)[i + 1].get());
+        if (!HasPHI(succ)) continue;
+        _bc->code[pos + i] = static_cast<uint32_t>(_bc->code.size());
+        EmitPhiCopies(block, succ);
+        Emit(Opcode::Jmp);
+        EmitTarget(succ);
+      }
+      break;
+    }
+    case Op::Jmp: {
+      auto target = CastTo<mid::BasicBlock>(static_cast<mid::JumpInst *>(inst)->target());
+      EmitPhiCopies(block, target);
+      if (target->name() == "while.cond" && _block_pcs.count(target)) {
+        // back edge of a while loop
+        Emit(Opcode::Loop);
+        EmitTarget(target);
+        _bc->code.push_back(static_cast<uint32_t>(_bc->loops.size()));
+        _bc->loops.push_back(0);
+        _bc->loop_headers.push_back(target);
+      } else {
+        Emit(Opcode::Jmp);
+        EmitTarget(target);
+      }
+      break;
+    }
+    case Op::Ret: {
+      auto ret = static_cast<mid::ReturnInst *>(inst);
+      Emit(Opcode::Ret, {ret->RetVal() ? SlotOf(ret->RetVal()) : kNoSlot});
+      break;
+    }
+    default: {
+      if (inst->isBinaryOp()) {
+        auto lhs = SlotOf((*inst)[0].get()), rhs = SlotOf((*inst)[1].get());
+        Emit(BinaryOpcode(inst->opcode()), {SlotOf(inst), lhs, rhs});
+        break;
+      }
+      inst->logger().LogError("unsupported instruction '" +
+                              inst->GetOpcodeAsString() + "' in interpreter");
+      return false;
+    }
+  }
+  return true;
+}
+
+void BytecodeCompiler::CompileCall(mid::CallInst *inst) {
+  auto callee = CastTo<mid::Function>(inst->Callee());
+  auto id = _func_ids.find(callee);
+  DBG_ASSERT(id != _func_ids.end(), "call to function outside of module");
+
+  // evaluate slots of arguments before emitting the instruction
+  std::vector<uint32_t> args;
+  for (std::size_t i = 1; i < inst->size(); ++i) {
+    args.push_back(SlotOf((*inst)[i].get()));
+  }
+  auto ret_type = inst->type();
+  auto dst = ret_type && !ret_type->IsVoid() ? SlotOf(inst) : kNoSlot;
+
+  Emit(Opcode::Call, {dst, id->second, static_cast<uint32_t>(args.size())});
+  _bc->code.insert(_bc->code.end(), args.begin(), args.end());
+}
+
+}
@@ -0,0 +1,105 @@
+#ifndef RJIT_BACK_INTERP_BYTECODE_H
+#define RJIT_BACK_INTERP_BYTECODE_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+
+#include "mid/ir/ssa.h"
+
+namespace RJIT::back::interp {
+
+// bytecode opcodes, one for each IR instruction the interpreter supports,
+// and internal ones:
+//   Loop       - jump back to loop header, counts back edges
+//   Move       - copy slot, assigns phi nodes on edges
+//   CallNative - call site patched to native code of callee
+//   Trap       - end of a block without terminator
+#define BYTECODE_OPS(E)                                                  \
+  E(Ret) E(Br) E(Jmp)                                                    \
+  E(Add) E(Sub) E(Mul) E(UDiv) E(SDiv) E(URem) E(SRem)                   \
+  E(Shl) E(LShr) E(AShr) E(And) E(Or) E(Xor)                             \
+  E(Alloca) E(Load) E(Store) E(ICmp) E(Call)                             \
+  E(Loop) E(Move) E(CallNative) E(Trap)
+
+enum class Opcode : uint32_t {
+#define BYTECODE_ENUM(name) name,
+  BYTECODE_OPS(BYTECODE_ENUM)
+#undef BYTECODE_ENUM
+};
+
+// slot operand of a 'Ret'/'Call' without value
+constexpr uint32_t kNoSlot = UINT32_MAX;
+// flag of 'Load' size operand, sign extend the loaded value
+constexpr uint32_t kLoadSigned = 0x100;
+
+/* BcFunction
+ * Register-based bytecode of a function. Instructions are encoded as
+ * words, an opcode followed by its operands:
+ *
+ *   Ret    src                   Alloca dst, cell
+ *   Br     cond, true, false     Load   dst, ptr, size[|kLoadSigned]
+ *   Jmp    target                Store  src, ptr, size
+ *   Loop   target, counter       ICmp   dst, lhs, rhs, operator
+ *   <bin>  dst, lhs, rhs         Move   dst, src
+ *   Trap
+ *   Call/CallNative   dst, callee, argc, args...
+ *
+ * Operands are indices of 64-bit slots in the frame, jump targets are
+ * word offsets in 'code'. The first slots hold arguments, 'frame' is
+ * the initial content of a frame, with constants already filled in.
+ * Counters, native entry and slots of IR values are used by tiered
+ * execution and on-stack replacement.
+ */
+struct BcFunction {
+  mid::Function                                   *func = nullptr;
+  std::vector<uint32_t>                            code;
+  std::vector<uint64_t>                            frame;
+  uint64_t                                         ret_mask = 0;      // mask of value returned by native code
+  uint32_t                                         calls = 0;         // call counter
+  std::vector<uint32_t>                            loops;             // back edge counters
+  std::vector<const mid::BasicBlock *>             loop_headers;      // header of each loop counter
+  std::unordered_map<const mid::Value *, uint32_t> slots;             // slots of values, allocas map to variables
+  std::vector<void *>                              osr_entries;       // OSR entry of each loop counter, may be null
+  std::vector<std::vector<uint32_t>>               osr_slots;         // slots passed to each OSR entry
+  void                                            *native = nullptr;  // native entry, null if not compiled
+};
+
+/* BytecodeCompiler
+ * Lower a function of the IR to bytecode. Values are numbered densely
+ * in order of first appearance, so that frames stay compact.
+ */
+class BytecodeCompiler {
+private:
+  const std::unordered_map<const mid::Function *, uint32_t> &_func_ids;
+  BcFunction                                                *_bc;
+  std::unordered_map<const mid::Value *, uint32_t>           _slots;
+  std::unordered_map<const mid::BasicBlock *, uint32_t>      _block_pcs;
+  std::vector<std::pair<std::size_t, const mid::BasicBlock *>> _fixups;
+  std::vector<uint32_t>                                      _temp_slots;   // for phi copies
+  bool                                                       _error;
+
+  uint32_t NewSlot(uint64_t init = 0);
+  uint32_t SlotOf(mid::Value *value);
+  void     Emit(Opcode op, std::initializer_list<uint32_t> operands = {});
+  void     EmitTarget(const mid::SSAPtr &block);
+  // assign phi nodes of 'to' on edge 'from' -> 'to'
+  void     EmitPhiCopies(const mid::BasicBlock *from, const mid::BasicBlock *to);
+
+  bool CompileInst(mid::Instruction *inst, const mid::BasicBlock *block);
+  void CompileCall(mid::CallInst *inst);
+
+public:
+  // 'func_ids' maps every function of module to its index
+  explicit BytecodeCompiler(
+      const std::unordered_map<const mid::Function *, uint32_t> &func_ids)
+      : _func_ids(func_ids), _bc(nullptr), _error(false) {}
+
+  // compile function 'F' to 'bc', return false if failed
+  bool CompileFunction(mid::Function *F, BcFunction &bc);
+};
+
+}
+
+#endif //RJIT_BACK_INTERP_BYTECODE_H
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "back/interp/interpreter.h"
+
+// use computed goto for dispatch if compiler supports labels as values
+#if defined(__GNUC__) || defined(__clang__)
+#define RJIT_THREADED_DISPATCH 1
+#else
+#define RJIT_THREADED_DISPATCH 0
+#endif
+
+namespace RJIT::back::interp {
+
+namespace {
+
+// size of slot stack shared by all frames (8 MiB)
+constexpr std::size_t kStackSlots = 1 << 20;
+// limit of nested calls, each call also takes a native frame
+constexpr std::size_t kMaxCallDepth = 1 << 14;
+// native code is called with a fixed number of integer arguments, extra
+// ones are ignored by callee in System V ABI
+constexpr std::size_t kMaxNativeArgs = 16;
+
+using NativeFunc = uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t,
+                                uint64_t, uint64_t, uint64_t, uint64_t,
+                                uint64_t, uint64_t, uint64_t, uint64_t,
+                                uint64_t, uint64_t, uint64_t, uint64_t);
+
+uint64_t CallNative(void *entry, const uint64_t *a) {
+  return reinterpret_cast<NativeFunc>(entry)(a[0], a[1], a[2], a[3],
+                                             a[4], a[5], a[6], a[7],
+                                             a[8], a[9], a[10], a[11],
+                                             a[12], a[13], a[14], a[15]);
+}
+
+template <typename T>
+T ReadMem(uint64_t addr) {
+  T value;
+  std::memcpy(&value, reinterpret_cast<const void *>(addr), sizeof(T));
+  return value;
+}
+
+template <typename T>
+void WriteMem(uint64_t addr, T value) {
+  std::memcpy(reinterpret_cast<void *>(addr), &value, sizeof(T));
+}
+
+bool Compare(uint32_t op, uint32_t lhs, uint32_t rhs) {
+  using AST::Operator;
+  auto slhs = static_cast<int32_t>(lhs), srhs = static_cast<int32_t>(rhs);
+  switch (static_cast<Operator>(op)) {
+    case Operator::Equal:    return lhs == rhs;
+    case Operator::NotEqual: return lhs != rhs;
+    case Operator::SLess:    return slhs < srhs;
+    case Operator::SLessEq:  return slhs <= srhs;
+    case Operator::SGreat:   return slhs > srhs;
+    case Operator::SGreatEq: return slhs >= srhs;
+    case Operator::ULess:    return lhs < rhs;
+    case Operator::ULessEq:  return lhs <= rhs;
+    case Operator::UGreat:   return lhs > rhs;
+    case Operator::UGreatEq: return lhs >= rhs;
+    default:
+      DBG_ASSERT(0, "unknown compare operator");
+      return false;
+  }
+}
+
+}
+
+bool Interpreter::Compile() {
+  _funcs.clear();
+  _func_ids.clear();
+  const auto &funcs = _module.Functions();
+  for (std::size_t i = 0; i < funcs.size(); ++i) {
+    _func_ids[funcs[i]] = static_cast<uint32_t>(i);
+  }
+
+  _funcs.resize(funcs.size());
+  BytecodeCompiler compiler(_func_ids);
+  for (std::size_t i = 0; i < funcs.size(); ++i) {
+    if (!_module.Materialize(funcs[i])) return false;
+    if (!compiler.CompileFunction(funcs[i], _funcs[i])) return false;
+  }
+  return true;
+}
+
+const BcFunction *Interpreter::GetFunction(std::string_view name) const {
+  auto func = _module.GetFunction(name);
+  if (!func) return nullptr;
+  auto it = _func_ids.find(func);
+  return it != _func_ids.end() ? &_funcs[it->second] : nullptr;
+}
+
+int Interpreter::RunMain() {
+  auto it = _func_ids.find(_module.GetFunction("main"));
+  DBG_ASSERT(it != _func_ids.end(), "function 'main' is not compiled");
+  auto main = &_funcs[it->second];
+
+  _stack.assign(kStackSlots, 0);
+  _depth = 0;
+  _executed = 0;
+  _trapped = false;
+  if (main->frame.size() > _stack.size()) {
+    Trap(*main, "stack overflow");
+    return 0;
+  }
+  std::copy(main->frame.begin(), main->frame.end(), _stack.begin());
+  auto ret = _count_executed ? Execute<true>(*main, _stack.data())
+                             : Execute<false>(*main, _stack.data());
+  _stack.clear();
+  _stack.shrink_to_fit();
+  return static_cast<int>(static_cast<uint32_t>(ret));
+}
+
+void Interpreter::TierUp(BcFunction &F) {
+  auto funcs = _jit->CollectUncompiled(F.func);
+
+  // OSR entries are generated before optimization, values at loop headers
+  // of optimized code (e.g. phi nodes of promoted variables) have no slots
+  struct PendingOSR {
+    BcFunction            *bc;
+    uint32_t               loop;
+    JIT::OSRCode           code;
+    std::vector<uint32_t>  slots;
+  };
+  std::vector<PendingOSR> pending;
+  for (const auto &func : funcs) {
+    auto &bc = _funcs[_func_ids[func]];
+    bc.osr_entries.assign(bc.loops.size(), nullptr);
+    bc.osr_slots.assign(bc.loops.size(), {});
+    for (uint32_t i = 0; i < bc.loops.size(); ++i) {
+      PendingOSR osr = {&bc, i, {}, {}};
+      if (!_jit->GenerateOSR(func, bc.loop_headers[i], osr.code)) continue;
+      bool known = true;
+      for (const auto &value : osr.code.values) {
+        auto it = bc.slots.find(value);
+        if (it == bc.slots.end()) {
+          known = false;
+          break;
+        }
+        osr.slots.push_back(it->second);
+      }
+      if (known) pending.push_back(std::move(osr));
+    }
+  }
+
+  if (_tier_opts.optimize) {
+    for (const auto &func : funcs) _tier_opts.optimize(func);
+  }
+  // keep interpreting if failed, counters stop at threshold so that
+  // there is no second try
+  if (!_jit->Compile(funcs)) return;
+  for (const auto &func : funcs) {
+    if (func->args().size() > kMaxNativeArgs) continue;
+    _funcs[_func_ids[func]].native = _jit->GetEntry(func);
+  }
+  for (auto &osr : pending) {
+    osr.bc->osr_entries[osr.loop] = _jit->CommitOSR(osr.code);
+    osr.bc->osr_slots[osr.loop] = std::move(osr.slots);
+  }
+}
+
+bool Interpreter::EnterOSR(BcFunction &F, uint64_t *frame, uint32_t loop,
+                           uint64_t &ret) {
+  if (!F.native || loop >= F.osr_entries.size() || !F.osr_entries[loop]) {
+    return false;
+  }
+  std::vector<uint64_t> live;
+  for (const auto &slot : F.osr_slots[loop]) live.push_back(frame[slot]);
+  using OSREntry = uint64_t (*)(const uint64_t *);
+  ret = reinterpret_cast<OSREntry>(F.osr_entries[loop])(live.data()) & F.ret_mask;
+  return true;
+}
+
+void Interpreter::Trap(const BcFunction &F, const char *message) {
+  std::cerr << "runtime error: " << message << " in function '"
+            << F.func->GetFunctionName() << "'" << std::endl;
+  _trapped = true;
+}
+
+template <bool kCount>
+uint64_t Interpreter::Execute(BcFunction &F, uint64_t *frame) {
+  uint32_t *code = F.code.data();
+  const uint32_t *pc = code;
+
+#if RJIT_THREADED_DISPATCH
+  static void *const kLabels[] = {
+#define BYTECODE_LABEL(name) &&L_##name,
+    BYTECODE_OPS(BYTECODE_LABEL)
+#undef BYTECODE_LABEL
+  };
+#define DISPATCH()                      \
+  do {                                  \
+    if constexpr (kCount) ++_executed;  \
+    goto *kLabels[*pc];                 \
+  } while (0)
+#define CASE(name) L_##name:
+  DISPATCH();
+  {
+#else
+#define DISPATCH() continue
+#define CASE(name) case Opcode::name:
+  for (;;) switch (_executed += kCount, static_cast<Opcode>(*pc)) {
+#endif
+
+// lhs, rhs are 32-bit values in slots
+#define BINARY_OP(name, expr)                                        \
+  CASE(name) {                                                       \
+    auto lhs = static_cast<uint32_t>(frame[pc[2]]);                  \
+    auto rhs = static_cast<uint32_t>(frame[pc[3]]);                  \
+    frame[pc[1]] = static_cast<uint32_t>(expr);                      \
+    pc += 4;                                                         \
+    DISPATCH();                                                      \
+  }
+
+    BINARY_OP(Add, lhs + rhs)
+    BINARY_OP(Sub, lhs - rhs)
+    BINARY_OP(Mul, lhs * rhs)
+    BINARY_OP(And, lhs & rhs)
+    BINARY_OP(Or,  lhs | rhs)
+    BINARY_OP(Xor, lhs ^ rhs)
+    // shift count is masked as x86 does
+    BINARY_OP(Shl,  lhs << (rhs & 31))
+    BINARY_OP(LShr, lhs >> (rhs & 31))
+    BINARY_OP(AShr, static_cast<int32_t>(lhs) >> (rhs & 31))
+#undef BINARY_OP
+
+// division traps on zero divisor and on overflow of signed division
+#define DIVISION_OP(name, expr, is_signed)                           \
+  CASE(name) {                                                       \
+    auto lhs = static_cast<uint32_t>(frame[pc[2]]);                  \
+    auto rhs = static_cast<uint32_t>(frame[pc[3]]);                  \
+    if (!rhs) {                                                      \
+      Trap(F, "division by zero");                                   \
+      return 0;                                                      \
+    }                                                                \
+    if (is_signed && rhs == UINT32_MAX &&                            \
+        lhs == static_cast<uint32_t>(INT32_MIN)) {                   \
+      Trap(F, "overflow in signed division");                        \
+      return 0;                                                      \
+    }                                                                \
+    frame[pc[1]] = static_cast<uint32_t>(expr);                      \
+    pc += 4;                                                         \
+    DISPATCH();                                                      \
+  }
+
+    DIVISION_OP(UDiv, lhs / rhs, false)
+    DIVISION_OP(URem, lhs % rhs, false)
+    DIVISION_OP(SDiv, static_cast<int32_t>(lhs) / static_cast<int32_t>(rhs), true)
+    DIVISION_OP(SRem, static_cast<int32_t>(lhs) % static_cast<int32_t>(rhs), true)
+#undef DIVISION_OP
+
+    CASE(ICmp) {
+      auto lhs = static_cast<uint32_t>(frame[pc[2]]);
+      auto rhs = static_cast<uint32_t>(frame[pc[3]]);
+      frame[pc[1]] = Compare(pc[4], lhs, rhs);
+      pc += 5;
+      DISPATCH();
+    }
+
+    CASE(Alloca) {
+      frame[pc[1]] = reinterpret_cast<uint64_t>(&frame[pc[2]]);
+      pc += 3;
+      DISPATCH();
+    }
+
+    CASE(Load) {
+      auto addr = frame[pc[2]];
+      switch (pc[3]) {
+        case 1: frame[pc[1]] = ReadMem<uint8_t>(addr); break;
+        case 1 | kLoadSigned:
+          frame[pc[1]] = static_cast<uint32_t>(ReadMem<int8_t>(addr));
+          break;
+        case 8: frame[pc[1]] = ReadMem<uint64_t>(addr); break;
+        default: frame[pc[1]] = ReadMem<uint32_t>(addr); break;
+      }
+      pc += 4;
+      DISPATCH();
+    }
+
+    CASE(Store) {
+      auto value = frame[pc[1]], addr = frame[pc[2]];
+      switch (pc[3]) {
+        case 1: WriteMem(addr, static_cast<uint8_t>(value)); break;
+        case 8: WriteMem(addr, value); break;
+        default: WriteMem(addr, static_cast<uint32_t>(value)); break;
+      }
+      pc += 4;
+      DISPATCH();
+    }
+
+    CASE(Call) {
+      auto &callee = _funcs[pc[2]];
+      auto argc = pc[3];
+      auto threshold = _tier_opts.call_threshold;
+      if (_jit && !callee.native && callee.calls < threshold &&
+          ++callee.calls == threshold) {
+        TierUp(callee);
+      }
+      if (callee.native) {
+        // patch call site, then execute it again
+        code[pc - code] = static_cast<uint32_t>(Opcode::CallNative);
+        DISPATCH();
+      }
+
+      // frame of callee is placed right after current frame
+      auto callee_frame = frame + F.frame.size();
+      auto stack_end = _stack.data() + _stack.size();
+      if (_depth >= kMaxCallDepth ||
+          static_cast<std::size_t>(stack_end - callee_frame) < callee.frame.size()) {
+        Trap(F, "stack overflow");
+        return 0;
+      }
+      std::copy(callee.frame.begin(), callee.frame.end(), callee_frame);
+      for (uint32_t i = 0; i < argc; ++i) callee_frame[i] = frame[pc[4 + i]];
+
+      ++_depth;
+      auto ret = Execute<kCount>(callee, callee_frame);
+      --_depth;
+      if (_trapped) return 0;
+      if (pc[1] != kNoSlot) frame[pc[1]] = ret;
+      pc += 4 + argc;
+      DISPATCH();
+    }
+
+    CASE(CallNative) {
+      const auto &callee = _funcs[pc[2]];
+      auto argc = pc[3];
+      uint64_t args[kMaxNativeArgs] = {};
+      for (uint32_t i = 0; i < argc; ++i) args[i] = frame[pc[4 + i]];
+      auto ret = CallNative(callee.native, args);
+      if (pc[1] != kNoSlot) frame[pc[1]] = ret & callee.ret_mask;
+      pc += 4 + argc;
+      DISPATCH();
+    }
+
+    CASE(Br) {
+      pc = code + (static_cast<uint32_t>(frame[pc[1]]) ? pc[2] : pc[3]);
+      DISPATCH();
+    }
+
+    CASE(Jmp) {
+      pc = code + pc[1];
+      DISPATCH();
+    }
+
+    CASE(Loop) {
+      auto &counter = F.loops[pc[2]];
+      auto threshold = _tier_opts.loop_threshold;
+      if (_jit && counter < threshold && ++counter == threshold) {
+        if (!F.native) TierUp(F);
+        // jumping back to header, so enter native code there
+        uint64_t ret;
+        if (EnterOSR(F, frame, pc[2], ret)) return ret;
+      }
+      pc = code + pc[1];
+      DISPATCH();
+    }
+
+    CASE(Move) {
+      frame[pc[1]] = frame[pc[2]];
+      pc += 3;
+      DISPATCH();
+    }
+
+    CASE(Ret) {
+      return pc[1] != kNoSlot ? frame[pc[1]] : 0;
+    }
+
+    CASE(Trap) {
+      Trap(F, "reached block without terminator");
+      return 0;
+    }
+  }
+
+#undef DISPATCH
+#undef CASE
+}
+
+}
@@ -0,0 +1,93 @@
+#ifndef RJIT_BACK_INTERP_INTERPRETER_H
+#define RJIT_BACK_INTERP_INTERPRETER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "back/interp/bytecode.h"
+#include "back/jit/jit.h"
+#include "mid/ir/module.h"
+
+namespace RJIT::back::interp {
+
+// options of tiered execution
+struct TierOptions {
+  uint32_t call_threshold = 100;      // calls before compiling a function
+  uint32_t loop_threshold = 10000;    // back edges before compiling a function
+  // optimize function before it is compiled to native code
+  std::function<void(mid::Function *)> optimize;
+};
+
+/* Interpreter
+ * Compile all functions of a module to bytecode and execute them with
+ * threaded dispatch (computed goto when supported by compiler).
+ * Frames of calls are allocated contiguously from a slot stack, errors
+ * at runtime (division by zero, stack overflow) stop the execution.
+ * With tiering enabled, a function whose call counter or one of its
+ * back edge counters crosses the threshold is optimized and compiled to
+ * native code along with its callees, call sites reaching it are then
+ * patched to call the native entry. A loop that gets hot also transfers
+ * the running invocation to native code (on-stack replacement), live
+ * values of interpreter frame are passed to an entry at loop header.
+ */
+class Interpreter {
+private:
+  mid::Module                                      &_module;
+  std::vector<BcFunction>                           _funcs;
+  std::unordered_map<const mid::Function *, uint32_t> _func_ids;
+  std::vector<uint64_t>                             _stack;
+  std::size_t                                       _depth;
+  uint64_t                                          _executed;
+  bool                                              _count_executed;
+  bool                                              _trapped;
+  JIT                                              *_jit;
+  TierOptions                                       _tier_opts;
+
+  // instructions are only counted by the instance with 'kCount' set,
+  // so that normal runs pay nothing for it
+  template <bool kCount>
+  uint64_t Execute(BcFunction &F, uint64_t *frame);
+  void     Trap(const BcFunction &F, const char *message);
+  void     TierUp(BcFunction &F);
+  // continue invocation of 'F' in native code at header of 'loop',
+  // return false if not possible
+  bool     EnterOSR(BcFunction &F, uint64_t *frame, uint32_t loop, uint64_t &ret);
+
+public:
+  explicit Interpreter(mid::Module &module)
+      : _module(module), _depth(0), _executed(0), _count_executed(false),
+        _trapped(false), _jit(nullptr) {}
+
+  // promote hot functions to native code generated by 'jit'
+  void EnableTiering(JIT &jit, TierOptions opts) {
+    _jit = &jit;
+    _tier_opts = std::move(opts);
+  }
+
+  // compile all functions in module, return false if failed
+  bool Compile();
+
+  // get bytecode of function, nullptr if not found
+  const BcFunction *GetFunction(std::string_view name) const;
+
+  // call 'main' function, return its return value
+  int RunMain();
+
+  // true if the last run stopped by a runtime error
+  bool trapped() const { return _trapped; }
+
+  // count executed bytecode instructions in later runs
+  void set_count_executed(bool count) { _count_executed = count; }
+
+  // number of bytecode instructions executed by the last run if counted,
+  // code running natively after tier-up is not counted
+  uint64_t executed() const { return _executed; }
+};
+
+}
+
+#endif //RJIT_BACK_INTERP_INTERPRETER_H
@@ -0,0 +1,260 @@
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <unordered_set>
+
+#include "back/jit/jit.h"
+#include "lib/buildid.h"
+#include "mid/ir/castssa.h"
+
+namespace RJIT::back {
+
+namespace {
+
+// size of virtual address range reserved for code (256 MiB), pages
+// are only committed when a batch is placed
+constexpr std::size_t kCodeRegionSize = std::size_t(1) << 28;
+
+// magic number of code image
+constexpr uint32_t kImageMagic = 0x494a5958;  // "XYJI"
+
+template <typename T>
+void WriteImage(std::string &image, T value) {
+  image.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadImage(const std::string &image, std::size_t &pos, T &value) {
+  if (image.size() - pos < sizeof(T)) return false;
+  std::memcpy(&value, image.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+std::size_t PageSize() {
+  static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+}
+
+bool JIT::Reserve() {
+  if (_code) return true;
+  auto mem = mmap(nullptr, kCodeRegionSize, PROT_NONE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mem == MAP_FAILED) return false;
+  _code = mem;
+  _code_size = 0;
+  return true;
+}
+
+void JIT::Release() {
+  if (_code) munmap(_code, kCodeRegionSize);
+  _code = nullptr;
+  _code_size = 0;
+  _entries.clear();
+  _symbols.clear();
+}
+
+bool JIT::Compile() {
+  Release();
+  std::vector<mid::Function *> funcs(_module.Functions().begin(),
+                                     _module.Functions().end());
+  return Compile(funcs);
+}
+
+std::vector<mid::Function *> JIT::CollectUncompiled(mid::Function *F) const {
+  std::vector<mid::Function *> funcs;
+  std::unordered_set<const mid::Function *> visited;
+  std::vector<mid::Function *> worklist = {F};
+  while (!worklist.empty()) {
+    auto func = worklist.back();
+    worklist.pop_back();
+    if (_entries.count(func) || !visited.insert(func).second) continue;
+    funcs.push_back(func);
+    // body is checked again when compiling
+    if (!_module.Materialize(func)) continue;
+    for (const auto &it : *func) {
+      auto block = CastTo<mid::BasicBlock>(it.get());
+      for (const auto &inst : block->insts()) {
+        if (inst->opcode() != mid::Instruction::Call) continue;
+        auto call = static_cast<mid::CallInst *>(inst);
+        worklist.push_back(CastTo<mid::Function>(call->Callee()));
+      }
+    }
+  }
+  return funcs;
+}
+
+bool JIT::Compile(const std::vector<mid::Function *> &funcs) {
+  if (!Reserve()) return false;
+
+  // compile callees in the same batch if they are not compiled yet
+  std::vector<mid::Function *> batch;
+  std::unordered_set<const mid::Function *> in_batch;
+  for (const auto &func : funcs) {
+    for (const auto &it : CollectUncompiled(func)) {
+      if (in_batch.insert(it).second) batch.push_back(it);
+    }
+  }
+  if (batch.empty()) return true;
+
+  x86::Assembler assembler;
+  x86::CallRelocList relocs;
+  x86::CodeGen codegen(assembler, relocs);
+  std::unordered_map<const mid::Function *, std::size_t> offsets;
+
+  for (const auto &func : batch) {
+    // align function entries to 16 bytes with int3
+    while (assembler.size() % 16) assembler.Emit8(0xcc);
+    offsets[func] = assembler.size();
+    if (!_module.Materialize(func) || !codegen.GenerateFunction(func)) return false;
+  }
+
+  auto base = Commit(assembler, relocs, offsets);
+  if (!base) return false;
+  for (const auto &it : offsets) {
+    auto entry = base + it.second;
+    auto ret_void = it.first->type()->GetReturnType()->IsVoid();
+    _entries[it.first] = entry;
+    _symbols[it.first->GetFunctionName()] = {entry, ret_void};
+  }
+  return true;
+}
+
+bool JIT::GenerateOSR(mid::Function *F, const mid::BasicBlock *header,
+                      OSRCode &code) {
+  if (!_module.Materialize(F)) return false;
+  x86::CodeGen codegen(code.assembler, code.relocs);
+  return codegen.GenerateOSREntry(F, header, code.values);
+}
+
+void *JIT::CommitOSR(OSRCode &code) {
+  // callees are called through their normal entries
+  std::vector<mid::Function *> callees;
+  for (const auto &reloc : code.relocs) callees.push_back(reloc.callee);
+  if (!Compile(callees)) return nullptr;
+  return Commit(code.assembler, code.relocs, {});
+}
+
+char *JIT::Commit(x86::Assembler &assembler, const x86::CallRelocList &relocs,
+                  const std::unordered_map<const mid::Function *, std::size_t> &offsets) {
+  // check if the code fits in reserved region
+  const auto &code = assembler.code();
+  auto size = (code.size() + PageSize() - 1) & ~(PageSize() - 1);
+  if (_code_size + size > kCodeRegionSize) return nullptr;
+  auto base = static_cast<char *>(_code) + _code_size;
+
+  // resolve calls to functions of current batch or previous batches
+  for (const auto &reloc : relocs) {
+    int64_t target;
+    auto it = offsets.find(reloc.callee);
+    if (it != offsets.end()) {
+      target = static_cast<int64_t>(it->second);
+    } else if (auto entry = GetEntry(reloc.callee)) {
+      target = static_cast<char *>(entry) - base;
+    } else {
+      reloc.callee->logger().LogError("function '" +
+          reloc.callee->GetFunctionName() + "' is not compiled");
+      return nullptr;
+    }
+    auto rel = target - static_cast<int64_t>(reloc.pos + 4);
+    assembler.Patch32(reloc.pos, static_cast<uint32_t>(rel));
+  }
+
+  // copy code to executable memory
+  if (mprotect(base, size, PROT_READ | PROT_WRITE)) return nullptr;
+  std::memcpy(base, code.data(), code.size());
+  if (mprotect(base, size, PROT_READ | PROT_EXEC)) return nullptr;
+  _code_size += size;
+  return base;
+}
+
+void JIT::SaveImage(std::string &image) const {
+  image.clear();
+  WriteImage(image, kImageMagic);
+  // code is only valid for the build that generated it
+  const auto &build_id = lib::BuildId();
+  WriteImage(image, static_cast<uint32_t>(build_id.size()));
+  image.append(build_id);
+  WriteImage(image, static_cast<uint64_t>(_code_size));
+  image.append(static_cast<const char *>(_code), _code_size);
+  WriteImage(image, static_cast<uint32_t>(_symbols.size()));
+  for (const auto &[name, sym] : _symbols) {
+    WriteImage(image, static_cast<uint32_t>(name.size()));
+    image.append(name);
+    WriteImage(image, static_cast<uint64_t>(static_cast<char *>(sym.entry) -
+                                            static_cast<char *>(_code)));
+    WriteImage(image, static_cast<uint8_t>(sym.ret_void));
+  }
+}
+
+bool JIT::LoadImage(const std::string &image) {
+  Release();
+  std::size_t pos = 0;
+  uint32_t magic, id_len;
+  uint64_t size;
+  if (!ReadImage(image, pos, magic) || magic != kImageMagic) return false;
+  const auto &build_id = lib::BuildId();
+  if (!ReadImage(image, pos, id_len) || id_len != build_id.size() ||
+      image.compare(pos, id_len, build_id)) {
+    return false;
+  }
+  pos += id_len;
+  if (!ReadImage(image, pos, size) || size > kCodeRegionSize ||
+      size % PageSize() || image.size() - pos < size) {
+    return false;
+  }
+  if (!Reserve()) return false;
+
+  // copy code to executable memory
+  if (size) {
+    if (mprotect(_code, size, PROT_READ | PROT_WRITE)) return false;
+    std::memcpy(_code, image.data() + pos, size);
+    if (mprotect(_code, size, PROT_READ | PROT_EXEC)) return false;
+  }
+  _code_size = size;
+  pos += size;
+
+  // read symbols
+  uint32_t count;
+  if (!ReadImage(image, pos, count)) return false;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t len;
+    uint64_t offset;
+    uint8_t ret_void;
+    if (!ReadImage(image, pos, len) || image.size() - pos < len) return false;
+    auto name = image.substr(pos, len);
+    pos += len;
+    if (!ReadImage(image, pos, offset) || !ReadImage(image, pos, ret_void) ||
+        offset >= size) {
+      return false;
+    }
+    _symbols[name] = {static_cast<char *>(_code) + offset, ret_void != 0};
+  }
+  return pos == image.size();
+}
+
+void *JIT::GetFunction(std::string_view name) const {
+  auto it = _symbols.find(std::string(name));
+  return it != _symbols.end() ? it->second.entry : nullptr;
+}
+
+void *JIT::GetEntry(const mid::Function *F) const {
+  auto it = _entries.find(F);
+  return it != _entries.end() ? it->second : nullptr;
+}
+
+int JIT::RunMain() const {
+  auto it = _symbols.find("main");
+  DBG_ASSERT(it != _symbols.end(), "function 'main' is not compiled");
+
+  auto entry = it->second.entry;
+  if (it->second.ret_void) {
+    reinterpret_cast<void (*)()>(entry)();
+    return 0;
+  }
+  return reinterpret_cast<int (*)()>(entry)();
+}
+
+}
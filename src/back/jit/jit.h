@@ -0,0 +1,100 @@
+#ifndef RJIT_BACK_JIT_H
+#define RJIT_BACK_JIT_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "back/x86/codegen.h"
+#include "mid/ir/module.h"
+
+namespace RJIT::back {
+
+/* JIT
+ * Compile functions of a module to x86-64 machine code, place the code
+ * in an executable memory region and run it in current process.
+ * Functions can be compiled in several batches, all batches live in one
+ * reserved region so that calls between them are still 'call rel32'.
+ * Pages of a batch are mapped writable while being filled, then remapped
+ * read-only and executable.
+ * Code never refers to absolute addresses, so the whole region can be
+ * saved as an image and loaded again in another process.
+ */
+class JIT {
+public:
+  // code of an on-stack replacement entry that is not placed yet
+  struct OSRCode {
+    x86::Assembler                  assembler;
+    x86::CallRelocList              relocs;
+    std::vector<const mid::Value *> values;   // IR values the caller should pass
+  };
+
+private:
+  // compiled function that can be looked up by name
+  struct Symbol {
+    void *entry;
+    bool  ret_void;
+  };
+
+  mid::Module                                         &_module;
+  void                                                *_code;
+  std::size_t                                          _code_size;
+  std::unordered_map<const mid::Function *, void *>    _entries;
+  std::unordered_map<std::string, Symbol>              _symbols;
+
+  bool Reserve();
+  void Release();
+
+  // resolve calls of assembled code, then place it in executable memory,
+  // return base address of code or nullptr if failed
+  char *Commit(x86::Assembler &assembler, const x86::CallRelocList &relocs,
+               const std::unordered_map<const mid::Function *, std::size_t> &offsets);
+
+public:
+  explicit JIT(mid::Module &module)
+      : _module(module), _code(nullptr), _code_size(0) {}
+
+  JIT(const JIT &) = delete;
+  JIT &operator=(const JIT &) = delete;
+
+  ~JIT() { Release(); }
+
+  // compile all functions in module, return false if failed
+  bool Compile();
+
+  // compile functions and all of their callees that are not compiled yet
+  bool Compile(const std::vector<mid::Function *> &funcs);
+
+  // generate an on-stack replacement entry of 'F' at loop header 'header'
+  // from current IR of 'F', so that 'F' can be optimized before the entry
+  // is placed by 'CommitOSR', return false if failed
+  bool GenerateOSR(mid::Function *F, const mid::BasicBlock *header, OSRCode &code);
+
+  // compile callees of entry, then place it in executable memory, the
+  // entry is 'uint64_t entry(const uint64_t *values)', nullptr if failed
+  void *CommitOSR(OSRCode &code);
+
+  // get 'F' and its transitive callees that are not compiled yet
+  std::vector<mid::Function *> CollectUncompiled(mid::Function *F) const;
+
+  // save all compiled code and symbols to 'image'
+  void SaveImage(std::string &image) const;
+
+  // replace all compiled code with code in 'image', return false if failed
+  bool LoadImage(const std::string &image);
+
+  // get entry of compiled function, nullptr if not found
+  void *GetFunction(std::string_view name) const;
+  void *GetEntry(const mid::Function *F) const;
+
+  // call 'main' function, return its return value
+  int RunMain() const;
+
+  std::size_t code_size() const { return _code_size; }
+};
+
+}
+
+#endif //RJIT_BACK_JIT_H
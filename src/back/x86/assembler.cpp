@@ -0,0 +1,227 @@
+#include "back/x86/assembler.h"
+#include "lib/debug.h"
+
+namespace RJIT::back::x86 {
+
+void Assembler::Rex(bool w, uint8_t reg, uint8_t index, uint8_t base, bool force) {
+  uint8_t rex = 0x40 | (w << 3) | (((reg >> 3) & 1) << 2) |
+                (((index >> 3) & 1) << 1) | ((base >> 3) & 1);
+  if (rex != 0x40 || force) Emit8(rex);
+}
+
+void Assembler::MemOperand(uint8_t reg, const Mem &mem) {
+  auto base = static_cast<uint8_t>(mem.base);
+  bool need_sib = (base & 7) == RSP;
+  // [rbp/r13] can not be encoded without displacement
+  if (mem.disp == 0 && (base & 7) != RBP) {
+    ModRM(0, reg, base);
+    if (need_sib) Emit8(0x24);
+  } else if (mem.disp >= -128 && mem.disp <= 127) {
+    ModRM(1, reg, base);
+    if (need_sib) Emit8(0x24);
+    Emit8(static_cast<uint8_t>(mem.disp));
+  } else {
+    ModRM(2, reg, base);
+    if (need_sib) Emit8(0x24);
+    Emit32(static_cast<uint32_t>(mem.disp));
+  }
+}
+
+void Assembler::OpRegMem(bool w, std::initializer_list<uint8_t> op, uint8_t reg,
+                         const Mem &mem, bool byte_reg) {
+  // spl/bpl/sil/dil need a rex prefix when used as byte register
+  Rex(w, reg, 0, mem.base, byte_reg && reg >= RSP);
+  for (auto it : op) Emit8(it);
+  MemOperand(reg, mem);
+}
+
+void Assembler::OpRegReg(bool w, std::initializer_list<uint8_t> op,
+                         uint8_t reg, uint8_t rm) {
+  Rex(w, reg, 0, rm);
+  for (auto it : op) Emit8(it);
+  ModRM(3, reg, rm);
+}
+
+void Assembler::Emit32(uint32_t v) {
+  for (int i = 0; i < 4; ++i) Emit8(static_cast<uint8_t>(v >> (i * 8)));
+}
+
+void Assembler::Emit64(uint64_t v) {
+  for (int i = 0; i < 8; ++i) Emit8(static_cast<uint8_t>(v >> (i * 8)));
+}
+
+void Assembler::Patch32(std::size_t pos, uint32_t v) {
+  for (int i = 0; i < 4; ++i) _code[pos + i] = static_cast<uint8_t>(v >> (i * 8));
+}
+
+void Assembler::Mov(Reg dst, Reg src) {
+  OpRegReg(false, {0x89}, src, dst);
+}
+
+void Assembler::Mov64(Reg dst, Reg src) {
+  OpRegReg(true, {0x89}, src, dst);
+}
+
+void Assembler::MovImm(Reg dst, uint32_t imm) {
+  Rex(false, 0, 0, dst);
+  Emit8(0xb8 + (dst & 7));
+  Emit32(imm);
+}
+
+void Assembler::MovImm64(Reg dst, uint64_t imm) {
+  Rex(true, 0, 0, dst);
+  Emit8(0xb8 + (dst & 7));
+  Emit64(imm);
+}
+
+void Assembler::Load(Reg dst, const Mem &src, std::size_t size, bool sign) {
+  ++_mem_accesses;
+  switch (size) {
+    case 1: OpRegMem(false, {0x0f, static_cast<uint8_t>(sign ? 0xbe : 0xb6)}, dst, src); break;
+    case 4: OpRegMem(false, {0x8b}, dst, src); break;
+    case 8: OpRegMem(true, {0x8b}, dst, src); break;
+    default: DBG_ASSERT(0, "unsupported load size %zu", size);
+  }
+}
+
+void Assembler::Store(const Mem &dst, Reg src, std::size_t size) {
+  ++_mem_accesses;
+  switch (size) {
+    case 1: OpRegMem(false, {0x88}, src, dst, true); break;
+    case 4: OpRegMem(false, {0x89}, src, dst); break;
+    case 8: OpRegMem(true, {0x89}, src, dst); break;
+    default: DBG_ASSERT(0, "unsupported store size %zu", size);
+  }
+}
+
+void Assembler::Lea(Reg dst, const Mem &src) {
+  OpRegMem(true, {0x8d}, dst, src);
+}
+
+void Assembler::Lea(Reg dst, Label &label) {
+  Rex(true, dst, 0, 0);
+  Emit8(0x8d);
+  ModRM(0, dst, RBP);   // rip-relative
+  Rel32To(label);
+}
+
+void Assembler::Push(Reg reg) {
+  ++_mem_accesses;
+  Rex(false, 0, 0, reg);
+  Emit8(0x50 + (reg & 7));
+}
+
+void Assembler::Pop(Reg reg) {
+  ++_mem_accesses;
+  Rex(false, 0, 0, reg);
+  Emit8(0x58 + (reg & 7));
+}
+
+void Assembler::Alu(AluOp op, Reg dst, Reg src) {
+  OpRegReg(false, {static_cast<uint8_t>((static_cast<uint8_t>(op) << 3) | 1)}, src, dst);
+}
+
+void Assembler::AluImm(AluOp op, Reg dst, int32_t imm) {
+  OpRegReg(false, {0x81}, static_cast<uint8_t>(op), dst);
+  Emit32(static_cast<uint32_t>(imm));
+}
+
+void Assembler::AluImm64(AluOp op, Reg dst, int32_t imm) {
+  OpRegReg(true, {0x81}, static_cast<uint8_t>(op), dst);
+  Emit32(static_cast<uint32_t>(imm));
+}
+
+void Assembler::Imul(Reg dst, Reg src) {
+  OpRegReg(false, {0x0f, 0xaf}, dst, src);
+}
+
+void Assembler::Cdq() { Emit8(0x99); }
+
+void Assembler::Idiv(Reg src) { OpRegReg(false, {0xf7}, 7, src); }
+
+void Assembler::Div(Reg src) { OpRegReg(false, {0xf7}, 6, src); }
+
+void Assembler::ShiftCl(ShiftOp op, Reg dst) {
+  OpRegReg(false, {0xd3}, static_cast<uint8_t>(op), dst);
+}
+
+void Assembler::Test(Reg lhs, Reg rhs) {
+  OpRegReg(false, {0x85}, rhs, lhs);
+}
+
+void Assembler::Setcc(Cond cc, Reg dst) {
+  Rex(false, 0, 0, dst, dst >= RSP);
+  Emit8(0x0f);
+  Emit8(0x90 + cc);
+  ModRM(3, 0, dst);
+}
+
+void Assembler::Movzx8(Reg dst, Reg src) {
+  Rex(false, dst, 0, src, src >= RSP);
+  Emit8(0x0f);
+  Emit8(0xb6);
+  ModRM(3, dst, src);
+}
+
+void Assembler::Extend8(Reg reg, bool sign) {
+  Rex(false, reg, 0, reg, reg >= RSP);
+  Emit8(0x0f);
+  Emit8(sign ? 0xbe : 0xb6);
+  ModRM(3, reg, reg);
+}
+
+void Assembler::Rel32To(Label &label) {
+  if (label.bound()) {
+    auto rel = static_cast<int64_t>(label.pos) - static_cast<int64_t>(size() + 4);
+    Emit32(static_cast<uint32_t>(rel));
+  } else {
+    label.fixups.push_back(size());
+    Emit32(0);
+  }
+}
+
+void Assembler::Jmp(Label &label) {
+  Emit8(0xe9);
+  Rel32To(label);
+}
+
+void Assembler::Jcc(Cond cc, Label &label) {
+  Emit8(0x0f);
+  Emit8(0x80 + cc);
+  Rel32To(label);
+}
+
+std::size_t Assembler::CallRel32() {
+  Emit8(0xe8);
+  auto pos = size();
+  Emit32(0);
+  return pos;
+}
+
+void Assembler::CallReg(Reg reg) {
+  OpRegReg(false, {0xff}, 2, reg);
+}
+
+void Assembler::Ret() { Emit8(0xc3); }
+
+void Assembler::Ud2() {
+  Emit8(0x0f);
+  Emit8(0x0b);
+}
+
+void Assembler::Syscall() {
+  Emit8(0x0f);
+  Emit8(0x05);
+}
+
+void Assembler::Bind(Label &label) {
+  DBG_ASSERT(!label.bound(), "label is already bound");
+  label.pos = size();
+  for (auto pos : label.fixups) {
+    auto rel = static_cast<int64_t>(label.pos) - static_cast<int64_t>(pos + 4);
+    Patch32(pos, static_cast<uint32_t>(rel));
+  }
+  label.fixups.clear();
+}
+
+}
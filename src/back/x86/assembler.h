@@ -0,0 +1,127 @@
+#ifndef RJIT_BACK_X86_ASSEMBLER_H
+#define RJIT_BACK_X86_ASSEMBLER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace RJIT::back::x86 {
+
+enum Reg : uint8_t {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8,  R9,  R10, R11, R12, R13, R14, R15,
+};
+
+// condition codes of jcc/setcc
+enum Cond : uint8_t {
+  O = 0x0, NO = 0x1, B  = 0x2, AE = 0x3, E  = 0x4, NE = 0x5, BE = 0x6, A  = 0x7,
+  S = 0x8, NS = 0x9, P  = 0xa, NP = 0xb, L  = 0xc, GE = 0xd, LE = 0xe, G  = 0xf,
+};
+
+// arithmetic operations sharing the same encoding scheme
+enum class AluOp : uint8_t {
+  Add = 0, Or = 1, And = 4, Sub = 5, Xor = 6, Cmp = 7,
+};
+
+enum class ShiftOp : uint8_t {
+  Shl = 4, Shr = 5, Sar = 7,
+};
+
+// memory operand [base + disp]
+struct Mem {
+  Reg     base;
+  int32_t disp;
+};
+
+/* Assembler
+ * Minimal x86-64 encoder, emits machine code into a byte buffer.
+ * Operations without suffix work on 32-bit registers, the '64' ones
+ * work on 64-bit registers. Branch targets are resolved by 'Label'.
+ */
+class Assembler {
+public:
+  // position in code buffer, bound later by 'Bind'
+  struct Label {
+    std::size_t              pos = kUnbound;
+    std::vector<std::size_t> fixups;  // rel32 fields refer to this label
+
+    static constexpr std::size_t kUnbound = static_cast<std::size_t>(-1);
+    bool bound() const { return pos != kUnbound; }
+  };
+
+private:
+  std::vector<uint8_t> _code;
+  std::size_t          _mem_accesses = 0;   // loads/stores/pushes/pops emitted
+
+  void Rex(bool w, uint8_t reg, uint8_t index, uint8_t base, bool force = false);
+  void ModRM(uint8_t mod, uint8_t reg, uint8_t rm) {
+    Emit8(static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+  }
+  // emit modrm/sib/disp of memory operand
+  void MemOperand(uint8_t reg, const Mem &mem);
+  // emit 'op reg, [mem]' with optional rex.w
+  void OpRegMem(bool w, std::initializer_list<uint8_t> op, uint8_t reg,
+                const Mem &mem, bool byte_reg = false);
+  // emit 'op rm, reg' where rm is a register
+  void OpRegReg(bool w, std::initializer_list<uint8_t> op, uint8_t reg, uint8_t rm);
+  void Rel32To(Label &label);
+
+public:
+  void Emit8(uint8_t v) { _code.push_back(v); }
+  void Emit32(uint32_t v);
+  void Emit64(uint64_t v);
+  void Patch32(std::size_t pos, uint32_t v);
+
+  // data movement
+  void Mov(Reg dst, Reg src);
+  void Mov64(Reg dst, Reg src);
+  void MovImm(Reg dst, uint32_t imm);
+  void MovImm64(Reg dst, uint64_t imm);
+  void Load(Reg dst, const Mem &src, std::size_t size, bool sign = false);
+  void Store(const Mem &dst, Reg src, std::size_t size);
+  void Lea(Reg dst, const Mem &src);
+  // load address of label, 'lea dst, [rip + rel32]'
+  void Lea(Reg dst, Label &label);
+  void Push(Reg reg);
+  void Pop(Reg reg);
+
+  // arithmetic
+  void Alu(AluOp op, Reg dst, Reg src);
+  void AluImm(AluOp op, Reg dst, int32_t imm);
+  void AluImm64(AluOp op, Reg dst, int32_t imm);
+  void Imul(Reg dst, Reg src);
+  void Cdq();
+  void Idiv(Reg src);
+  void Div(Reg src);
+  void ShiftCl(ShiftOp op, Reg dst);
+  void Test(Reg lhs, Reg rhs);
+  void Setcc(Cond cc, Reg dst);
+  void Movzx8(Reg dst, Reg src);
+  // sign/zero extend the low byte of register in place
+  void Extend8(Reg reg, bool sign);
+
+  // control flow
+  void Jmp(Label &label);
+  void Jcc(Cond cc, Label &label);
+  // emit 'call rel32', returns position of the rel32 field
+  std::size_t CallRel32();
+  void CallReg(Reg reg);
+  void Ret();
+  void Ud2();
+  void Syscall();
+
+  void Bind(Label &label);
+
+  std::size_t size() const { return _code.size(); }
+  std::size_t mem_accesses() const { return _mem_accesses; }
+  std::vector<uint8_t> &code() { return _code; }
+  const std::vector<uint8_t> &code() const { return _code; }
+};
+
+// get the inverted condition
+inline Cond Invert(Cond cc) { return static_cast<Cond>(cc ^ 1); }
+
+}
+
+#endif //RJIT_BACK_X86_ASSEMBLER_H
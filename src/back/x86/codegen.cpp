@@ -0,0 +1,489 @@
+#include <cstdint>
+#include <string>
+
+#include "back/x86/codegen.h"
+#include "mid/ir/castssa.h"
+#include "mid/ir/constant.h"
+
+namespace RJIT::back::x86 {
+
+namespace {
+
+// registers of integer arguments in System V ABI
+constexpr Reg kArgRegs[] = {RDI, RSI, RDX, RCX, R8, R9};
+constexpr std::size_t kArgRegNum = sizeof(kArgRegs) / sizeof(kArgRegs[0]);
+
+// size of a value in its stack slot
+std::size_t SlotSize(const TYPE::TypeInfoPtr &type) {
+  return (type && type->IsPointer()) ? 8 : 4;
+}
+
+// size of a value in memory
+std::size_t MemSize(const TYPE::TypeInfoPtr &type) {
+  if (!type) return 4;
+  if (type->IsPointer()) return 8;
+  return type->GetSize() == 1 ? 1 : 4;
+}
+
+bool IsSigned(const TYPE::TypeInfoPtr &type) {
+  return type && !type->IsUnsigned() && !type->IsBool();
+}
+
+bool IsAlloca(const mid::Value *value) {
+  return value->isInstruction() &&
+         static_cast<const mid::Instruction *>(value)->opcode() ==
+             mid::Instruction::Alloca;
+}
+
+bool HasPHI(const mid::BasicBlock *block) {
+  return !block->insts().empty() &&
+         block->insts().front()->opcode() == mid::Instruction::PHI;
+}
+
+Cond ICmpCond(AST::Operator op) {
+  using AST::Operator;
+  switch (op) {
+    case Operator::Equal:    return E;
+    case Operator::NotEqual: return NE;
+    case Operator::SLess:    return L;
+    case Operator::SLessEq:  return LE;
+    case Operator::SGreat:   return G;
+    case Operator::SGreatEq: return GE;
+    case Operator::ULess:    return B;
+    case Operator::ULessEq:  return BE;
+    case Operator::UGreat:   return A;
+    case Operator::UGreatEq: return AE;
+    default:
+      DBG_ASSERT(0, "unknown compare operator");
+      return E;
+  }
+}
+
+}
+
+Mem CodeGen::SlotOf(const mid::Value *value) {
+  auto it = _slots.find(value);
+  if (it != _slots.end()) return {RBP, it->second};
+  _frame_size += 8;
+  _slots.insert({value, -_frame_size});
+  return {RBP, -_frame_size};
+}
+
+const Reg *CodeGen::RegOf(const mid::Value *value) const {
+  auto it = _alloc.regs.find(value);
+  return it != _alloc.regs.end() ? &it->second : nullptr;
+}
+
+void CodeGen::LoadValue(Reg dst, mid::Value *value) {
+  DBG_ASSERT(value != nullptr, "load null value");
+  if (auto cint = dynamic_cast<mid::ConstantInt *>(value)) {
+    _asm.MovImm(dst, cint->value());
+  } else if (auto reg = RegOf(value)) {
+    if (*reg == dst) return;
+    if (SlotSize(value->type()) == 8) {
+      _asm.Mov64(dst, *reg);
+    } else {
+      _asm.Mov(dst, *reg);
+    }
+  } else if (IsAlloca(value)) {
+    // address of local variable
+    _asm.Lea(dst, SlotOf(value));
+  } else {
+    _asm.Load(dst, SlotOf(value), SlotSize(value->type()));
+  }
+}
+
+Reg CodeGen::UseReg(mid::Value *value, Reg scratch) {
+  if (auto reg = RegOf(value)) return *reg;
+  LoadValue(scratch, value);
+  return scratch;
+}
+
+void CodeGen::StoreResult(const mid::Value *value, Reg src) {
+  if (auto reg = RegOf(value)) {
+    if (*reg == src) return;
+    if (SlotSize(value->type()) == 8) {
+      _asm.Mov64(*reg, src);
+    } else {
+      _asm.Mov(*reg, src);
+    }
+  } else {
+    _asm.Store(SlotOf(value), src, SlotSize(value->type()));
+  }
+}
+
+bool CodeGen::Generate(mid::Function *F, const mid::BasicBlock *osr_header,
+                       std::vector<const mid::Value *> *osr_values) {
+  _slots.clear();
+  _labels.clear();
+  _block_mem.clear();
+  _saved_slots.clear();
+  _temp_slots.clear();
+  _div_zero = {};
+  _div_overflow = {};
+  _frame_size = 0;
+
+  // blocks are emitted in the order of function's operands
+  std::vector<mid::BasicBlock *> blocks;
+  for (const auto &it : *F) {
+    auto block = CastTo<mid::BasicBlock>(it.get());
+    blocks.push_back(block);
+    _labels[block];
+  }
+  if (osr_header && !_labels.count(osr_header)) return false;
+  _alloc = LinearScan(F).Run(blocks, osr_header);
+
+  // prologue, frame size is patched at the end
+  _asm.Push(RBP);
+  _asm.Mov64(RBP, RSP);
+  _asm.AluImm64(AluOp::Sub, RSP, 0);
+  auto frame_pos = _asm.size() - 4;
+
+  // save used callee-saved registers
+  for (auto reg : _alloc.callee_saved) {
+    _frame_size += 8;
+    _saved_slots.push_back(-_frame_size);
+    _asm.Store({RBP, -_frame_size}, reg, 8);
+  }
+
+  if (osr_header) {
+    // arguments are passed with other live values, in local slots
+    if (!GenOSREntry(blocks, osr_header, *osr_values)) return false;
+  } else {
+    // move arguments to their locations, stack arguments are in caller's frame
+    const auto &args = F->args();
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      if (!args[i]) continue;
+      if (i < kArgRegNum) {
+        StoreResult(args[i], kArgRegs[i]);
+      } else {
+        Mem arg_slot = {RBP, static_cast<int32_t>(16 + 8 * (i - kArgRegNum))};
+        if (auto reg = RegOf(args[i])) {
+          _asm.Load(*reg, arg_slot, SlotSize(args[i]->type()));
+        } else {
+          _slots.insert({args[i], arg_slot.disp});
+        }
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    auto block = blocks[i];
+    auto next = i + 1 < blocks.size() ? blocks[i + 1] : nullptr;
+    _asm.Bind(_labels[block]);
+    auto mem_accesses = _asm.mem_accesses();
+    for (const auto &inst : block->insts()) {
+      if (!GenInst(inst, block, next)) return false;
+    }
+    _block_mem[block] = _asm.mem_accesses() - mem_accesses;
+    // block without terminator should never be reached
+    if (block->insts().empty() || !block->insts().back()->isTerminator()) {
+      _asm.Ud2();
+    }
+  }
+
+  // stubs are placed after all blocks, only if they are used
+  if (!_div_zero.fixups.empty()) GenTrap(_div_zero, F, "division by zero");
+  if (!_div_overflow.fixups.empty()) {
+    GenTrap(_div_overflow, F, "overflow in signed division");
+  }
+
+  for (const auto &it : _labels) {
+    DBG_ASSERT(it.second.bound(), "jump to block '%s' outside of function",
+               it.first->name().c_str());
+  }
+
+  // keep stack aligned to 16 bytes at call sites
+  _asm.Patch32(frame_pos, (_frame_size + 15) & ~15);
+  return true;
+}
+
+bool CodeGen::GenOSREntry(const std::vector<mid::BasicBlock *> &blocks,
+                          const mid::BasicBlock *header,
+                          std::vector<const mid::Value *> &values) {
+  // variables whose address is taken can not be moved to new frame
+  for (const auto &block : blocks) {
+    for (const auto &inst : block->insts()) {
+      for (unsigned i = 0; i < inst->size(); ++i) {
+        bool is_ptr = (inst->opcode() == mid::Instruction::Load && i == 0) ||
+                      (inst->opcode() == mid::Instruction::Store && i == 1);
+        auto operand = (*inst)[i].get();
+        if (!is_ptr && operand && IsAlloca(operand)) return false;
+      }
+    }
+  }
+
+  // load live values from array pointed by RDI, then enter the loop
+  values = _alloc.live_in;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    auto value = values[i];
+    _asm.Load(RAX, {RDI, static_cast<int32_t>(8 * i)}, 8);
+    if (IsAlloca(value) && !RegOf(value)) {
+      // content of variable
+      _asm.Store(SlotOf(value), RAX, MemSize(value->type()->GetDereferenceType()));
+    } else {
+      StoreResult(value, RAX);
+    }
+  }
+  _asm.Jmp(_labels[header]);
+  return true;
+}
+
+bool CodeGen::GenInst(mid::Instruction *inst, const mid::BasicBlock *block,
+                      const mid::BasicBlock *next) {
+  using Op = mid::Instruction;
+  switch (inst->opcode()) {
+    case Op::Alloca: SlotOf(inst); break;
+    case Op::Load:   GenLoad(static_cast<mid::LoadInst *>(inst)); break;
+    case Op::Store:  GenStore(static_cast<mid::StoreInst *>(inst)); break;
+    case Op::ICmp:   GenICmp(static_cast<mid::ICmpInst *>(inst)); break;
+    case Op::Call:   GenCall(static_cast<mid::CallInst *>(inst)); break;
+    case Op::PHI:    break;   // assigned by predecessors
+    case Op::Br:     GenBranch(static_cast<mid::BranchInst *>(inst), block, next); break;
+    case Op::Jmp:    GenJump(static_cast<mid::JumpInst *>(inst), block, next); break;
+    case Op::Ret:    GenReturn(static_cast<mid::ReturnInst *>(inst)); break;
+    default: {
+      if (inst->isBinaryOp()) {
+        GenBinary(inst);
+        break;
+      }
+      inst->logger().LogError("unsupported instruction '" +
+                              inst->GetOpcodeAsString() + "' in JIT");
+      return false;
+    }
+  }
+  return true;
+}
+
+void CodeGen::GenLoad(mid::LoadInst *inst) {
+  auto ptr = inst->Pointer();
+  auto type = inst->type();
+  auto size = MemSize(type);
+  if (auto reg = RegOf(ptr)) {
+    // variable kept in register
+    StoreResult(inst, *reg);
+    return;
+  } else if (IsAlloca(ptr)) {
+    _asm.Load(RAX, SlotOf(ptr), size, IsSigned(type));
+  } else {
+    LoadValue(RCX, ptr);
+    _asm.Load(RAX, {RCX, 0}, size, IsSigned(type));
+  }
+  StoreResult(inst, RAX);
+}
+
+void CodeGen::GenStore(mid::StoreInst *inst) {
+  auto ptr = inst->pointer();
+  auto type = ptr->type()->GetDereferenceType();
+  auto size = MemSize(type);
+  if (auto reg = RegOf(ptr)) {
+    // variable kept in register, truncate as storing to memory
+    LoadValue(*reg, inst->value());
+    if (size == 1) _asm.Extend8(*reg, IsSigned(type));
+    return;
+  }
+  LoadValue(RAX, inst->value());
+  if (IsAlloca(ptr)) {
+    _asm.Store(SlotOf(ptr), RAX, size);
+  } else {
+    LoadValue(RCX, ptr);
+    _asm.Store({RCX, 0}, RAX, size);
+  }
+}
+
+void CodeGen::GenBinary(mid::Instruction *inst) {
+  using Op = mid::Instruction;
+  LoadValue(RAX, (*inst)[0].get());
+  // shift count must be in CL
+  auto rhs = inst->isShift() ? (LoadValue(RCX, (*inst)[1].get()), RCX)
+                             : UseReg((*inst)[1].get(), RCX);
+  switch (inst->opcode()) {
+    case Op::Add:  _asm.Alu(AluOp::Add, RAX, rhs); break;
+    case Op::Sub:  _asm.Alu(AluOp::Sub, RAX, rhs); break;
+    case Op::And:  _asm.Alu(AluOp::And, RAX, rhs); break;
+    case Op::Or:   _asm.Alu(AluOp::Or,  RAX, rhs); break;
+    case Op::Xor:  _asm.Alu(AluOp::Xor, RAX, rhs); break;
+    case Op::Mul:  _asm.Imul(RAX, rhs); break;
+    case Op::Shl:  _asm.ShiftCl(ShiftOp::Shl, RAX); break;
+    case Op::LShr: _asm.ShiftCl(ShiftOp::Shr, RAX); break;
+    case Op::AShr: _asm.ShiftCl(ShiftOp::Sar, RAX); break;
+    case Op::SDiv: case Op::SRem: {
+      GenDivCheck((*inst)[1].get(), rhs, true);
+      _asm.Cdq();
+      _asm.Idiv(rhs);
+      if (inst->opcode() == Op::SRem) _asm.Mov(RAX, RDX);
+      break;
+    }
+    case Op::UDiv: case Op::URem: {
+      GenDivCheck((*inst)[1].get(), rhs, false);
+      _asm.Alu(AluOp::Xor, RDX, RDX);
+      _asm.Div(rhs);
+      if (inst->opcode() == Op::URem) _asm.Mov(RAX, RDX);
+      break;
+    }
+    default: DBG_ASSERT(0, "unknown binary operator");
+  }
+  StoreResult(inst, RAX);
+}
+
+void CodeGen::GenDivCheck(mid::Value *divisor, Reg rhs, bool is_signed) {
+  // dividend is in EAX, divisor in 'rhs'
+  auto cint = dynamic_cast<mid::ConstantInt *>(divisor);
+  if (!cint || cint->IsZero()) {
+    _asm.Test(rhs, rhs);
+    _asm.Jcc(E, _div_zero);
+  }
+  if (is_signed && (!cint || cint->value() == UINT32_MAX)) {
+    // INT_MIN / -1 overflows
+    Assembler::Label ok;
+    _asm.AluImm(AluOp::Cmp, rhs, -1);
+    _asm.Jcc(NE, ok);
+    _asm.AluImm(AluOp::Cmp, RAX, INT32_MIN);
+    _asm.Jcc(E, _div_overflow);
+    _asm.Bind(ok);
+  }
+}
+
+void CodeGen::GenICmp(mid::ICmpInst *inst) {
+  auto lhs = UseReg(inst->LHS(), RAX);
+  auto rhs = UseReg(inst->RHS(), RCX);
+  _asm.Alu(AluOp::Cmp, lhs, rhs);
+  _asm.Setcc(ICmpCond(inst->op()), RAX);
+  _asm.Movzx8(RAX, RAX);
+  StoreResult(inst, RAX);
+}
+
+void CodeGen::GenCall(mid::CallInst *inst) {
+  auto callee = CastTo<mid::Function>(inst->Callee());
+  std::size_t arg_num = inst->size() - 1;
+
+  // push stack arguments in reverse order, keep rsp aligned
+  std::size_t stack_num = arg_num > kArgRegNum ? arg_num - kArgRegNum : 0;
+  std::size_t padding = (stack_num & 1) ? 8 : 0;
+  if (padding) _asm.AluImm64(AluOp::Sub, RSP, padding);
+  for (std::size_t i = arg_num; i > kArgRegNum; --i) {
+    LoadValue(RAX, (*inst)[i].get());
+    _asm.Push(RAX);
+  }
+
+  // register arguments
+  for (std::size_t i = 0; i < arg_num && i < kArgRegNum; ++i) {
+    LoadValue(kArgRegs[i], (*inst)[i + 1].get());
+  }
+
+  _relocs.push_back({_asm.CallRel32(), callee});
+
+  auto cleanup = stack_num * 8 + padding;
+  if (cleanup) _asm.AluImm64(AluOp::Add, RSP, cleanup);
+
+  auto ret_type = inst->type();
+  if (ret_type && !ret_type->IsVoid()) StoreResult(inst, RAX);
+}
+
+void CodeGen::GenBranch(mid::BranchInst *inst, const mid::BasicBlock *block,
+                        const mid::BasicBlock *next) {
+  auto true_block = CastTo<mid::BasicBlock>(inst->true_block());
+  auto false_block = CastTo<mid::BasicBlock>(inst->false_block());
+  auto cond = UseReg(inst->cond(), RAX);
+  _asm.Test(cond, cond);
+  if (HasPHI(true_block) || HasPHI(false_block)) {
+    // copies of each edge are placed before the jump to successor
+    Assembler::Label false_edge;
+    _asm.Jcc(E, false_edge);
+    GenPhiCopies(block, true_block);
+    _asm.Jmp(_labels[true_block]);
+    _asm.Bind(false_edge);
+    GenPhiCopies(block, false_block);
+    if (false_block != next) _asm.Jmp(_labels[false_block]);
+  } else if (true_block == next) {
+    _asm.Jcc(E, _labels[false_block]);
+  } else {
+    _asm.Jcc(NE, _labels[true_block]);
+    if (false_block != next) _asm.Jmp(_labels[false_block]);
+  }
+}
+
+void CodeGen::GenJump(mid::JumpInst *inst, const mid::BasicBlock *block,
+                      const mid::BasicBlock *next) {
+  auto target = CastTo<mid::BasicBlock>(inst->target());
+  GenPhiCopies(block, target);
+  if (target != next) _asm.Jmp(_labels[target]);
+}
+
+void CodeGen::GenPhiCopies(const mid::BasicBlock *from, const mid::BasicBlock *to) {
+  std::vector<std::pair<const mid::PHINode *, mid::Value *>> copies;
+  for (const auto &inst : to->insts()) {
+    if (inst->opcode() != mid::Instruction::PHI) break;
+    auto phi = static_cast<mid::PHINode *>(inst);
+    auto value = phi->GetIncomingValueFor(from);
+    if (value && value != phi) copies.push_back({phi, value});
+  }
+
+  // all copies happen at the same time, so a source that is overwritten
+  // by another copy is saved to a temporary slot first
+  auto same_loc = [this](const mid::Value *lhs, const mid::Value *rhs) {
+    if (lhs == rhs) return true;
+    auto l = RegOf(lhs), r = RegOf(rhs);
+    return l && r && *l == *r;
+  };
+  std::vector<int32_t> saved(copies.size(), 0);
+  std::size_t temp_num = 0;
+  for (std::size_t i = 0; i < copies.size(); ++i) {
+    for (std::size_t j = 0; j < copies.size(); ++j) {
+      if (i == j || !same_loc(copies[i].second, copies[j].first)) continue;
+      if (temp_num == _temp_slots.size()) {
+        _frame_size += 8;
+        _temp_slots.push_back(-_frame_size);
+      }
+      saved[i] = _temp_slots[temp_num++];
+      LoadValue(RAX, copies[i].second);
+      _asm.Store({RBP, saved[i]}, RAX, 8);
+      break;
+    }
+  }
+
+  for (std::size_t i = 0; i < copies.size(); ++i) {
+    auto [phi, value] = copies[i];
+    if (saved[i]) {
+      _asm.Load(RAX, {RBP, saved[i]}, 8);
+      StoreResult(phi, RAX);
+    } else if (auto reg = RegOf(phi)) {
+      LoadValue(*reg, value);
+    } else {
+      StoreResult(phi, UseReg(value, RAX));
+    }
+  }
+}
+
+void CodeGen::GenTrap(Assembler::Label &label, const mid::Function *F,
+                      const char *message) {
+  // code can not refer to functions of host, so the message is written
+  // by system calls directly, 'write(2, text, len)' then 'exit_group(1)'
+  auto text = std::string("runtime error: ") + message + " in function '" +
+              F->GetFunctionName() + "'\n";
+  Assembler::Label text_label;
+  _asm.Bind(label);
+  _asm.Lea(RSI, text_label);
+  _asm.MovImm(RDX, static_cast<uint32_t>(text.size()));
+  _asm.MovImm(RDI, 2);
+  _asm.MovImm(RAX, 1);
+  _asm.Syscall();
+  _asm.MovImm(RDI, 1);
+  _asm.MovImm(RAX, 231);
+  _asm.Syscall();
+  _asm.Ud2();
+  _asm.Bind(text_label);
+  for (const auto &c : text) _asm.Emit8(static_cast<uint8_t>(c));
+}
+
+void CodeGen::GenReturn(mid::ReturnInst *inst) {
+  if (inst->RetVal()) LoadValue(RAX, inst->RetVal());
+  for (std::size_t i = 0; i < _saved_slots.size(); ++i) {
+    _asm.Load(_alloc.callee_saved[i], {RBP, _saved_slots[i]}, 8);
+  }
+  _asm.Mov64(RSP, RBP);
+  _asm.Pop(RBP);
+  _asm.Ret();
+}
+
+}
@@ -0,0 +1,99 @@
+#ifndef RJIT_BACK_X86_CODEGEN_H
+#define RJIT_BACK_X86_CODEGEN_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "back/x86/assembler.h"
+#include "back/x86/regalloc.h"
+#include "mid/ir/ssa.h"
+
+namespace RJIT::back::x86 {
+
+// a 'call rel32' whose target is resolved after all functions are emitted
+struct CallReloc {
+  std::size_t    pos;     // position of rel32 field
+  mid::Function *callee;
+};
+
+using CallRelocList = std::vector<CallReloc>;
+
+/* CodeGen
+ * Lower a function of the IR to x86-64 machine code (System V ABI).
+ * Values live in registers chosen by 'LinearScan' or in stack slots of
+ * the frame, RAX/RCX/RDX are kept as scratch registers.
+ */
+class CodeGen {
+private:
+  Assembler                                                &_asm;
+  CallRelocList                                            &_relocs;
+  std::unordered_map<const mid::Value *, int32_t>           _slots;
+  std::unordered_map<const mid::BasicBlock *, Assembler::Label> _labels;
+  std::unordered_map<const mid::BasicBlock *, std::size_t>  _block_mem;    // memory accesses of blocks
+  int32_t                                                   _frame_size;
+  Allocation                                                _alloc;
+  std::vector<int32_t>                                      _saved_slots;
+  std::vector<int32_t>                                      _temp_slots;   // for phi copies
+  Assembler::Label                                          _div_zero;     // trap stubs
+  Assembler::Label                                          _div_overflow;
+
+  Mem  SlotOf(const mid::Value *value);
+  // register of value, nullptr if it lives in memory
+  const Reg *RegOf(const mid::Value *value) const;
+  void LoadValue(Reg dst, mid::Value *value);
+  // get value in a register, load to 'scratch' if needed
+  Reg  UseReg(mid::Value *value, Reg scratch);
+  void StoreResult(const mid::Value *value, Reg src);
+
+  bool Generate(mid::Function *F, const mid::BasicBlock *osr_header,
+                std::vector<const mid::Value *> *osr_values);
+  bool GenOSREntry(const std::vector<mid::BasicBlock *> &blocks,
+                   const mid::BasicBlock *header,
+                   std::vector<const mid::Value *> &values);
+  bool GenInst(mid::Instruction *inst, const mid::BasicBlock *block,
+               const mid::BasicBlock *next);
+  void GenLoad(mid::LoadInst *inst);
+  void GenStore(mid::StoreInst *inst);
+  void GenBinary(mid::Instruction *inst);
+  // jump to trap stubs if division by 'divisor' in 'rhs' traps
+  void GenDivCheck(mid::Value *divisor, Reg rhs, bool is_signed);
+  void GenICmp(mid::ICmpInst *inst);
+  void GenCall(mid::CallInst *inst);
+  void GenBranch(mid::BranchInst *inst, const mid::BasicBlock *block,
+                 const mid::BasicBlock *next);
+  void GenJump(mid::JumpInst *inst, const mid::BasicBlock *block,
+               const mid::BasicBlock *next);
+  // assign phi nodes of 'to' on edge 'from' -> 'to'
+  void GenPhiCopies(const mid::BasicBlock *from, const mid::BasicBlock *to);
+  void GenReturn(mid::ReturnInst *inst);
+  // report runtime error of 'F' as interpreter does and exit with 1
+  void GenTrap(Assembler::Label &label, const mid::Function *F, const char *message);
+
+public:
+  CodeGen(Assembler &assembler, CallRelocList &relocs)
+      : _asm(assembler), _relocs(relocs), _frame_size(0) {}
+
+  // emit function 'F' at the end of code buffer, return false if failed
+  bool GenerateFunction(mid::Function *F) {
+    return Generate(F, nullptr, nullptr);
+  }
+
+  // emit a variant of 'F' that is entered at loop header 'header' with
+  // 'uint64_t entry(const uint64_t *values)', 'values' receives the IR
+  // values to be passed in order, return false if failed
+  bool GenerateOSREntry(mid::Function *F, const mid::BasicBlock *header,
+                        std::vector<const mid::Value *> &values) {
+    return Generate(F, header, &values);
+  }
+
+  // number of memory accesses emitted for 'block' of the last generated
+  // function, including phi copies on its out edges
+  std::size_t MemAccesses(const mid::BasicBlock *block) const {
+    auto it = _block_mem.find(block);
+    return it != _block_mem.end() ? it->second : 0;
+  }
+};
+
+}
+
+#endif //RJIT_BACK_X86_CODEGEN_H
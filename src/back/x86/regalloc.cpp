@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+#include "back/x86/regalloc.h"
+#include "mid/ir/castssa.h"
+
+namespace RJIT::back::x86 {
+
+namespace {
+
+constexpr Reg kCalleeSaved[] = {RBX, R12, R13, R14, R15};
+// caller-saved registers that are never used to pass arguments
+constexpr Reg kCallerSaved[] = {R10, R11};
+
+bool IsCalleeSaved(Reg reg) {
+  return std::find(std::begin(kCalleeSaved), std::end(kCalleeSaved), reg) !=
+         std::end(kCalleeSaved);
+}
+
+// return true if instruction produces a value
+bool HasResult(const mid::Instruction *inst) {
+  using Op = mid::Instruction;
+  switch (inst->opcode()) {
+    case Op::Load: case Op::ICmp: case Op::PHI: return true;
+    case Op::Call: return inst->type() && !inst->type()->IsVoid();
+    default: return inst->isBinaryOp();
+  }
+}
+
+// get successors of block from its terminator
+std::vector<const mid::BasicBlock *> Successors(mid::BasicBlock *block) {
+  if (block->insts().empty()) return {};
+  auto term = block->insts().back();
+  switch (term->opcode()) {
+    case mid::Instruction::Br: {
+      auto br = static_cast<mid::BranchInst *>(term);
+      return {CastTo<mid::BasicBlock>(br->true_block()),
+              CastTo<mid::BasicBlock>(br->false_block())};
+    }
+    case mid::Instruction::Jmp:
+      return {CastTo<mid::BasicBlock>(static_cast<mid::JumpInst *>(term)->target())};
+    default:
+      return {};
+  }
+}
+
+}
+
+uint32_t LinearScan::VRegId(const mid::Value *value) {
+  auto it = _vreg_ids.find(value);
+  return it != _vreg_ids.end() ? it->second : std::numeric_limits<uint32_t>::max();
+}
+
+void LinearScan::CollectVRegs(const std::vector<mid::BasicBlock *> &blocks) {
+  auto add = [this](const mid::Value *value) {
+    _vreg_ids.insert({value, static_cast<uint32_t>(_vregs.size())});
+    _vregs.push_back(value);
+  };
+
+  for (const auto &arg : _func->args()) {
+    if (arg) add(arg);
+  }
+
+  // allocas can be kept in register if only accessed by load/store
+  std::unordered_set<const mid::Value *> allocas, escaped;
+  for (const auto &block : blocks) {
+    for (const auto &inst : block->insts()) {
+      if (inst->opcode() == mid::Instruction::Alloca) allocas.insert(inst);
+      for (unsigned i = 0; i < inst->size(); ++i) {
+        bool is_ptr = (inst->opcode() == mid::Instruction::Load && i == 0) ||
+                      (inst->opcode() == mid::Instruction::Store && i == 1);
+        if (!is_ptr) escaped.insert((*inst)[i].get());
+      }
+    }
+  }
+
+  for (const auto &block : blocks) {
+    for (const auto &inst : block->insts()) {
+      if (allocas.count(inst) ? !escaped.count(inst) : HasResult(inst)) add(inst);
+    }
+  }
+}
+
+void LinearScan::BuildIntervals(const std::vector<mid::BasicBlock *> &blocks) {
+  auto vreg_num = _vregs.size();
+  auto block_num = blocks.size();
+  using BitSet = std::vector<bool>;
+
+  std::unordered_map<const mid::BasicBlock *, std::size_t> block_ids;
+  for (std::size_t i = 0; i < block_num; ++i) block_ids[blocks[i]] = i;
+
+  std::vector<BitSet> uses(block_num, BitSet(vreg_num)), defs = uses;
+  std::vector<std::pair<uint32_t, uint32_t>> ranges(block_num);
+  std::vector<uint32_t> calls;
+  std::vector<uint32_t> starts(vreg_num, std::numeric_limits<uint32_t>::max());
+  std::vector<uint32_t> ends(vreg_num, 0);
+
+  auto extend = [&](uint32_t id, uint32_t pos) {
+    starts[id] = std::min(starts[id], pos);
+    ends[id] = std::max(ends[id], pos);
+  };
+
+  // arguments are defined at function entry (position 0)
+  for (const auto &arg : _func->args()) {
+    if (arg) extend(VRegId(arg), 0);
+  }
+
+  // number instructions, collect local uses and defs
+  uint32_t pos = 1;
+  for (std::size_t b = 0; b < block_num; ++b) {
+    auto &use = uses[b], &def = defs[b];
+    ranges[b].first = pos;
+    for (const auto &inst : blocks[b]->insts()) {
+      bool is_store = inst->opcode() == mid::Instruction::Store;
+      bool is_phi = inst->opcode() == mid::Instruction::PHI;
+      for (unsigned i = 0; !is_phi && i < inst->size(); ++i) {
+        auto id = VRegId((*inst)[i].get());
+        if (id >= vreg_num) continue;
+        extend(id, pos);
+        if (is_store && i == 1) {
+          def[id] = true;       // store to variable
+        } else if (!def[id]) {
+          use[id] = true;
+        }
+      }
+      auto id = VRegId(inst);
+      if (id < vreg_num) {
+        extend(id, pos);
+        def[id] = true;
+      }
+      if (inst->opcode() == mid::Instruction::Call) calls.push_back(pos);
+      ++pos;
+    }
+    ranges[b].second = pos > ranges[b].first ? pos - 1 : pos++;
+  }
+
+  // phi nodes copy their incoming values at the end of predecessors
+  for (std::size_t b = 0; b < block_num; ++b) {
+    for (const auto &inst : blocks[b]->insts()) {
+      if (inst->opcode() != mid::Instruction::PHI) break;
+      auto phi = static_cast<mid::PHINode *>(inst);
+      for (unsigned i = 0; i < phi->GetIncomingNum(); ++i) {
+        auto it = block_ids.find(phi->GetIncomingBlock(i));
+        if (it == block_ids.end()) continue;
+        auto end = ranges[it->second].second;
+        extend(VRegId(phi), end);
+        auto id = VRegId(phi->GetIncomingValue(i));
+        if (id >= vreg_num) continue;
+        extend(id, end);
+        if (!defs[it->second][id]) uses[it->second][id] = true;
+      }
+    }
+  }
+
+  // solve liveness backward until fixed point
+  std::vector<BitSet> live_in(block_num, BitSet(vreg_num)), live_out = live_in;
+  std::vector<std::vector<std::size_t>> succs(block_num);
+  for (std::size_t b = 0; b < block_num; ++b) {
+    for (const auto &succ : Successors(blocks[b])) {
+      auto it = block_ids.find(succ);
+      if (it != block_ids.end()) succs[b].push_back(it->second);
+    }
+  }
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto b = block_num; b-- > 0;) {
+      for (auto s : succs[b]) {
+        for (std::size_t v = 0; v < vreg_num; ++v) {
+          if (live_in[s][v] && !live_out[b][v]) live_out[b][v] = changed = true;
+        }
+      }
+      for (std::size_t v = 0; v < vreg_num; ++v) {
+        bool in = uses[b][v] || (live_out[b][v] && !defs[b][v]);
+        if (in && !live_in[b][v]) live_in[b][v] = changed = true;
+      }
+    }
+  }
+
+  auto live_block = block_ids.find(_live_block);
+  if (live_block != block_ids.end()) {
+    for (std::size_t v = 0; v < vreg_num; ++v) {
+      if (live_in[live_block->second][v]) _alloc.live_in.push_back(_vregs[v]);
+    }
+    // phi nodes are assigned by predecessors, so they are entry values too
+    for (const auto &inst : live_block->first->insts()) {
+      if (inst->opcode() != mid::Instruction::PHI) break;
+      _alloc.live_in.push_back(inst);
+    }
+  }
+
+  // live values cover the whole range of block
+  for (std::size_t b = 0; b < block_num; ++b) {
+    for (std::size_t v = 0; v < vreg_num; ++v) {
+      if (live_in[b][v]) extend(v, ranges[b].first);
+      if (live_out[b][v]) extend(v, ranges[b].second);
+    }
+  }
+
+  for (std::size_t v = 0; v < vreg_num; ++v) {
+    if (starts[v] > ends[v]) continue;    // never referenced
+    auto call = std::upper_bound(calls.begin(), calls.end(), starts[v]);
+    bool cross_call = call != calls.end() && *call < ends[v];
+    _intervals.push_back({_vregs[v], starts[v], ends[v], cross_call});
+  }
+}
+
+void LinearScan::Allocate() {
+  std::sort(_intervals.begin(), _intervals.end(),
+            [](const Interval &lhs, const Interval &rhs) {
+              return lhs.start != rhs.start ? lhs.start < rhs.start
+                                            : lhs.end < rhs.end;
+            });
+
+  std::vector<bool> free(R15 + 1, false);
+  for (auto reg : kCalleeSaved) free[reg] = true;
+  for (auto reg : kCallerSaved) free[reg] = true;
+  std::unordered_set<Reg> used_callee_saved;
+  std::vector<const Interval *> active;
+
+  auto take = [&](Reg reg, const Interval &it) {
+    free[reg] = false;
+    _alloc.regs[it.value] = reg;
+    if (IsCalleeSaved(reg)) used_callee_saved.insert(reg);
+  };
+
+  for (const auto &it : _intervals) {
+    // expire intervals ended before current one, operands are read
+    // before result is written, so the register can be reused at 'start'
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&](const Interval *a) {
+                                  if (a->end > it.start) return false;
+                                  free[_alloc.regs[a->value]] = true;
+                                  return true;
+                                }),
+                 active.end());
+
+    bool found = false;
+    if (!it.cross_call) {
+      for (auto reg : kCallerSaved) {
+        if (free[reg]) { take(reg, it); found = true; break; }
+      }
+    }
+    for (auto reg : kCalleeSaved) {
+      if (found) break;
+      if (free[reg]) { take(reg, it); found = true; }
+    }
+
+    if (!found) {
+      // spill the interval ends last
+      const Interval **victim = nullptr;
+      for (auto &a : active) {
+        if (it.cross_call && !IsCalleeSaved(_alloc.regs[a->value])) continue;
+        if (!victim || a->end > (*victim)->end) victim = &a;
+      }
+      if (!victim || (*victim)->end <= it.end) continue;
+      auto reg = _alloc.regs[(*victim)->value];
+      _alloc.regs.erase((*victim)->value);
+      take(reg, it);
+      *victim = &it;
+      continue;
+    }
+    active.push_back(&it);
+  }
+
+  for (auto reg : kCalleeSaved) {
+    if (used_callee_saved.count(reg)) _alloc.callee_saved.push_back(reg);
+  }
+}
+
+const Allocation &LinearScan::Run(const std::vector<mid::BasicBlock *> &blocks,
+                                  const mid::BasicBlock *live_block) {
+  _live_block = live_block;
+  _vregs.clear();
+  _vreg_ids.clear();
+  _intervals.clear();
+  _alloc = Allocation();
+
+  CollectVRegs(blocks);
+  BuildIntervals(blocks);
+  Allocate();
+  return _alloc;
+}
+
+}
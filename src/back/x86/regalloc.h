@@ -0,0 +1,61 @@
+#ifndef RJIT_BACK_X86_REGALLOC_H
+#define RJIT_BACK_X86_REGALLOC_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "back/x86/assembler.h"
+#include "mid/ir/ssa.h"
+
+namespace RJIT::back::x86 {
+
+// result of register allocation, values not in 'regs' live in stack slots
+struct Allocation {
+  std::unordered_map<const mid::Value *, Reg> regs;
+  std::vector<Reg>                            callee_saved;   // used callee-saved registers
+  std::vector<const mid::Value *>             live_in;        // values live at entry of requested block
+};
+
+/* LinearScan
+ * Linear scan register allocator (Poletto & Sarkar). Instructions are
+ * numbered in block emission order, live intervals are computed from
+ * block-level liveness, so that values live around loops cover the
+ * whole loop.
+ * Candidates are SSA values and allocas that are only accessed by
+ * load/store, the later are kept in registers as variables.
+ * Values live across calls only get callee-saved registers, if no
+ * register is free, the interval ending last is spilled to stack.
+ */
+class LinearScan {
+private:
+  struct Interval {
+    const mid::Value *value;
+    uint32_t          start, end;
+    bool              cross_call;
+  };
+
+  mid::Function                                   *_func;
+  const mid::BasicBlock                           *_live_block;
+  std::vector<const mid::Value *>                  _vregs;
+  std::unordered_map<const mid::Value *, uint32_t> _vreg_ids;
+  std::vector<Interval>                            _intervals;
+  Allocation                                       _alloc;
+
+  uint32_t VRegId(const mid::Value *value);
+  void CollectVRegs(const std::vector<mid::BasicBlock *> &blocks);
+  void BuildIntervals(const std::vector<mid::BasicBlock *> &blocks);
+  void Allocate();
+
+public:
+  explicit LinearScan(mid::Function *F) : _func(F), _live_block(nullptr) {}
+
+  // allocate registers for function, 'blocks' are in emission order,
+  // also report values live at entry of 'live_block' if it's not null
+  const Allocation &Run(const std::vector<mid::BasicBlock *> &blocks,
+                        const mid::BasicBlock *live_block = nullptr);
+};
+
+}
+
+#endif //RJIT_BACK_X86_REGALLOC_H
@@ -11,10 +11,8 @@ using namespace RJIT::mid;
 using namespace RJIT::mid::analyzer;
 
 namespace RJIT::AST {
-PrimASTPtr MakePrimeAST(front::LoggerPtr logger, TYPE::Type type) {
-  PrimASTPtr ast = std::make_unique<PrimTypeAST>(type);
-  ast->setLogger(std::move(logger));
-  return ast;
+PrimASTPtr MakePrimeAST(ASTContext &context, const front::SourceLoc &loc, TYPE::Type type) {
+  return context.New<PrimTypeAST>(loc, type);
 }
 
 void IntAST::Dump(Dumper *dumper) {
@@ -3,11 +3,14 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "define/type.h"
 #include "front/logger.h"
+#include "lib/intern.h"
+#include "lib/arena.h"
 #include "mid/ir/usedef/value.h"
 
 namespace RJIT::mid {
@@ -24,6 +27,7 @@ class SemAnalyzer;
 namespace RJIT::AST {
 using TYPE::TypeInfoPtr;
 using mid::SSAPtr;
+using lib::Symbol;
 
 enum class Operator {
   // unary
@@ -42,7 +46,7 @@ enum class Operator {
   Dam
 };
 
-Operator string2Operator(const std::string &op, bool isUnary = false);
+Operator string2Operator(std::string_view op, bool isUnary = false);
 
 std::string operator2String(Operator oper);
 
@@ -50,26 +54,30 @@ class BaseAST;
 class Decl;
 class Stmt;
 
-typedef std::unique_ptr<BaseAST> ASTPtr;
+// AST nodes are owned by ASTContext, pointers between nodes are non-owning
+typedef BaseAST *ASTPtr;
 typedef std::vector<ASTPtr> ASTPtrList;
-typedef std::unique_ptr<Decl> DeclPtr;
-typedef std::unique_ptr<Stmt> StmtPtr;
+typedef Decl *DeclPtr;
+typedef Stmt *StmtPtr;
 
 class BaseAST {
 private:
-  front::LoggerPtr logger;
+  front::SourceLoc loc;
   TypeInfoPtr ast_type;
 
 public:
   virtual ~BaseAST() = default;
 
-  void setLogger(front::LoggerPtr logger_) { logger = std::move(logger_); }
+  void setLoc(const front::SourceLoc &loc_) { loc = loc_; }
 
   const TypeInfoPtr &set_ast_type(const TypeInfoPtr &ast_type_) {
     return ast_type = ast_type_;
   }
 
-  front::LoggerPtr &Logger() { return logger; }
+  const front::SourceLoc &Loc() const { return loc; }
+
+  // diagnostics of current node
+  front::Logger Logger() const { return front::Logger(loc); }
 
   virtual std::string getTypeStr() { return type2String(ast_type->GetType()); }
 
@@ -158,12 +166,14 @@ public:
 
 class VariableAST : public BaseAST {
 private:
-  std::string name;
+  Symbol name;
 
 public:
-  explicit VariableAST(std::string name_) : name(std::move(name_)) {}
+  explicit VariableAST(Symbol name_) : name(name_) {}
+
+  Symbol getSymbol() const { return name; }
 
-  const std::string &getName() const { return name; }
+  std::string_view getName() const { return lib::SymbolName(name); }
 
   void Dump(mid::Dumper *) override;
 
@@ -191,7 +201,7 @@ public:
   SSAPtr CodeGeneAction(mid::IRBuilder *irbuilder) override;
 };
 
-typedef std::unique_ptr<PrimTypeAST> PrimASTPtr;
+typedef PrimTypeAST *PrimASTPtr;
 
 class VariableDecl : public Decl {
 private:
@@ -217,13 +227,15 @@ public:
 class VariableDefAST : public BaseAST {
 private:
   RJIT::TYPE::Type _type;
-  std::string _identifier;
+  Symbol _identifier;
   ASTPtr _initValue;
 
 public:
-  VariableDefAST(std::string id, ASTPtr init) : _identifier(std::move(id)), _initValue(std::move(init)) {}
+  VariableDefAST(Symbol id, ASTPtr init) : _identifier(id), _initValue(std::move(init)) {}
 
-  const std::string &getIdentifier() { return _identifier; }
+  Symbol getSymbol() const { return _identifier; }
+
+  std::string_view getIdentifier() const { return lib::SymbolName(_identifier); }
 
   bool hasInit() {
     if (_initValue) {
@@ -377,13 +389,15 @@ public:
 
 class CallStmt : public Stmt {
 private:
-  std::string symbol;
+  Symbol symbol;
   ASTPtrList args;
 
 public:
-  CallStmt(std::string symbol_, ASTPtrList args_) : symbol(std::move(symbol_)), args(std::move(args_)) {}
+  CallStmt(Symbol symbol_, ASTPtrList args_) : symbol(symbol_), args(std::move(args_)) {}
+
+  Symbol getSymbol() const { return symbol; }
 
-  const std::string &getSymbol() { return symbol; }
+  std::string_view getName() const { return lib::SymbolName(symbol); }
 
   ASTPtrList &getArgs() { return args; }
 
@@ -414,18 +428,20 @@ public:
 
 class ProtoTypeAST : public BaseAST {
 private:
-  std::string _funcName;
+  Symbol      _funcName;
   ASTPtrList  _args;
   TYPE::Type  _ret_type;
   std::string _type_str;
 
 public:
-  ProtoTypeAST(std::string name, ASTPtrList args_, TYPE::Type type_) :
-      _funcName(std::move(name)), _args(std::move(args_)), _ret_type(type_) {
+  ProtoTypeAST(Symbol name, ASTPtrList args_, TYPE::Type type_) :
+      _funcName(name), _args(std::move(args_)), _ret_type(type_) {
     _type_str = TYPE::type2String(_ret_type);
   }
 
-  std::string getFuncName() { return _funcName; }
+  Symbol getSymbol() const { return _funcName; }
+
+  std::string_view getFuncName() const { return lib::SymbolName(_funcName); }
 
   ASTPtrList &getArgs() { return _args; }
 
@@ -462,17 +478,19 @@ public:
 class FuncParamAST : public BaseAST {
 private:
   ASTPtr type;
-  std::string _arg_name;
+  Symbol _arg_name;
 
 public:
-  FuncParamAST(ASTPtr type_, std::string id)
-      : type(std::move(type_)), _arg_name(std::move(id)) {}
+  FuncParamAST(ASTPtr type_, Symbol id)
+      : type(std::move(type_)), _arg_name(id) {}
 
   std::string getTypeStr() override { return type->getTypeStr(); }
 
   ASTPtr &getType() { return type; }
 
-  std::string ArgName() const override { return _arg_name; }
+  Symbol getSymbol() const { return _arg_name; }
+
+  std::string ArgName() const override { return std::string(lib::SymbolName(_arg_name)); }
 
   void Dump(mid::Dumper *) override;
 
@@ -481,14 +499,32 @@ public:
   SSAPtr CodeGeneAction(mid::IRBuilder *irbuilder) override;
 };
 
+/* ASTContext
+ * Own all AST nodes of a translation unit, nodes are allocated in
+ * an arena and freed together when the context is destroyed.
+ */
+class ASTContext {
+private:
+  lib::Arena _arena;
+
+public:
+  template<typename T, typename... Args>
+  T *New(const front::SourceLoc &loc, Args &&... args) {
+    static_assert(std::is_base_of_v<BaseAST, T>);
+    auto ast = _arena.New<T>(std::forward<Args>(args)...);
+    ast->setLoc(loc);
+    return ast;
+  }
+
+  std::size_t allocated() const { return _arena.allocated(); }
+};
+
 template<typename T, typename... Args>
-ASTPtr MakeAST(front::LoggerPtr logger, Args &&... args) {
-  auto ast = std::make_unique<T>(std::forward<Args>(args)...);
-  ast->setLogger(std::move(logger));
-  return ast;
+ASTPtr MakeAST(ASTContext &context, const front::SourceLoc &loc, Args &&... args) {
+  return context.New<T>(loc, std::forward<Args>(args)...);
 }
 
-PrimASTPtr MakePrimeAST(front::LoggerPtr logger, TYPE::Type type);
+PrimASTPtr MakePrimeAST(ASTContext &context, const front::SourceLoc &loc, TYPE::Type type);
 
 }// namespace RJIT::AST
 
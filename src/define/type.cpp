@@ -4,7 +4,7 @@
 
 
 namespace RJIT::AST {
-Operator string2Operator(const std::string &op, bool isUnary) {
+Operator string2Operator(std::string_view op, bool isUnary) {
   if (op == "~") {
     return Operator::Not;
   } else if (op == "!") {
@@ -155,7 +155,7 @@ std::string operator2String(Operator oper) {
 }
 
 namespace RJIT::TYPE {
-Type string2Type(const std::string &type) {
+Type string2Type(std::string_view type) {
   if (type == "void") {
     return Type::Void;
   } else if (type == "bool") {
@@ -216,10 +216,11 @@ std::string PrimType::GetTypeId() const {
     case Type::Dam:
       return "";
   }
+  return "";
 }
 
 TypeInfoPtr PrimType::GetValueType(bool is_right) const {
-  return std::make_shared<PrimType>(_type, is_right);
+  return MakePrimType(_type, is_right);
 }
 
 std::size_t PrimType::GetSize() const {
@@ -241,8 +242,7 @@ std::string ConstType::GetTypeId() const {
 }
 
 TypeInfoPtr ConstType::GetValueType(bool is_right) const {
-  auto type_ = type->GetValueType(is_right);
-  return std::make_shared<ConstType>(std::move(type_));
+  return MakeConst(type->GetValueType(is_right));
 }
 
 std::string FuncType::GetTypeId() const {
@@ -255,7 +255,7 @@ std::string FuncType::GetTypeId() const {
 }
 
 TypeInfoPtr FuncType::GetValueType(bool is_right) const {
-  return std::make_shared<FuncType>(_args, _ret, is_right);
+  return MakeFuncType(_args, _ret, is_right);
 }
 
 TypeInfoPtr FuncType::GetReturnType() const {
@@ -284,7 +284,7 @@ bool FuncType::operator==(const TypeInfoPtr &typeInfo) {
 }
 
 TypeInfoPtr PointerType::GetValueType(bool is_right) const {
-  return std::make_shared<PointerType>(_base, is_right);
+  return MakePointerType(_base, is_right);
 }
 
 std::string PointerType::GetTypeId() const {
@@ -294,4 +294,37 @@ std::string PointerType::GetTypeId() const {
   return oss.str();
 }
 
-}
\ No newline at end of file
+TypeInfoPtr TypeContext::GetPrimType(Type type, bool is_right) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &prim = _prims[static_cast<std::size_t>(type)][is_right];
+  if (!prim) prim = std::make_shared<PrimType>(type, is_right);
+  return prim;
+}
+
+TypeInfoPtr TypeContext::GetConst(const TypeInfoPtr &type) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &ctype = _consts[type.get()];
+  if (!ctype) ctype = std::make_shared<ConstType>(type);
+  return ctype;
+}
+
+TypeInfoPtr TypeContext::GetPointerType(const TypeInfoPtr &base, bool is_right) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &ptr = _pointers[{base.get(), is_right}];
+  if (!ptr) ptr = std::make_shared<PointerType>(base, is_right);
+  return ptr;
+}
+
+TypeInfoPtr TypeContext::GetFuncType(const TypePtrList &args,
+                                     const TypeInfoPtr &ret, bool is_right) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<const TypeInfo *> arg_keys;
+  arg_keys.reserve(args.size());
+  for (const auto &it : args) arg_keys.push_back(it.get());
+
+  auto &func = _funcs[{std::move(arg_keys), ret.get(), is_right}];
+  if (!func) func = std::make_shared<FuncType>(args, ret, is_right);
+  return func;
+}
+
+}
@@ -1,11 +1,14 @@
 #ifndef RJIT_TYPE_H
 #define RJIT_TYPE_H
 
+#include <map>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
-#include <utility>
 #include <optional>
 
 #include "lib/debug.h"
@@ -18,7 +21,7 @@ enum class Type {
   String, Dam
 };
 
-Type string2Type(const std::string &type);
+Type string2Type(std::string_view type);
 
 std::string type2String(Type type);
 
@@ -205,6 +208,8 @@ public:
     return type->GetDereferenceType();
   }
 
+  const TypeInfoPtr &base() const { return type; }
+
   bool operator==(const TypeInfoPtr &typeInfo) override {
     return type->GetType() == typeInfo->GetType();
   }
@@ -291,29 +296,68 @@ public:
   }
 };
 
-// create a new primitive type
+/* TypeContext
+ * Unique all type objects, each distinct type is created only once,
+ * so that two types are equal if and only if they are the same object.
+ */
+class TypeContext {
+private:
+  static constexpr std::size_t kPrimTypeNum = static_cast<std::size_t>(Type::Dam) + 1;
+
+  using FuncKey = std::tuple<std::vector<const TypeInfo *>, const TypeInfo *, bool>;
+
+  TypeInfoPtr                                              _prims[kPrimTypeNum][2];
+  std::map<const TypeInfo *, TypeInfoPtr>                  _consts;
+  std::map<std::pair<const TypeInfo *, bool>, TypeInfoPtr> _pointers;
+  std::map<FuncKey, TypeInfoPtr>                           _funcs;
+  std::mutex                                               _mutex;  // passes may run in parallel
+
+public:
+  TypeContext() = default;
+  TypeContext(const TypeContext &) = delete;
+  TypeContext &operator=(const TypeContext &) = delete;
+
+  TypeInfoPtr GetPrimType(Type type, bool is_right);
+  TypeInfoPtr GetConst(const TypeInfoPtr &type);
+  TypeInfoPtr GetPointerType(const TypeInfoPtr &base, bool is_right);
+  TypeInfoPtr GetFuncType(const TypePtrList &args, const TypeInfoPtr &ret,
+                          bool is_right);
+
+  // global type context shared by front and middle end
+  static TypeContext &Global() {
+    static TypeContext context;
+    return context;
+  }
+};
+
+// get primitive type
 inline TypeInfoPtr MakePrimType(Type type, bool is_right) {
-  return std::make_shared<PrimType>(type, is_right);
+  return TypeContext::Global().GetPrimType(type, is_right);
+}
+
+// get const type of 'type'
+inline TypeInfoPtr MakeConst(const TypeInfoPtr &type) {
+  return TypeContext::Global().GetConst(type);
 }
 
-// create a new primitive type
+// get const primitive type
 inline TypeInfoPtr MakeConst(Type type, bool is_right = true) {
-  return std::make_shared<ConstType>(MakePrimType(type, is_right));
+  return MakeConst(MakePrimType(type, is_right));
 }
 
-// create a new void type
+// get void type
 inline TypeInfoPtr MakeVoid() {
-  return std::make_shared<PrimType>(Type::Void, true);
+  return MakePrimType(Type::Void, true);
 }
 
 inline TypeInfoPtr
-MakeFuncType(TypePtrList args, TypeInfoPtr ret, bool is_right) {
-  return std::make_shared<FuncType>(args, ret, is_right);
+MakeFuncType(const TypePtrList &args, const TypeInfoPtr &ret, bool is_right) {
+  return TypeContext::Global().GetFuncType(args, ret, is_right);
 }
 
 inline TypeInfoPtr
-MakePointerType(const TypeInfoPtr &type) {
-  return std::make_shared<PointerType>(type, true);
+MakePointerType(const TypeInfoPtr &type, bool is_right = true) {
+  return TypeContext::Global().GetPointerType(type, is_right);
 }
 
 }
@@ -1,41 +1,149 @@
 #include "front/lexer.h"
 #include "define/color.h"
 
+#include <fcntl.h>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace RJIT::front {
-  const std::string Lexer::operators[] = {
-      "+", "-", "*", "/", "=", ">", "<", "~",
-      ">=", "<=", "==", "!=", "!", "|", "&",
-      "(", ")", ",", ";", ":", "\"", "{",
-      "}", "\'", ">>", "<<", "&&", "||",
-      "+=", "-=", "*=", "/=", "%=", "&=",
-      "|=", "^=", "<<=", ">>="
-  };
-
-  const std::string Lexer::keywords[] = {
-      "def", "extern", "if", "else", "then", "for",
-      "in", "binary", "unary", "var", "int32", "string",
-      "char", "return", "uint32", "uint8", "int8", "uint",
-      "void", "int", "bool", "while"
-  };
-
-  bool Lexer::isOperator() const {
-    for (const auto &i : operators) {
-      if (ch == i[0]) {
-        return true;
+  namespace {
+    // keep the same order as enum class 'Keyword'
+    constexpr std::string_view keywordNames[] = {
+        "def", "extern", "if", "else", "then", "for",
+        "in", "binary", "unary", "var", "int32", "string",
+        "char", "return", "uint32", "uint8", "int8", "uint",
+        "void", "int", "bool", "while"
+    };
+
+    constexpr std::size_t keywordNum = std::size(keywordNames);
+    constexpr std::size_t keywordTableSize = 64;
+
+    // perfect hash of keywords, uses length, first and last character
+    constexpr std::size_t hashKeyword(std::string_view value) {
+      return (value.size() * 3 +
+              static_cast<unsigned char>(value.front()) * 18 +
+              static_cast<unsigned char>(value.back())) % keywordTableSize;
+    }
+
+    struct KeywordTable {
+      Keyword slots[keywordTableSize];
+    };
+
+    constexpr KeywordTable makeKeywordTable() {
+      KeywordTable table{};
+      for (auto &slot : table.slots) slot = Keyword::None;
+      for (std::size_t i = 0; i < keywordNum; i++) {
+        table.slots[hashKeyword(keywordNames[i])] = static_cast<Keyword>(i);
       }
+      return table;
     }
-    return false;
+
+    constexpr KeywordTable keywordTable = makeKeywordTable();
+
+    constexpr bool isPerfectHash() {
+      for (std::size_t i = 0; i < keywordNum; i++) {
+        auto kw = keywordTable.slots[hashKeyword(keywordNames[i])];
+        if (kw != static_cast<Keyword>(i)) return false;
+      }
+      return true;
+    }
+
+    static_assert(keywordNum == static_cast<std::size_t>(Keyword::None),
+                  "keyword table mismatch with enum class Keyword");
+    static_assert(isPerfectHash(), "hash of keywords has collisions");
+  }
+
+  Keyword Lexer::lookupKeyword(std::string_view value) {
+    if (value.size() < 2 || value.size() > 6) return Keyword::None;
+    auto kw = keywordTable.slots[hashKeyword(value)];
+    if (kw == Keyword::None ||
+        keywordNames[static_cast<std::size_t>(kw)] != value) {
+      return Keyword::None;
+    }
+    return kw;
   }
 
-  bool Lexer::isKeyword(const std::string &value) {
-    for (const auto &i : keywords) {
-      if (value == i) {
-        return true;
+  void Lexer::mapFile() {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      LogError(__LINE__, __FILE__, "File can't open.");
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      auto size = static_cast<std::size_t>(st.st_size);
+      void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        madvise(addr, size, MADV_SEQUENTIAL);
+        mapped = addr;
+        mappedSize = size;
+        close(fd);
+        setBuffer(static_cast<const char *>(addr), size);
+        return;
       }
     }
-    return false;
+    close(fd);
+
+    // fall back to reading the whole file into one buffer
+    std::ifstream inStream(filename, std::ios::in | std::ios::binary);
+    if (!inStream.is_open()) {
+      LogError(__LINE__, __FILE__, "File can't open.");
+    }
+    content.assign(std::istreambuf_iterator<char>(inStream),
+                   std::istreambuf_iterator<char>());
+    setBuffer(content.data(), content.size());
+  }
+
+  Lexer::~Lexer() {
+    if (mapped) munmap(mapped, mappedSize);
+  }
+
+  Oper Lexer::matchOperator() {
+    switch (ch) {
+      case '+':
+        if (peek('+')) return take(Oper::Inc);
+        return follow('=', Oper::AddAssign, Oper::Add);
+      case '-':
+        if (peek('-')) return take(Oper::Dec);
+        return follow('=', Oper::SubAssign, Oper::Sub);
+      case '*': return follow('=', Oper::MulAssign, Oper::Mul);
+      case '/': return follow('=', Oper::DivAssign, Oper::Div);
+      case '%': return follow('=', Oper::RemAssign, Oper::Rem);
+      case '^': return follow('=', Oper::XorAssign, Oper::Xor);
+      case '=': return follow('=', Oper::Equal, Oper::Assign);
+      case '!': return follow('=', Oper::NotEqual, Oper::LNot);
+      case '&':
+        if (peek('&')) return take(Oper::LAnd);
+        return follow('=', Oper::AndAssign, Oper::And);
+      case '|':
+        if (peek('|')) return take(Oper::LOr);
+        return follow('=', Oper::OrAssign, Oper::Or);
+      case '<':
+        if (peek('<')) {
+          nextChar();
+          return follow('=', Oper::ShlAssign, Oper::Shl);
+        }
+        return follow('=', Oper::LessEq, Oper::Less);
+      case '>':
+        if (peek('>')) {
+          nextChar();
+          return follow('=', Oper::ShrAssign, Oper::Shr);
+        }
+        return follow('=', Oper::GreatEq, Oper::Great);
+      case '~': return Oper::Not;
+      case '(': return Oper::LParen;
+      case ')': return Oper::RParen;
+      case ',': return Oper::Comma;
+      case ';': return Oper::Semicolon;
+      case ':': return Oper::Colon;
+      case '{': return Oper::LBrace;
+      case '}': return Oper::RBrace;
+      default:  return Oper::None;
+    }
   }
 
   bool Lexer::matchChar(char ch_) {
@@ -49,7 +157,7 @@ namespace RJIT::front {
   Token Lexer::nextToken() {
     int curPos, curLine;
     Token token;
-    std::string value;
+    const char *start;
 
     while (isSpace()) { eatSpace(); }
 
@@ -64,85 +172,72 @@ namespace RJIT::front {
       eatSpace();
       if (isEOF()) break;
     }
-    if (inStream.eof()) {
+    if (isEOF()) {
       token.setToken(TokenType::END, "", lineNumber, pos);
     }
 
     if (std::isdigit(ch)) { // number token
       curPos = pos;
       curLine = lineNumber;
+      start = chPtr();
       do {
-        value += ch;
         nextChar();
       } while (std::isdigit(ch));
 
-      token.setToken(TokenType::Int, value, curLine, curPos);
+      token.setToken(TokenType::Int, span(start), curLine, curPos);
     } else if (std::isalpha(ch) || ch == '_') { // keyword or identifier
       curPos = pos;
       curLine = lineNumber;
+      start = chPtr();
       do {
-        value += ch;
         nextChar();
       } while (std::isalpha(ch) || std::isdigit(ch) || ch == '_');
 
-      if (isKeyword(value)) {
+      auto value = span(start);
+      auto keyword = lookupKeyword(value);
+      if (keyword != Keyword::None) {
         token.setToken(TokenType::Keyword, value, curLine, curPos);
+        token.setSubKind(static_cast<uint8_t>(keyword));
       } else {
         token.setToken(TokenType::Identifier, value, curLine, curPos);
       }
-    } else if (isOperator()) {  // operator token
+    } else if (ch == '\'') {    // char token
       curPos = pos;
       curLine = lineNumber;
-      bool eat = true;
-      value += ch;
-
-      bool isChar = false, isString = false;
-
-      /* Check if >=, <=, ==, !=, ||, &&*/
-      if (ch == '=' || ch == '>' || ch == '<' || ch == '!' ||
-          ch == '+' || ch == '-' || ch == '*' || ch == '/' ||
-          ch == '|' || ch == '&') {
-        eat = false;
-        nextChar();
-        if (ch == '=' || ch == '+' || ch == '-' || ch == '|' || ch == '&') {
-          value += ch;
-          eat = true;
-        }
-      } else if (ch == '\'') {    // char token
-        eat = true;
-        isChar = true;
-        if (matchChar('\'')) {
-          LogError(__LINE__, __FILE__, "Expect a char here.");
-        }
-        value = std::string("") + ch;
-        if (!matchChar('\'')) {
-          LogError(__LINE__, __FILE__, "Expect a ' here.");
-        }
-      } else if (ch == '"') { // string token
-        eat = true;
-        isString = true;
-        value = "";
-        if (matchChar('"')) {
-          LogError(__LINE__, __FILE__, "Expect a string here.");
-        }
-        do {
-          value += ch;
-          nextChar();
-          if (isEOF()) {
-            LogError(__LINE__, __FILE__, "Expect a \" here");
-          }
-        } while (ch != '"');
+      if (matchChar('\'')) {
+        LogError(__LINE__, __FILE__, "Expect a char here.");
       }
-
-      if (eat) {
-        nextChar(); // eat space
+      std::string_view value(chPtr(), 1);
+      if (!matchChar('\'')) {
+        LogError(__LINE__, __FILE__, "Expect a ' here.");
       }
-      if (isChar) {
-        token.setToken(TokenType::Char, value, curLine, curPos);
-      } else if (isString) {
-        token.setToken(TokenType::String, value, curLine, curPos);
-      } else {
-        token.setToken(TokenType::Operator, value, curLine, curPos);
+      nextChar();
+      token.setToken(TokenType::Char, value, curLine, curPos);
+    } else if (ch == '"') { // string token
+      curPos = pos;
+      curLine = lineNumber;
+      if (matchChar('"')) {
+        LogError(__LINE__, __FILE__, "Expect a string here.");
+      }
+      start = chPtr();
+      do {
+        nextChar();
+        if (isEOF()) {
+          LogError(__LINE__, __FILE__, "Expect a \" here");
+        }
+      } while (ch != '"');
+      auto value = span(start);
+      nextChar();
+      token.setToken(TokenType::String, value, curLine, curPos);
+    } else if (!isEOF()) {  // operator token
+      curPos = pos;
+      curLine = lineNumber;
+      start = chPtr();
+      auto op = matchOperator();
+      if (op != Oper::None) {
+        nextChar();
+        token.setToken(TokenType::Operator, span(start), curLine, curPos);
+        token.setSubKind(static_cast<uint8_t>(op));
       }
     }
 
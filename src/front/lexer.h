@@ -2,80 +2,149 @@
 #define RJIT_FRONT_LEX_H
 
 #include "front/token.h"
-#include <fstream>
+#include "front/logger.h"
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
 
 namespace RJIT::front {
   class Lexer {
   private:
-    const static std::string operators[];
-    const static std::string keywords[];
-
     char ch = 0;
     std::string filename;
-    std::ifstream inStream;
+    uint16_t fileId = 0;            // id in 'SourceManager'
+
+    // source buffer, either mmap'd from file or provided by caller
+    const char *bufBegin = nullptr;
+    const char *bufEnd = nullptr;
+    const char *cur = nullptr;      // next unread character
+    void *mapped = nullptr;         // non-null if buffer is mmap'd
+    std::size_t mappedSize = 0;
+    std::string content;            // fallback storage if mmap failed
+
+    bool eof = false;
     int lineNumber = 1, pos = 0;
+    std::size_t lineOffset = 0;     // offset of the first char of current line
 
-    bool isSpace() const { return std::isspace(ch); }
+    bool isSpace() const { return std::isspace(static_cast<unsigned char>(ch)); }
 
     void eatSpace() {
       while (isSpace()) {
         nextChar();
-        if (inStream.eof()) break;
+        if (eof) break;
       }
     }
 
     void nextChar() {
-      if (!inStream.eof()) {
-        pos++;
-        ch = inStream.get();
-        if (ch == '\n' || ch == '\r') {
-          pos = 0;
-          lineNumber++;
-        }
+      if (cur == bufEnd) {
+        if (!eof) pos++;
+        eof = true;
+        ch = -1;
+        return;
+      }
+      ch = *cur++;
+      // column is computed from buffer offsets
+      std::size_t offset = cur - bufBegin;
+      if (ch == '\n' || ch == '\r') {
+        lineOffset = offset;
+        lineNumber++;
       }
+      pos = static_cast<int>(offset - lineOffset);
     }
 
-    bool isOperator() const;
+    bool isEOF() const { return eof; }
 
-    bool isEOF() {
-      if (ch == -1 || inStream.eof()) {
-        return true;
-      }
-      return false;
+    // check if the character after current one is 'c'
+    bool peek(char c) const { return cur != bufEnd && *cur == c; }
+
+    // consume the character after current one
+    Oper take(Oper op) {
+      nextChar();
+      return op;
     }
 
-    bool isKeyword(const std::string &value);
+    // take 'yes' if followed by 'c', otherwise 'no'
+    Oper follow(char c, Oper yes, Oper no) {
+      return peek(c) ? take(yes) : no;
+    }
+
+    // match the longest operator starting at current character
+    Oper matchOperator();
+
+    // return Keyword::None if 'value' is not a keyword
+    static Keyword lookupKeyword(std::string_view value);
 
     bool matchChar(char ch_);
 
     void nextLine() {
+      // skip the rest of current line, including '\n'
+      auto nl = static_cast<const char *>(
+          std::memchr(cur, '\n', bufEnd - cur));
+      cur = nl ? nl + 1 : bufEnd;
+      lineOffset = cur - bufBegin;
       pos = 0;
       lineNumber++;
-      inStream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    // pointer to current character
+    const char *chPtr() const { return eof ? bufEnd : cur - 1; }
+
+    // text from 'start' to current character
+    std::string_view span(const char *start) const {
+      return {start, static_cast<std::size_t>(chPtr() - start)};
+    }
+
+    void mapFile();
+
+    void setBuffer(const char *begin, std::size_t size) {
+      bufBegin = begin;
+      bufEnd = begin + size;
+      cur = begin;
+    }
+
+    // distinguishes the in-memory constructor from the file one
+    struct BufferTag {};
+
+    Lexer(BufferTag, std::string_view source, std::string name)
+        : filename(std::move(name)),
+          fileId(SourceManager::get().addFile(filename)) {
+      setBuffer(source.data(), source.size());
+      nextChar();
     }
 
   public:
     Lexer() = default;
 
-    explicit Lexer(const std::string &filename) {
-      this->filename = filename;
-      inStream.open(filename, std::ios::in);
-      if (!inStream.is_open()) {
-        LogError(__LINE__, __FILE__, "File can't open.");
-        exit(-1);
-      }
+    // lex the file, the whole file is mapped into memory
+    explicit Lexer(const std::string &filename)
+        : filename(filename), fileId(SourceManager::get().addFile(filename)) {
+      mapFile();
       nextChar();
     }
 
+    // lex an in-memory source, 'source' must outlive the lexer
+    static Lexer FromBuffer(std::string_view source, std::string name = "<memory>") {
+      return Lexer(BufferTag(), source, std::move(name));
+    }
+
+    Lexer(const Lexer &) = delete;
+
+    Lexer &operator=(const Lexer &) = delete;
+
+    ~Lexer();
 
     Token nextToken();
 
     const std::string &GetFilename() { return filename; }
 
+    uint16_t GetFileId() const { return fileId; }
+
     static void LogInfo(int line, const char *filename, const std::string &info);
 
     static void LogError(int line, const char *filename, const std::string &info);
   };
 }
 
-#endif
\ No newline at end of file
+#endif
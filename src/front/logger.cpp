@@ -4,32 +4,28 @@
 
 namespace RJIT::front {
 
-  std::string_view filename;
-
   int64_t  Logger::error_num = 0, Logger::warn_num = 0;
 
-  void setFilename(const std::string &file) {
-    filename = file;
+  void Logger::printLoc() const {
+    std::cerr << SourceManager::get().getFilename(loc.file) << ":"
+              << loc.line << ":"
+              << loc.col << ": ";
   }
 
   void Logger::LogError(const std::string &info) const {
     auto red = Color::Modifier(Color::Code::FG_RED);
     auto def = Color::Modifier(Color::Code::FG_DEFAULT);
-    std::cerr << filename << ":"
-              << line << ":"
-              << position << ": "
-              << red << "error: " << def
+    printLoc();
+    std::cerr << red << "error: " << def
               << info << std::endl;
     error_num++;
   }
 
-  void Logger::LogError(const std::string &info, const std::string &id) const {
+  void Logger::LogError(const std::string &info, std::string_view id) const {
     auto red = Color::Modifier(Color::Code::FG_RED);
     auto def = Color::Modifier(Color::Code::FG_DEFAULT);
-    std::cerr << filename << ":"
-              << line << ":"
-              << position << ": "
-              << red << "error: " << def
+    printLoc();
+    std::cerr << red << "error: " << def
               << "id: \"" << id << "\", " << info << std::endl;
     error_num++;
   }
@@ -37,10 +33,8 @@ namespace RJIT::front {
   void Logger::LogWarning(const std::string &info) const {
     auto pink = Color::Modifier(Color::Code::FG_PINK);
     auto def = Color::Modifier(Color::Code::FG_DEFAULT);
-    std::cerr << filename << ":"
-              << line << ":"
-              << position << ": "
-              << pink << "warning: " << def
+    printLoc();
+    std::cerr << pink << "warning: " << def
               << info << std::endl;
     warn_num++;
   }
@@ -48,10 +42,8 @@ namespace RJIT::front {
   void Logger::LogInfo(const std::string &info) const {
     auto yel = Color::Modifier(Color::Code::FG_YELLOW);
     auto def = Color::Modifier(Color::Code::FG_DEFAULT);
-    std::cerr << filename << ":"
-              << line << ":"
-              << position << ": "
-              << yel << "info: " << def
+    printLoc();
+    std::cerr << yel << "info: " << def
               << info << std::endl;
   }
 
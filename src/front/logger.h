@@ -1,31 +1,70 @@
 #ifndef RJIT_FRONT_LOGGER_H
 #define RJIT_FRONT_LOGGER_H
 
+#include <cstdint>
 #include <string>
-#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace RJIT::front {
 
-  void setFilename(const std::string &);
+  // packed source location, formatted lazily by 'Logger'
+  struct SourceLoc {
+    uint32_t line = 1;
+    uint16_t col = 1;
+    uint16_t file = 0;      // id in 'SourceManager'
+
+    SourceLoc() = default;
+
+    SourceLoc(uint16_t file_, int line_, int col_)
+        : line(static_cast<uint32_t>(line_)),
+          col(static_cast<uint16_t>(col_)), file(file_) {}
+  };
+
+  static_assert(sizeof(SourceLoc) == 8, "SourceLoc should be packed");
+
+  /* SourceManager
+   * Record names of all source files, so that a 'SourceLoc'
+   * only need to store the file id.
+   */
+  class SourceManager {
+  private:
+    std::vector<std::string> files;
+
+  public:
+    uint16_t addFile(const std::string &name) {
+      files.push_back(name);
+      return static_cast<uint16_t>(files.size() - 1);
+    }
+
+    std::string_view getFilename(uint16_t id) const {
+      return id < files.size() ? std::string_view(files[id]) : "";
+    }
+
+    static SourceManager &get() {
+      static SourceManager manager;
+      return manager;
+    }
+  };
 
   class Logger {
   private:
     static int64_t error_num, warn_num;
-    int line, position;
+    SourceLoc loc;
+
+    // print "file:line:col: "
+    void printLoc() const;
+
   public:
-    Logger() : line(1), position(1) {}
+    Logger() = default;
 
-    Logger(int line_, int position_) :
-        line(line_), position(position_) {}
+    explicit Logger(const SourceLoc &loc_) : loc(loc_) {}
 
-    void setLogger(int line_, int pos) {
-      line = line_;
-      position = pos;
-    }
+    const SourceLoc &getLoc() const { return loc; }
 
     void LogError(const std::string &) const;
 
-    void LogError(const std::string &, const std::string &) const;
+    void LogError(const std::string &, std::string_view) const;
 
     void LogWarning(const std::string &) const;
 
@@ -35,8 +74,6 @@ namespace RJIT::front {
 
     static std::size_t warningNum() { return warn_num; }
   };
-
-  typedef std::shared_ptr<Logger> LoggerPtr;
 }
 
 
@@ -1,3 +1,4 @@
+#include <array>
 #include <cassert>
 #include "parser.h"
 #include "lib/debug.h"
@@ -7,192 +8,165 @@
 using namespace RJIT::TYPE;
 
 namespace RJIT::front {
-  static const std::string UnaryOperator[] = {"!", "-", "@", "$", "%", "^", "~"};
-
-  void Parser::setPrecedence() {
-    BinopPrecedence["="] = 2;
-    BinopPrecedence["+="] = 2;
-    BinopPrecedence["-="] = 2;
-    BinopPrecedence["*="] = 2;
-    BinopPrecedence["/="] = 2;
-    BinopPrecedence["%="] = 2;
-    BinopPrecedence["&="] = 2;
-    BinopPrecedence["|="] = 2;
-    BinopPrecedence["^="] = 2;
-    BinopPrecedence["<<="] = 2;
-    BinopPrecedence[">>="] = 2;
-    BinopPrecedence["||"] = 4;
-    BinopPrecedence["&&"] = 6;
-    BinopPrecedence["|"] = 8;
-    BinopPrecedence["^"] = 10;
-    BinopPrecedence["&"] = 12;
-    BinopPrecedence["<"] = 14;
-    BinopPrecedence[">"] = 14;
-    BinopPrecedence[">="] = 14;
-    BinopPrecedence["<="] = 14;
-    BinopPrecedence["=="] = 14;
-    BinopPrecedence["!="] = 14;
-    BinopPrecedence["<<"] = 16;
-    BinopPrecedence[">>"] = 16;
-    BinopPrecedence["+"] = 20;
-    BinopPrecedence["-"] = 20;
-    BinopPrecedence["*"] = 30;
-    BinopPrecedence["/"] = 30;
-    BinopPrecedence["%"] = 30;
+  namespace {
+    struct OperInfo {
+      int prec = -1;            // -1 if not a binary operator
+      bool rightAssoc = false;
+      Operator binary = Operator::Dam;
+    };
+
+    constexpr OperInfo getOperInfo(Oper op) {
+      switch (op) {
+        case Oper::Assign:    return {2, true, Operator::Assign};
+        case Oper::AddAssign: return {2, true, Operator::AssAdd};
+        case Oper::SubAssign: return {2, true, Operator::AssSub};
+        case Oper::MulAssign: return {2, true, Operator::AssMul};
+        case Oper::DivAssign: return {2, true, Operator::AssSDiv};
+        case Oper::RemAssign: return {2, true, Operator::AssSRem};
+        case Oper::AndAssign: return {2, true, Operator::AssAnd};
+        case Oper::OrAssign:  return {2, true, Operator::AssOr};
+        case Oper::XorAssign: return {2, true, Operator::AssXor};
+        case Oper::ShlAssign: return {2, true, Operator::AssShl};
+        case Oper::ShrAssign: return {2, true, Operator::AssAShr};
+        case Oper::LOr:       return {4, false, Operator::LOr};
+        case Oper::LAnd:      return {6, false, Operator::LAnd};
+        case Oper::Or:        return {8, false, Operator::Or};
+        case Oper::Xor:       return {10, false, Operator::Xor};
+        case Oper::And:       return {12, false, Operator::And};
+        case Oper::Less:      return {14, false, Operator::SLess};
+        case Oper::Great:     return {14, false, Operator::SGreat};
+        case Oper::GreatEq:   return {14, false, Operator::SGreatEq};
+        case Oper::LessEq:    return {14, false, Operator::SLessEq};
+        case Oper::Equal:     return {14, false, Operator::Equal};
+        case Oper::NotEqual:  return {14, false, Operator::NotEqual};
+        case Oper::Shl:       return {16, false, Operator::Shl};
+        case Oper::Shr:       return {16, false, Operator::AShr};
+        case Oper::Add:       return {20, false, Operator::Add};
+        case Oper::Sub:       return {20, false, Operator::Sub};
+        case Oper::Mul:       return {30, false, Operator::Mul};
+        case Oper::Div:       return {30, false, Operator::SDiv};
+        case Oper::Rem:       return {30, false, Operator::SRem};
+        default:              return {};
+      }
+    }
+
+    constexpr std::size_t operCount = static_cast<std::size_t>(Oper::None) + 1;
+
+    constexpr std::array<OperInfo, operCount> makeOperTable() {
+      std::array<OperInfo, operCount> table{};
+      for (std::size_t i = 0; i < operCount; ++i) {
+        table[i] = getOperInfo(static_cast<Oper>(i));
+      }
+      return table;
+    }
+
+    // precedence, associativity and AST operator of each token operator
+    constexpr auto operTable = makeOperTable();
+
+    constexpr const OperInfo &operInfo(Oper op) {
+      return operTable[static_cast<std::size_t>(op)];
+    }
+
+    static_assert(operInfo(Oper::Mul).prec > operInfo(Oper::Add).prec);
+    static_assert(operInfo(Oper::Assign).rightAssoc);
+    static_assert(operInfo(Oper::None).prec < 0);
+
+    constexpr Operator unaryOperator(Oper op) {
+      switch (op) {
+        case Oper::Not:  return Operator::Not;
+        case Oper::LNot: return Operator::LNot;
+        case Oper::Sub:  return Operator::Neg;
+        default:         return operInfo(op).binary;
+      }
+    }
   }
 
   int Parser::getPrecedence() {
-    if (curToken.getTokenType() != TokenType::Operator) return -1;
-    int prec = BinopPrecedence[curToken.getOperValue()];
-    if (prec <= 0) return -1;
-    return prec;
+    // 'getOper' returns Oper::None for non-operator tokens
+    return operInfo(curToken.getOper()).prec;
   }
 
   bool Parser::isIncrement() {
-    if (curToken.isOper() && curToken.getOperValue() == "++") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::Inc);
   }
 
   bool Parser::isDecrement() {
-    if (curToken.isOper() && curToken.getOperValue() == "--") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::Dec);
   }
 
   bool Parser::isLeftBrace() {
-    if (curToken.isOper() && curToken.getOperValue() == "{") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::LBrace);
   }
 
   bool Parser::isRightBrace() {
-    if (curToken.isOper() && curToken.getOperValue() == "}") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::RBrace);
   }
 
   bool Parser::isLeftParentheses() {
-    if (curToken.isOper() && curToken.getOperValue() == "(") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::LParen);
   }
 
   bool Parser::isRightParentheses() {
-    if (curToken.isOper() && curToken.getOperValue() == ")") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::RParen);
   }
 
   bool Parser::isComma() {
-    if (curToken.isOper() && curToken.getOperValue() == ",") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::Comma);
   }
 
   bool Parser::isColon() {
-    if (curToken.isOper() && curToken.getOperValue() == ":") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::Colon);
   }
 
   bool Parser::isSemicolon() {
-    if (curToken.isOper() && curToken.getOperValue() == ";") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::Semicolon);
   }
 
   bool Parser::isEqualSign() {
-    if (curToken.isOper() && curToken.getOperValue() == "=") {
-      return true;
-    }
-    return false;
+    return curToken.isOper(Oper::Assign);
   }
 
   bool Parser::isDefine() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "def") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::Def);
   }
 
   bool Parser::isExtern() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "extern") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::Extern);
   }
 
   bool Parser::isIf() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "if") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::If);
   }
 
   bool Parser::isThen() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "then") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::Then);
   }
 
   bool Parser::isElse() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "else") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::Else);
   }
 
   bool Parser::isFor() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "for") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::For);
   }
 
   bool Parser::isWhile() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "while") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::While);
   }
 
   bool Parser::isReturn() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "return") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::Return);
   }
 
 
   bool Parser::isUnary() {
-    if (curToken.isOper()) {
-      std::string op = curToken.getOperValue();
-      for (const auto &i : UnaryOperator) {
-        if (i == op) {
-          return true;
-        }
-      }
+    switch (curToken.getOper()) {
+      case Oper::LNot: case Oper::Sub: case Oper::Rem:
+      case Oper::Xor: case Oper::Not:
+        return true;
+      default:
+        return false;
     }
-    return false;
   }
 
   bool Parser::isConst() {
@@ -203,27 +177,15 @@ namespace RJIT::front {
   }
 
   bool Parser::isIn() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "in") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::In);
   }
 
   bool Parser::isEnd() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "end") {
-      return true;
-    }
-    return false;
+    return curToken.getTokenType() == TokenType::END;
   }
 
   bool Parser::isVar() {
-    if (curToken.isKeyword() &&
-        curToken.getKeywordValue() == "var") {
-      return true;
-    }
-    return false;
+    return curToken.isKeyword(Keyword::Var);
   }
 
   TYPE::Type Parser::getType() {
@@ -250,7 +212,7 @@ namespace RJIT::front {
 
   ASTPtr Parser::ParseVariableDecl() {
     nextToken();// eat var
-    ASTPtr variableDefAst;
+    ASTPtr variableDefAst = nullptr;
     ASTPtrList defs;
 
     if (!curToken.isIdentifier()) {
@@ -265,9 +227,9 @@ namespace RJIT::front {
 
     nextToken();// eat :
 
-    auto log = logger();
+    auto loc = location();
     auto type = string2Type(curToken.getKeywordValue());
-    PrimASTPtr typeASTPtr = MakePrimeAST(std::move(log), type);
+    PrimASTPtr typeASTPtr = MakePrimeAST(context, loc, type);
 
     nextToken();// eat type
     if (!isSemicolon()) {
@@ -275,21 +237,21 @@ namespace RJIT::front {
     }
     nextToken();// eat ;
 
-    log = logger();
+    loc = location();
     return MakeAST<VariableDecl>(
-        std::move(log), std::move(typeASTPtr), std::move(defs));
+        context, loc, std::move(typeASTPtr), std::move(defs));
   }
 
   ASTPtr Parser::ParseVariableDefine() {
-    std::string identifier;
+    lib::Symbol identifier = 0;
     ASTPtr initValue = nullptr;
-    auto log = logger();
+    auto loc = location();
     if (!curToken.isIdentifier()) {
       return LogError("Expect identifier here.");
     }
 
     // Get variable name
-    identifier = curToken.getIdentifierValue();
+    identifier = curToken.getSymbol();
     nextToken();// eat identifier
 
     // check init value
@@ -297,13 +259,13 @@ namespace RJIT::front {
       nextToken();// eat =
       switch (curToken.getTokenType()) {
         case TokenType::Int:
-          initValue = MakeAST<IntAST>(std::move(log), curToken.getIntValue());
+          initValue = MakeAST<IntAST>(context, loc, curToken.getIntValue());
           break;
         case TokenType::Char:
-          initValue = MakeAST<CharAST>(std::move(log), curToken.getCharValue());
+          initValue = MakeAST<CharAST>(context, loc, curToken.getCharValue());
           break;
         case TokenType::String:
-          initValue = MakeAST<StringAST>(std::move(log), curToken.getStringValue());
+          initValue = MakeAST<StringAST>(context, loc, std::string(curToken.getStringValue()));
           break;
         default:
           return LogError("Expect a int, char, string here.");
@@ -319,8 +281,8 @@ namespace RJIT::front {
     // eat ,
     if (isComma()) { nextToken(); }
 
-    log = logger();
-    return MakeAST<VariableDefAST>(std::move(log), identifier, std::move(initValue));
+    loc = location();
+    return MakeAST<VariableDefAST>(context, loc, identifier, std::move(initValue));
   }
 
   ASTPtr Parser::ParseParenExpr() {
@@ -335,12 +297,12 @@ namespace RJIT::front {
   }
 
   ASTPtr Parser::ParseUnary() {
-    auto log = logger();
+    auto loc = location();
     if (isUnary()) {
-      std::string op = curToken.getOperValue();
+      auto op = unaryOperator(curToken.getOper());
       nextToken();// eat operator
       if (auto operand = ParseUnary()) {
-        return MakeAST<UnaryStmt>(std::move(log), string2Operator(op, true), std::move(operand));
+        return MakeAST<UnaryStmt>(context, loc, op, std::move(operand));
       }
     } else {
       return ParsePrimary();
@@ -359,48 +321,49 @@ namespace RJIT::front {
       int tokPrec = getPrecedence();
       if (tokPrec < prec) return lhs;
 
-      Operator op = string2Operator(curToken.getOperValue());
+      const auto &info = operInfo(curToken.getOper());
       nextToken();// eat operator
 
       ASTPtr rhs = ParseUnary();
       if (!rhs) return nullptr;
 
+      // bind tighter operators, and the same ones if right associative
       int nextPrec = getPrecedence();
-      if (tokPrec < nextPrec) {
-        rhs = ParseBinaryOPRHS(tokPrec + 1, std::move(rhs));
+      if (tokPrec < nextPrec || (tokPrec == nextPrec && info.rightAssoc)) {
+        rhs = ParseBinaryOPRHS(info.rightAssoc ? tokPrec : tokPrec + 1, std::move(rhs));
         if (!rhs) return nullptr;
       }
 
-      auto log = logger();
+      auto loc = location();
       lhs = MakeAST<BinaryStmt>(
-          std::move(log), op, std::move(lhs), std::move(rhs));
+          context, loc, info.binary, std::move(lhs), std::move(rhs));
     }
   }
 
   ASTPtr Parser::ParseIdentifier() {
     assert(curToken.isIdentifier());
-    std::string identName = curToken.getIdentifierValue();
+    auto identName = curToken.getSymbol();
     nextToken();
 
 
     /* Parse variable */
     if (!isLeftParentheses()) {
-      auto log = logger();
-      ASTPtr varAST = MakeAST<VariableAST>(std::move(log), identName);
+      auto loc = location();
+      ASTPtr varAST = MakeAST<VariableAST>(context, loc, identName);
       if (!isEqualSign() && !isIncrement() && !isDecrement()) {
         return varAST;
       } else if (isIncrement()) {
-        auto intVal = MakeAST<IntAST>(logger(), 1);
+        auto intVal = MakeAST<IntAST>(context, location(), 1);
 
         nextToken(); // eat '++'
 
-        return MakeAST<BinaryStmt>(std::move(log), Operator::Add, std::move(varAST), std::move(intVal));
+        return MakeAST<BinaryStmt>(context, loc, Operator::Add, std::move(varAST), std::move(intVal));
       } else if (isDecrement()) {
-        auto intVal = MakeAST<IntAST>(logger(), 1);
+        auto intVal = MakeAST<IntAST>(context, location(), 1);
 
         nextToken(); // eat '--'
 
-        return MakeAST<BinaryStmt>(std::move(log), Operator::Sub, std::move(varAST), std::move(intVal));
+        return MakeAST<BinaryStmt>(context, loc, Operator::Sub, std::move(varAST), std::move(intVal));
       } else if (isEqualSign()) {
         ASTPtr assignAST = ParseBinaryOPRHS(0, std::move(varAST));
 
@@ -416,18 +379,18 @@ namespace RJIT::front {
 
   ASTPtr Parser::ParseFunctionCall() {
     assert(curToken.isIdentifier());
-    std::string identName = curToken.getIdentifierValue();
+    auto identName = curToken.getSymbol();
     nextToken();
 
     return ParseFunctionCall(identName);
   }
 
-  ASTPtr Parser::ParseFunctionCall(const std::string &func_name) {
+  ASTPtr Parser::ParseFunctionCall(lib::Symbol func_name) {
     assert(isLeftParentheses());
     nextToken();// eat '('
 
     ASTPtrList args;
-    ASTPtr argAST;
+    ASTPtr argAST = nullptr;
     if (!isRightParentheses()) {
       while (true) {
         argAST = ParseExpression();
@@ -447,8 +410,8 @@ namespace RJIT::front {
     }
     nextToken();// eat ')'
 
-    auto log = logger();
-    return MakeAST<CallStmt>(std::move(log), func_name, std::move(args));
+    auto loc = location();
+    return MakeAST<CallStmt>(context, loc, func_name, std::move(args));
   }
 
   ASTPtr Parser::ParseFunctionDef() {
@@ -456,16 +419,16 @@ namespace RJIT::front {
 
     Type type;
     ASTPtrList args;
-    ASTPtr funcDefAST, protoAST, argAST, blockAST;
-    ASTPtr typeAST;
-    std::string funcName, argName;
-    LoggerPtr log;
+    ASTPtr protoAST = nullptr, argAST = nullptr, blockAST = nullptr;
+    ASTPtr typeAST = nullptr;
+    lib::Symbol funcName = 0, argName = 0;
+    SourceLoc loc;
 
     if (!curToken.isIdentifier()) {
       LogError("Expect function name in function Proto.");
     }
 
-    funcName = curToken.getIdentifierValue();
+    funcName = curToken.getSymbol();
     nextToken();// eat function name
 
     if (!isLeftParentheses()) {
@@ -479,7 +442,7 @@ namespace RJIT::front {
           LogError("Expect a identifier in function arguments.");
         }
 
-        argName = curToken.getIdentifierValue();
+        argName = curToken.getSymbol();
         nextToken();// eat argument name
         type = getType();
 
@@ -488,11 +451,11 @@ namespace RJIT::front {
         }
         nextToken();// eat type
 
-        log = logger();
-        typeAST = MakeAST<PrimTypeAST>(std::move(log), type);
+        loc = location();
+        typeAST = MakeAST<PrimTypeAST>(context, loc, type);
 
-        log = logger();
-        argAST = MakeAST<FuncParamAST>(std::move(log), std::move(typeAST), argName);
+        loc = location();
+        argAST = MakeAST<FuncParamAST>(context, loc, std::move(typeAST), argName);
         args.push_back(std::move(argAST));
 
         if (isRightParentheses()) break;
@@ -507,7 +470,7 @@ namespace RJIT::front {
 
 
     type = getType();
-    if (curToken.getOperValue() != "{") {
+    if (!isLeftBrace()) {
       if (type == Type::Dam) {
         LogError("Expect a corrent type for function return.");
       }
@@ -516,15 +479,15 @@ namespace RJIT::front {
       type = Type::Void;
     }
 
-    log = logger();
-    protoAST = MakeAST<ProtoTypeAST>(std::move(log), funcName, std::move(args), type);
+    loc = location();
+    protoAST = MakeAST<ProtoTypeAST>(context, loc, funcName, std::move(args), type);
 
 
     blockAST = ParseBlock();
     if (!blockAST) return nullptr;
 
-    log = logger();
-    return MakeAST<FunctionDefAST>(std::move(log), std::move(protoAST), std::move(blockAST));
+    loc = location();
+    return MakeAST<FunctionDefAST>(context, loc, std::move(protoAST), std::move(blockAST));
   }
 
   ASTPtr Parser::ParseIfElse() {
@@ -541,14 +504,14 @@ namespace RJIT::front {
       if (!else_) return nullptr;
     }
 
-    auto log = logger();
+    auto loc = location();
     return MakeAST<IfElseStmt>(
-        std::move(log), std::move(cond), std::move(then_), std::move(else_));
+        context, loc, std::move(cond), std::move(then_), std::move(else_));
   }
 
   ASTPtr Parser::ParseWhile() {
     nextToken();// eat while
-    ASTPtr cond, block;
+    ASTPtr cond = nullptr, block = nullptr;
 
     cond = ParseExpression();
     if (!cond) return nullptr;
@@ -556,12 +519,12 @@ namespace RJIT::front {
     block = ParseBlock();
     if (!block) return nullptr;
 
-    auto log = logger();
-    return MakeAST<WhileStmt>(std::move(log), std::move(cond), std::move(block));
+    auto loc = location();
+    return MakeAST<WhileStmt>(context, loc, std::move(cond), std::move(block));
   }
 
   ASTPtr Parser::ParseBlock() {
-    ASTPtr blockAST, expr;
+    ASTPtr blockAST = nullptr, expr = nullptr;
     ASTPtrList exprs;
     if (!isLeftBrace()) {
       LogError("Expect '{' here.");
@@ -578,20 +541,22 @@ namespace RJIT::front {
     }
     nextToken();// eat '}'
 
-    auto log = logger();
-    blockAST = MakeAST<CompoundStmt>(std::move(log), std::move(exprs));
+    auto loc = location();
+    blockAST = MakeAST<CompoundStmt>(context, loc, std::move(exprs));
     return blockAST;
   }
 
   ASTPtr Parser::ParseConst() {
-    ASTPtr constAST;
-    auto log = logger();
+    ASTPtr constAST = nullptr;
+    auto loc = location();
     if (curToken.isString()) {
-      constAST = MakeAST<StringAST>(std::move(log), curToken.getStringValue());
+      constAST = MakeAST<StringAST>(context, loc, std::string(curToken.getStringValue()));
     } else if (curToken.isInt()) {
-      constAST = MakeAST<IntAST>(std::move(log), curToken.getIntValue());
+      constAST = MakeAST<IntAST>(context, loc, curToken.getIntValue());
     } else if (curToken.isChar()) {
-      constAST = MakeAST<CharAST>(std::move(log), curToken.getCharValue());
+      constAST = MakeAST<CharAST>(context, loc, curToken.getCharValue());
+    } else {
+      LogError("Expect a int, char, string here.");
     }
     nextToken();// eat const value
     return constAST;
@@ -601,14 +566,14 @@ namespace RJIT::front {
     nextToken();// eat return
     auto retVal = ParseExpression();
 
-    auto log = logger();
-    ASTPtr retAST = MakeAST<ReturnStmt>(std::move(log), std::move(retVal));
+    auto loc = location();
+    ASTPtr retAST = MakeAST<ReturnStmt>(context, loc, std::move(retVal));
 
     return retAST;
   }
 
   ASTPtr Parser::ParsePrimary() {
-    ASTPtr node;
+    ASTPtr node = nullptr;
     if (isDefine()) {
       node = ParseFunctionDef();
     } else if (isVar()) {
@@ -639,7 +604,7 @@ namespace RJIT::front {
 
   void Parser::Parse() {
     ASTPtrList defs;
-    ASTPtr def;
+    ASTPtr def = nullptr;
     def = ParseTop();
     while (true) {
       if (!def) { break; }
@@ -647,8 +612,8 @@ namespace RJIT::front {
       def = ParseTop();
     }
 
-    auto log = logger();
-    rootNode = MakeAST<TranslationUnitDecl>(std::move(log), std::move(defs));
+    auto loc = location();
+    rootNode = MakeAST<TranslationUnitDecl>(context, loc, std::move(defs));
   }
 
 }// namespace RJIT::front
\ No newline at end of file
@@ -1,7 +1,6 @@
 #ifndef RJIT_FRONT_PARSER_H
 #define RJIT_FRONT_PARSER_H
 
-#include <map>
 #include <iostream>
 #include <optional>
 
@@ -17,11 +16,9 @@ namespace RJIT::front {
   class Parser {
     Token curToken;
     Lexer *lexer;
-    std::map<std::string, int> BinopPrecedence;
+    ASTContext context;     // owns all AST nodes
 
-    ASTPtr rootNode;
-
-    void setPrecedence();
+    ASTPtr rootNode = nullptr;
 
     int getPrecedence();
 
@@ -93,7 +90,7 @@ namespace RJIT::front {
 
     ASTPtr ParseFunctionCall();
 
-    ASTPtr ParseFunctionCall(const std::string &func_name);
+    ASTPtr ParseFunctionCall(lib::Symbol func_name);
 
     ASTPtr ParseVariableDefine();
 
@@ -115,8 +112,6 @@ namespace RJIT::front {
     Parser() = default;
 
     explicit Parser(Lexer *lexer_) : lexer(lexer_) {
-      setFilename(lexer->GetFilename());
-      setPrecedence();
       nextToken();    // Load first token
     }
 
@@ -129,9 +124,9 @@ namespace RJIT::front {
       std::cout << std::endl;
     }
 
-    LoggerPtr logger() {
-      auto log = std::make_unique<front::Logger>(curToken.getLineNumber(), curToken.getPosition());
-      return log;
+    // location of current token
+    SourceLoc location() const {
+      return {lexer->GetFileId(), curToken.getLineNumber(), curToken.getPosition()};
     }
 
     ASTPtr &ast() { return rootNode; }
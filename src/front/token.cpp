@@ -5,60 +5,41 @@
 
 namespace RJIT::front {
 
-  void Token::setToken(TokenType type_, const std::string &value, int line, int position) {
+  void Token::setToken(TokenType type_, std::string_view value, int line, int position) {
     this->setType(type_);
     this->setLine(line);
     this->setPosition(position);
+    this->text = value.data();
+    this->length = static_cast<uint32_t>(value.size());
     switch (type) {
-      case TokenType::Keyword: {
-        this->keywordValue = value;
-        break;
-      }
-      case TokenType::Operator: {
-        this->operatorValue = value;
-        break;
-      }
-      case TokenType::Identifier: {
-        this->identifierValue = value;
-        break;
-      }
       case TokenType::Int: {
-        this->intValue = std::stoi(value);
+        int num = 0;
+        for (auto c : value) num = num * 10 + (c - '0');
+        this->intValue = num;
         break;
       }
       case TokenType::Char: {
-        this->charValue = value.c_str()[0];
+        this->intValue = static_cast<uint8_t>(value.empty() ? 0 : value[0]);
         break;
       }
-      case TokenType::String: {
-        this->stringValue = value;
+      case TokenType::Identifier: {
+        this->intValue = static_cast<int>(lib::Intern(value));
         break;
       }
-      case TokenType::END: {
+      default:
         break;
-      }
     }
   }
 
   std::string Token::getValue() const {
-    std::string value;
     switch (type) {
-      case TokenType::Keyword:
-        return keywordValue;
-      case TokenType::Operator:
-        return operatorValue;
-      case TokenType::Identifier:
-        return identifierValue;
       case TokenType::Int:
         return std::to_string(intValue);
-      case TokenType::Char:
-        return std::string(1, charValue);
-      case TokenType::String:
-        return stringValue;
       case TokenType::END:
         return "";
+      default:
+        return std::string(getText());
     }
-    return "";
   }
 
   std::string Token::type2String() {
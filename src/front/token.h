@@ -1,39 +1,78 @@
 #ifndef RJIT_FRONT_TOKEN_H
 #define RJIT_FRONT_TOKEN_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include "lib/intern.h"
 
 namespace RJIT::front {
-  enum class TokenType {
+  enum class TokenType : uint8_t {
     Keyword, Operator, Identifier, Int, Char, String, END
   };
 
+  // keep the same order as 'keywordNames' in lexer.cpp
+  enum class Keyword : uint8_t {
+    Def, Extern, If, Else, Then, For, In, Binary, Unary, Var,
+    Int32, String, Char, Return, UInt32, UInt8, Int8, UInt,
+    Void, Int, Bool, While, None
+  };
+
+  enum class Oper : uint8_t {
+    // single character
+    Add, Sub, Mul, Div, Rem, Assign, Great, Less, Not, LNot,
+    Or, And, Xor, LParen, RParen, Comma, Semicolon, Colon,
+    LBrace, RBrace,
+    // two characters
+    GreatEq, LessEq, Equal, NotEqual, Shr, Shl, LAnd, LOr, Inc, Dec,
+    AddAssign, SubAssign, MulAssign, DivAssign, RemAssign,
+    AndAssign, OrAssign, XorAssign,
+    // three characters
+    ShlAssign, ShrAssign,
+    None
+  };
+
+  // Token is a small trivially copyable value, its text is a span into
+  // the lexer's source buffer, so the buffer must outlive the token.
   class Token {
   private:
-    TokenType type;
-    int intValue;
-    uint8_t charValue;
-    std::string stringValue;
-    std::string keywordValue;
-    std::string operatorValue;
-    std::string identifierValue;
+    TokenType type = TokenType::END;
+    uint8_t subKind = 0;        // Keyword or Oper
+    int intValue = 0;           // pre-parsed int or char value, or symbol id
     int lineNumber = -1, pos = -1;
+    uint32_t length = 0;
+    const char *text = nullptr;
   public:
     Token() = default;
 
     TokenType getTokenType() const { return type; }
 
+    uint8_t getSubKind() const { return subKind; }
+
+    Keyword getKeyword() const {
+      return isKeyword() ? static_cast<Keyword>(subKind) : Keyword::None;
+    }
+
+    Oper getOper() const {
+      return isOper() ? static_cast<Oper>(subKind) : Oper::None;
+    }
+
     int getIntValue() const { return intValue; }
 
-    uint8_t getCharValue() const { return charValue; }
+    uint8_t getCharValue() const { return static_cast<uint8_t>(intValue); }
+
+    // interned id of an identifier
+    lib::Symbol getSymbol() const { return static_cast<lib::Symbol>(intValue); }
+
+    std::string_view getText() const { return {text, length}; }
 
-    const std::string &getStringValue() const { return stringValue; }
+    std::string_view getStringValue() const { return getText(); }
 
-    const std::string &getKeywordValue() const { return keywordValue; }
+    std::string_view getKeywordValue() const { return getText(); }
 
-    const std::string &getOperValue() const { return operatorValue; }
+    std::string_view getOperValue() const { return getText(); }
 
-    const std::string &getIdentifierValue() const { return identifierValue; }
+    std::string_view getIdentifierValue() const { return getText(); }
 
     std::string getValue() const;
 
@@ -41,7 +80,7 @@ namespace RJIT::front {
 
     int getPosition() const { return pos; }
 
-    void setToken(TokenType type, const std::string &value, int line, int position);
+    void setToken(TokenType type, std::string_view value, int line, int position);
 
     void setPosition(int position) { pos = position; }
 
@@ -49,6 +88,8 @@ namespace RJIT::front {
 
     void setType(TokenType type_) { type = type_; }
 
+    void setSubKind(uint8_t kind) { subKind = kind; }
+
     std::string type2String();
 
     bool isIdentifier() const { return type == TokenType::Identifier; }
@@ -57,8 +98,16 @@ namespace RJIT::front {
 
     bool isOper() const { return type == TokenType::Operator; }
 
+    bool isOper(Oper op) const {
+      return isOper() && subKind == static_cast<uint8_t>(op);
+    }
+
     bool isKeyword() const { return type == TokenType::Keyword; }
 
+    bool isKeyword(Keyword kw) const {
+      return isKeyword() && subKind == static_cast<uint8_t>(kw);
+    }
+
     bool isInt() const { return type == TokenType::Int; }
 
     bool isChar() const { return type == TokenType::Char; }
@@ -69,4 +118,4 @@ namespace RJIT::front {
   };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,97 @@
+#ifndef RJIT_ARENA_H
+#define RJIT_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RJIT::lib {
+
+/* Arena
+ * Bump allocator with typed allocation. Objects are placed in large
+ * chunks and live as long as the arena, destructors of non-trivially
+ * destructible objects run in reverse order when the arena is destroyed,
+ * then all chunks are released at once.
+ */
+class Arena {
+private:
+  static constexpr std::size_t kChunkSize = 64 * 1024;
+
+  struct Finalizer {
+    void *object;
+    void (*destroy)(void *);
+  };
+
+  std::vector<void *>    _chunks;
+  std::vector<Finalizer> _finalizers;
+  char                  *_cur = nullptr;
+  char                  *_end = nullptr;
+  std::size_t            _allocated = 0;
+
+  void *NewChunk(std::size_t size) {
+    auto chunk = ::operator new(size);
+    _chunks.push_back(chunk);
+    return chunk;
+  }
+
+public:
+  Arena() = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  ~Arena() { Clear(); }
+
+  // allocate raw memory
+  void *Allocate(std::size_t size, std::size_t align) {
+    auto addr = reinterpret_cast<std::uintptr_t>(_cur);
+    auto aligned = (addr + align - 1) & ~(std::uintptr_t)(align - 1);
+    if (_cur == nullptr || aligned + size > reinterpret_cast<std::uintptr_t>(_end)) {
+      // oversized object gets a chunk of its own
+      if (size + align > kChunkSize / 4) {
+        _allocated += size;
+        return NewChunk(size);
+      }
+      _cur = static_cast<char *>(NewChunk(kChunkSize));
+      _end = _cur + kChunkSize;
+      addr = reinterpret_cast<std::uintptr_t>(_cur);
+      aligned = (addr + align - 1) & ~(std::uintptr_t)(align - 1);
+    }
+    _cur = reinterpret_cast<char *>(aligned + size);
+    _allocated += size;
+    return reinterpret_cast<void *>(aligned);
+  }
+
+  // construct an object of type T in arena
+  template <typename T, typename... Args>
+  T *New(Args &&... args) {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type");
+    auto mem = Allocate(sizeof(T), alignof(T));
+    auto obj = new (mem) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      _finalizers.push_back({obj, [](void *p) { static_cast<T *>(p)->~T(); }});
+    }
+    return obj;
+  }
+
+  // destroy all objects and release memory
+  void Clear() {
+    for (auto it = _finalizers.rbegin(); it != _finalizers.rend(); ++it) {
+      it->destroy(it->object);
+    }
+    _finalizers.clear();
+    for (auto chunk : _chunks) ::operator delete(chunk);
+    _chunks.clear();
+    _cur = _end = nullptr;
+    _allocated = 0;
+  }
+
+  // total bytes handed out
+  std::size_t allocated() const { return _allocated; }
+};
+
+}
+
+#endif //RJIT_ARENA_H
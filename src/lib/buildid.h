@@ -0,0 +1,30 @@
+#ifndef RJIT_BUILDID_H
+#define RJIT_BUILDID_H
+
+#include <fstream>
+#include <string>
+
+#include "lib/hash.h"
+
+namespace RJIT::lib {
+
+// id of the running executable, hash of its contents, so that results
+// cached by one build are never used by another build of same version.
+// Empty if the executable can not be read
+inline const std::string &BuildId() {
+  static const std::string build_id = [] {
+    std::ifstream ifs("/proc/self/exe", std::ios::binary);
+    if (!ifs) return std::string();
+    Hasher hasher;
+    char buf[1 << 16];
+    while (ifs.read(buf, sizeof(buf)) || ifs.gcount()) {
+      hasher.Update(buf, static_cast<std::size_t>(ifs.gcount()));
+    }
+    return ifs.eof() ? hasher.HexDigest() : std::string();
+  }();
+  return build_id;
+}
+
+}
+
+#endif //RJIT_BUILDID_H
@@ -49,7 +49,8 @@
 # define TRACE0()
 # define TRACE(fmt, ...)
 # define DBG_WARN(cond, fmt, ...)
-# define DBG_ASSERT(cond, fmt, ...)
+// keep 'cond' referenced but unevaluated, avoid unused variable warnings
+# define DBG_ASSERT(cond, fmt, ...) do { (void)sizeof(!(cond)); } while (0)
 #endif // Is_True_On
 
 #define REL_ASSERT(cond, fmt, ...) \
@@ -0,0 +1,55 @@
+#ifndef RJIT_HASH_H
+#define RJIT_HASH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace RJIT::lib {
+
+/* Hasher
+ * Streaming 64-bit FNV-1a hash. Unlike 'std::hash', the result is the
+ * same across builds and platforms, so it can be used in file names of
+ * persistent caches.
+ */
+class Hasher {
+private:
+  std::uint64_t _hash = 0xcbf29ce484222325ULL;
+
+public:
+  Hasher &Update(const void *data, std::size_t size) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      _hash ^= bytes[i];
+      _hash *= 0x100000001b3ULL;
+    }
+    return *this;
+  }
+
+  // strings are prefixed with their length, so that concatenations
+  // of different strings do not collide
+  Hasher &Update(std::string_view str) {
+    Update(static_cast<std::uint64_t>(str.size()));
+    return Update(str.data(), str.size());
+  }
+
+  Hasher &Update(std::uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i) bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+    return Update(bytes, sizeof(bytes));
+  }
+
+  std::uint64_t digest() const { return _hash; }
+
+  std::string HexDigest() const {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx",
+                  static_cast<unsigned long long>(_hash));
+    return buf;
+  }
+};
+
+}
+
+#endif //RJIT_HASH_H
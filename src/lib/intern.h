@@ -0,0 +1,62 @@
+#ifndef RJIT_INTERN_H
+#define RJIT_INTERN_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace RJIT::lib {
+
+// stable id of an interned identifier
+using Symbol = std::uint32_t;
+
+/* Interner
+ * Assign each distinct identifier a stable 32-bit id, so that symbol
+ * tables can be keyed on integers instead of strings.
+ * Interned names live until the end of program.
+ */
+class Interner {
+private:
+  std::deque<std::string>                       _names;   // stable storage
+  std::unordered_map<std::string_view, Symbol>  _ids;
+
+public:
+  Interner() = default;
+  Interner(const Interner &) = delete;
+  Interner &operator=(const Interner &) = delete;
+
+  // get the id of name, create a new one if not found
+  Symbol Intern(std::string_view name) {
+    auto it = _ids.find(name);
+    if (it != _ids.end()) return it->second;
+    auto id = static_cast<Symbol>(_names.size());
+    const auto &str = _names.emplace_back(name);
+    _ids.insert({str, id});
+    return id;
+  }
+
+  // get the name of an interned id
+  std::string_view Name(Symbol id) const { return _names[id]; }
+
+  std::size_t size() const { return _names.size(); }
+
+  // global interner shared by front and middle end
+  static Interner &Global() {
+    static Interner interner;
+    return interner;
+  }
+};
+
+inline Symbol Intern(std::string_view name) {
+  return Interner::Global().Intern(name);
+}
+
+inline std::string_view SymbolName(Symbol id) {
+  return Interner::Global().Name(id);
+}
+
+}
+
+#endif //RJIT_INTERN_H
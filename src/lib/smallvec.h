@@ -0,0 +1,114 @@
+#ifndef RJIT_SMALLVEC_H
+#define RJIT_SMALLVEC_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+
+namespace RJIT::lib {
+
+/* SmallVector
+ * Vector with inline storage for the first N elements, heap memory is
+ * only used when it grows beyond N. Elements are relocated with their
+ * move constructor, so types that record their own address (like 'Use')
+ * stay consistent.
+ */
+template <typename T, std::size_t N>
+class SmallVector {
+private:
+  T           *_begin;
+  std::size_t  _size = 0;
+  std::size_t  _capacity = N;
+  alignas(T) unsigned char _inline[N * sizeof(T)];
+
+  bool IsInline() const {
+    return _begin == reinterpret_cast<const T *>(_inline);
+  }
+
+  // move all elements to a new buffer of 'capacity'
+  void Relocate(T *buffer, std::size_t capacity) {
+    for (std::size_t i = 0; i < _size; ++i) {
+      new (buffer + i) T(std::move(_begin[i]));
+      _begin[i].~T();
+    }
+    if (!IsInline()) ::operator delete(_begin);
+    _begin = buffer;
+    _capacity = capacity;
+  }
+
+  static T *NewBuffer(std::size_t capacity) {
+    return static_cast<T *>(::operator new(capacity * sizeof(T)));
+  }
+
+public:
+  using value_type     = T;
+  using iterator       = T *;
+  using const_iterator = const T *;
+
+  SmallVector() : _begin(reinterpret_cast<T *>(_inline)) {}
+
+  SmallVector(const SmallVector &rhs) : SmallVector() {
+    reserve(rhs.size());
+    for (const auto &it : rhs) emplace_back(it);
+  }
+
+  SmallVector &operator=(const SmallVector &) = delete;
+
+  ~SmallVector() {
+    clear();
+    if (!IsInline()) ::operator delete(_begin);
+  }
+
+  void reserve(std::size_t capacity) {
+    if (capacity > _capacity) Relocate(NewBuffer(capacity), capacity);
+  }
+
+  template <typename... Args>
+  T &emplace_back(Args &&... args) {
+    if (_size == _capacity) {
+      // construct new element first, 'args' may refer to an element
+      auto capacity = _capacity * 2;
+      auto buffer = NewBuffer(capacity);
+      new (buffer + _size) T(std::forward<Args>(args)...);
+      Relocate(buffer, capacity);
+    } else {
+      new (_begin + _size) T(std::forward<Args>(args)...);
+    }
+    return _begin[_size++];
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  void pop_back() { _begin[--_size].~T(); }
+
+  iterator erase(iterator first, iterator last) {
+    if (first == last) return first;
+    auto new_end = std::move(last, end(), first);
+    for (auto it = new_end; it != end(); ++it) it->~T();
+    _size = new_end - _begin;
+    return first;
+  }
+
+  void clear() { erase(begin(), end()); }
+
+  T       &operator[](std::size_t pos)       { return _begin[pos]; }
+  const T &operator[](std::size_t pos) const { return _begin[pos]; }
+
+  T       &back()       { return _begin[_size - 1]; }
+  const T &back() const { return _begin[_size - 1]; }
+
+  iterator       begin()       { return _begin;         }
+  iterator       end()         { return _begin + _size; }
+  const_iterator begin() const { return _begin;         }
+  const_iterator end()   const { return _begin + _size; }
+
+  std::size_t size()     const { return _size;      }
+  std::size_t capacity() const { return _capacity;  }
+  bool        empty()    const { return _size == 0; }
+};
+
+}
+
+#endif //RJIT_SMALLVEC_H
@@ -0,0 +1,140 @@
+#ifndef RJIT_THREADPOOL_H
+#define RJIT_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace RJIT::lib {
+
+/* ThreadPool
+ * Fixed number of workers with work stealing. 'ParallelFor' deals
+ * indices out to the queues of all workers, each worker takes tasks
+ * from the back of its own queue and steals from the front of others
+ * when it runs out. The calling thread works as worker 0, so a pool
+ * of N workers starts N - 1 threads.
+ */
+class ThreadPool {
+public:
+  // task function, receive index of task and id of worker
+  using Task = std::function<void(std::size_t, std::size_t)>;
+
+private:
+  struct Queue {
+    std::mutex              mutex;
+    std::deque<std::size_t> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread>            _threads;
+  std::mutex                          _mutex;
+  std::condition_variable             _start, _done;
+  const Task                         *_task = nullptr;
+  std::size_t                         _round = 0;     // id of current 'ParallelFor'
+  std::size_t                         _joined = 0;    // threads joined current round
+  std::size_t                         _busy = 0;      // threads still working
+  bool                                _stop = false;
+
+  std::optional<std::size_t> Pop(std::size_t worker) {
+    auto &own = *_queues[worker];
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        auto index = own.tasks.back();
+        own.tasks.pop_back();
+        return index;
+      }
+    }
+    for (std::size_t i = 1; i < _queues.size(); ++i) {
+      auto &victim = *_queues[(worker + i) % _queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        auto index = victim.tasks.front();
+        victim.tasks.pop_front();
+        return index;
+      }
+    }
+    return {};
+  }
+
+  // run tasks until all queues are empty
+  void Work(std::size_t worker, const Task &task) {
+    while (auto index = Pop(worker)) task(*index, worker);
+  }
+
+  void Loop(std::size_t worker) {
+    std::size_t round = 0;
+    for (;;) {
+      const Task *task;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _start.wait(lock, [&] { return _stop || _round != round; });
+        if (_stop) return;
+        round = _round;
+        task = _task;
+        ++_joined;
+        ++_busy;
+      }
+      Work(worker, *task);
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!--_busy && _joined == _threads.size()) _done.notify_all();
+    }
+  }
+
+public:
+  explicit ThreadPool(std::size_t workers) {
+    if (!workers) workers = 1;
+    for (std::size_t i = 0; i < workers; ++i) {
+      _queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 1; i < workers; ++i) {
+      _threads.emplace_back([this, i] { Loop(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _start.notify_all();
+    for (auto &it : _threads) it.join();
+  }
+
+  // run 'task' on indices [0, n), return after all tasks are finished
+  void ParallelFor(std::size_t n, const Task &task) {
+    if (!n) return;
+    for (std::size_t i = 0; i < n; ++i) {
+      auto &queue = *_queues[i % _queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(i);
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _task = &task;
+      _joined = 0;
+      ++_round;
+    }
+    _start.notify_all();
+
+    Work(0, task);
+    // wait for all threads, so that none of them can see 'task' later
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&] { return _joined == _threads.size() && !_busy; });
+  }
+
+  std::size_t size() const { return _queues.size(); }
+};
+
+}
+
+#endif //RJIT_THREADPOOL_H
@@ -8,7 +8,7 @@ using namespace RJIT::mid;
 namespace RJIT {
 template <typename SSA>
 auto CastTo(const SSAPtr &ssa) {
-  auto ptr = std::static_pointer_cast<SSA>(ssa);
+  auto ptr = static_cast<SSA *>(ssa);
   DBG_ASSERT(ptr != nullptr, "Cast SSA failed");
   return ptr;
 }
@@ -36,9 +36,11 @@ public:
   const std::string &value() const { return _str; }
 };
 
-SSAPtr GetZeroValue(TYPE::Type type);
+class Module;
 
-SSAPtr GetAllOneValue(TYPE::Type type);
+SSAPtr GetZeroValue(Module &M, TYPE::Type type);
+
+SSAPtr GetAllOneValue(Module &M, TYPE::Type type);
 
 }
 
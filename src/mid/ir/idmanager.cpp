@@ -14,6 +14,7 @@ void IdManager::Reset() {
   _loop_body_id     = 0;
   _while_end_id     = 0;
   _ids.clear();
+  _blocks.clear();
 }
 
 
@@ -41,7 +42,7 @@ std::size_t IdManager::GetId(const Value *value, IdType idType) {
   auto res = findValue(value, idType);
   if (res.has_value()) return res.value();
 
-  std::size_t id;
+  std::size_t id = 0;
 
   switch (idType) {
     case IdType::_ID_VAR: {
@@ -56,16 +57,12 @@ std::size_t IdManager::GetId(const Value *value, IdType idType) {
     case IdType::_ID_IF_END:     id = _if_end_id++;     break;
     case IdType::_ID_WHILE_COND: id = _while_cond_id++; break;
     case IdType::_ID_LOOP_BODY:  id = _loop_body_id++;  break;
-    case IdType::_ID_WHILE_END:  id = _while_end_id;    break;
+    case IdType::_ID_WHILE_END:  id = _while_end_id++;  break;
   }
   _blocks.insert({value, id});
   return id;
 }
 
-std::size_t IdManager::GetId(const SSAPtr &value, IdType idType) {
-   return GetId(value.get(), idType);
-}
-
 void IdManager::RecordName(const Value *value, std::string_view name) {
   if (_names.find(value) == _names.end()) {
     _names.insert({value, name});
@@ -46,14 +46,12 @@ public:
 
   // get id for local vale
   std::size_t GetId(const Value *value, IdType idType = IdType::_ID_VAR);
-  std::size_t GetId(const SSAPtr &value, IdType idType = IdType::_ID_VAR);
 
   // record global values(variables and functions)
   void RecordName(const Value *value, std::string_view name);
 
   // get name of global values
   std::optional<std::string_view> GetName(const Value *value);
-  std::optional<std::string_view> GetName(const SSAPtr &value) { return GetName(value.get()); }
 };
 
 }
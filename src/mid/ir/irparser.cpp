@@ -0,0 +1,550 @@
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "mid/ir/irparser.h"
+#include "mid/ir/constant.h"
+
+namespace RJIT::mid {
+
+namespace {
+
+using TYPE::TypeInfoPtr;
+
+// names of blocks that are dumped with an id suffix, see 'DumpBlockName'
+constexpr std::string_view kNumberedBlocks[] = {
+  "if_cond", "if.then", "if.else", "if.end",
+  "while.cond", "loop.body", "while.end", "block",
+};
+
+bool IsWordChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+}
+
+bool IsNumber(std::string_view str) {
+  if (str.empty()) return false;
+  for (const auto &c : str) {
+    if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+  }
+  return true;
+}
+
+// get block name from label, the id suffix is added again when dumped
+std::string BlockName(std::string_view label) {
+  for (const auto &it : kNumberedBlocks) {
+    if (label.find(it) == std::string_view::npos) continue;
+    auto end = label.size();
+    while (end && std::isdigit(static_cast<unsigned char>(label[end - 1]))) --end;
+    return std::string(label.substr(0, end));
+  }
+  return std::string(label);
+}
+
+/* IRParser
+ * Line based parser of textual IR. All functions are declared first,
+ * so that calls can refer to functions defined later. Operands that
+ * refer to values defined later are resolved at the end of function.
+ */
+class IRParser {
+private:
+  // parsed operand, 'name' is set if value is not defined yet
+  struct Operand {
+    SSAPtr           value = nullptr;
+    std::string      name;
+    front::SourceLoc loc;
+  };
+
+  // operand to be resolved at the end of function
+  struct Fixup {
+    User    *user;
+    unsigned index;
+    Operand  operand;
+  };
+
+  Module                                    &_module;
+  uint16_t                                   _file_id;
+  std::vector<std::string>                   _lines;
+  std::size_t                                _line_no = 0;
+  std::string_view                           _line;      // rest of current line
+
+  // state of current function
+  Function                                  *_func = nullptr;
+  BlockPtr                                   _block = nullptr;
+  std::unordered_map<std::string, SSAPtr>    _values;
+  std::unordered_map<std::string, BlockPtr>  _blocks;
+  std::vector<BlockPtr>                      _block_order;
+  std::unordered_set<BlockPtr>               _defined;
+  std::vector<Fixup>                         _fixups;
+
+  front::SourceLoc Loc() const {
+    auto col = _lines[_line_no].size() - _line.size() + 1;
+    return front::SourceLoc(_file_id, static_cast<int>(_line_no + 1),
+                            static_cast<int>(col));
+  }
+
+  bool Error(const std::string &msg) const { return Error(Loc(), msg); }
+
+  bool Error(const front::SourceLoc &loc, const std::string &msg) const {
+    front::Logger(loc).LogError(msg);
+    return false;
+  }
+
+  void SkipSpace() {
+    while (!_line.empty() && std::isspace(static_cast<unsigned char>(_line[0]))) {
+      _line.remove_prefix(1);
+    }
+  }
+
+  bool AtEnd() {
+    SkipSpace();
+    return _line.empty();
+  }
+
+  bool Eat(char c) {
+    SkipSpace();
+    if (_line.empty() || _line[0] != c) return false;
+    _line.remove_prefix(1);
+    return true;
+  }
+
+  bool Expect(char c) {
+    return Eat(c) || Error(std::string("expected '") + c + "'");
+  }
+
+  std::string_view ReadWord() {
+    SkipSpace();
+    std::size_t len = 0;
+    while (len < _line.size() && IsWordChar(_line[len])) ++len;
+    auto word = _line.substr(0, len);
+    _line.remove_prefix(len);
+    return word;
+  }
+
+  bool EatWord(std::string_view word) {
+    auto line = _line;
+    if (ReadWord() == word) return true;
+    _line = line;
+    return false;
+  }
+
+  bool ExpectWord(std::string_view word) {
+    return EatWord(word) || Error("expected '" + std::string(word) + "'");
+  }
+
+  // read '%name' or '@name'
+  bool ReadName(char sigil, std::string &name) {
+    if (!Eat(sigil)) return Error(std::string("expected '") + sigil + "'");
+    name = ReadWord();
+    return !name.empty() || Error("expected name");
+  }
+
+  bool ParseType(TypeInfoPtr &type);
+  BlockPtr GetBlock(const std::string &label);
+  bool ParseValue(const TypeInfoPtr &type, Operand &operand);
+  bool ParseTypedValue(Operand &operand);
+  bool ParseLabel(Operand &operand);
+  void SetOperands(User *user, const std::vector<Operand> &operands);
+  bool DefineValue(const std::string &name, SSAPtr value);
+
+  bool DeclareFunction();
+  bool ParseBlockHeader(bool &is_header);
+  bool ParseInst();
+  bool FinishFunction();
+
+public:
+  IRParser(Module &M, uint16_t file_id, std::vector<std::string> lines)
+      : _module(M), _file_id(file_id), _lines(std::move(lines)) {}
+
+  bool Parse();
+};
+
+bool IRParser::ParseType(TypeInfoPtr &type) {
+  using TYPE::Type;
+  auto word = ReadWord();
+  if (word == "void") {
+    type = TYPE::MakeVoid();
+  } else if (word == "i1") {
+    type = TYPE::MakePrimType(Type::Bool, true);
+  } else if (word == "i8") {
+    type = TYPE::MakePrimType(Type::Int8, true);
+  } else if (word == "i32") {
+    type = TYPE::MakePrimType(Type::Int32, true);
+  } else {
+    return Error("unknown type '" + std::string(word) + "'");
+  }
+  while (Eat('*')) type = TYPE::MakePointerType(type);
+  return true;
+}
+
+BlockPtr IRParser::GetBlock(const std::string &label) {
+  auto &block = _blocks[label];
+  if (!block) {
+    block = _module.New<BasicBlock>(_func, BlockName(label));
+    block->set_type(nullptr);
+  }
+  return block;
+}
+
+bool IRParser::ParseValue(const TypeInfoPtr &type, Operand &operand) {
+  SkipSpace();
+  operand.loc = Loc();
+  if (!_line.empty() && _line[0] == '%') {
+    std::string name;
+    if (!ReadName('%', name)) return false;
+    auto it = _values.find(name);
+    if (it != _values.end()) {
+      operand.value = it->second;
+    } else {
+      operand.name = name;
+    }
+    return true;
+  }
+
+  // integer constant, negative values are stored as unsigned
+  bool neg = Eat('-');
+  auto word = ReadWord();
+  if (!IsNumber(word)) return Error("expected value");
+  auto num = std::strtoull(std::string(word).c_str(), nullptr, 10);
+  if (word.size() > 10 || num > UINT32_MAX) return Error(operand.loc, "integer is too large");
+  auto value = static_cast<unsigned int>(num);
+  auto cint = _module.New<ConstantInt>(neg ? 0u - value : value);
+  cint->set_type(TYPE::MakeConst(type));
+  cint->set_loc(operand.loc);
+  operand.value = cint;
+  return true;
+}
+
+bool IRParser::ParseTypedValue(Operand &operand) {
+  TypeInfoPtr type;
+  return ParseType(type) && ParseValue(type, operand);
+}
+
+bool IRParser::ParseLabel(Operand &operand) {
+  std::string label;
+  if (!ExpectWord("label") || !ReadName('%', label)) return false;
+  operand.value = GetBlock(label);
+  return true;
+}
+
+void IRParser::SetOperands(User *user, const std::vector<Operand> &operands) {
+  for (unsigned i = 0; i < operands.size(); ++i) {
+    if (operands[i].value) {
+      (*user)[i].set(operands[i].value);
+    } else {
+      _fixups.push_back({user, i, operands[i]});
+    }
+  }
+}
+
+bool IRParser::DefineValue(const std::string &name, SSAPtr value) {
+  if (!_values.emplace(name, value).second) {
+    return Error("redefinition of value '%" + name + "'");
+  }
+  return true;
+}
+
+bool IRParser::DeclareFunction() {
+  // define <type> @name(<type> %arg, ...) {
+  TypeInfoPtr ret;
+  std::string name;
+  auto loc = Loc();
+  if (!ExpectWord("define") || !ParseType(ret) || !ReadName('@', name) ||
+      !Expect('(')) {
+    return false;
+  }
+  TYPE::TypePtrList arg_types;
+  std::vector<std::string> arg_names;
+  if (!Eat(')')) {
+    do {
+      TypeInfoPtr type;
+      std::string arg_name;
+      if (!ParseType(type) || !ReadName('%', arg_name)) return false;
+      arg_types.push_back(type);
+      arg_names.push_back(arg_name);
+    } while (Eat(','));
+    if (!Expect(')')) return false;
+  }
+  if (!Expect('{') || !AtEnd()) return Error("expected end of line");
+  if (_module.GetFunction(name)) return Error(loc, "redefinition of function '" + name + "'");
+
+  auto func = _module.New<Function>(name);
+  func->set_type(TYPE::MakeFuncType(arg_types, ret, true));
+  func->set_loc(loc);
+  for (std::size_t i = 0; i < arg_names.size(); ++i) {
+    auto arg = _module.New<ArgRefSSA>(func, i, arg_names[i]);
+    arg->set_type(arg_types[i]);
+    arg->set_loc(loc);
+    func->set_arg(i, arg);
+  }
+  _module.AddFunction(func);
+  return true;
+}
+
+bool IRParser::ParseBlockHeader(bool &is_header) {
+  // <label>: ; preds: <label>, ...
+  auto line = _line;
+  Eat('%');
+  std::string label(ReadWord());
+  if (label.empty() || !Eat(':')) {
+    _line = line;
+    is_header = false;
+    return true;
+  }
+  is_header = true;
+
+  auto block = GetBlock(label);
+  if (!_defined.insert(block).second) {
+    return Error("redefinition of block '" + label + "'");
+  }
+  block->set_loc(Loc());
+  _block_order.push_back(block);
+  _block = block;
+
+  if (Eat(';')) {
+    if (!ExpectWord("preds") || !Expect(':')) return false;
+    do {
+      Eat('%');
+      std::string pred(ReadWord());
+      if (pred.empty()) return Error("expected label");
+      block->AddValue(GetBlock(pred));
+    } while (Eat(','));
+  }
+  return AtEnd() || Error("expected end of line");
+}
+
+bool IRParser::ParseInst() {
+  using TYPE::Type;
+  if (!_block) return Error("instruction is outside of block");
+  auto loc = Loc();
+
+  // get name of result
+  std::string name;
+  if (!_line.empty() && _line[0] == '%') {
+    if (!ReadName('%', name) || !Expect('=')) return false;
+  }
+
+  auto opname = ReadWord();
+  Instruction *inst = nullptr;
+  TypeInfoPtr type;
+  std::vector<Operand> operands;
+
+  if (opname == "alloca") {
+    if (!ParseType(type)) return false;
+    inst = _module.New<AllocaInst>(IsNumber(name) ? "" : name);
+    type = TYPE::MakePointerType(type);
+  } else if (opname == "load") {
+    // load <type>, <type>* <ptr>
+    operands.resize(1);
+    if (!ParseType(type) || !Expect(',') || !ParseTypedValue(operands[0])) return false;
+    inst = _module.New<LoadInst>(nullptr);
+  } else if (opname == "store") {
+    // store <type> <value>, <type>* <ptr>
+    operands.resize(2);
+    if (!ParseTypedValue(operands[0]) || !Expect(',') ||
+        !ParseTypedValue(operands[1])) {
+      return false;
+    }
+    inst = _module.New<StoreInst>(nullptr, nullptr);
+  } else if (opname == "icmp") {
+    // icmp <pred> <type> <lhs>, <rhs>
+    static const std::unordered_map<std::string_view, AST::Operator> preds = {
+      {"eq",  AST::Operator::Equal},   {"ne",  AST::Operator::NotEqual},
+      {"slt", AST::Operator::SLess},   {"ult", AST::Operator::ULess},
+      {"sle", AST::Operator::SLessEq}, {"ule", AST::Operator::ULessEq},
+      {"sgt", AST::Operator::SGreat},  {"ugt", AST::Operator::UGreat},
+      {"sge", AST::Operator::SGreatEq},{"uge", AST::Operator::UGreatEq},
+    };
+    auto pred = preds.find(ReadWord());
+    if (pred == preds.end()) return Error("unknown compare predicate");
+    TypeInfoPtr op_type;
+    operands.resize(2);
+    if (!ParseType(op_type) || !ParseValue(op_type, operands[0]) ||
+        !Expect(',') || !ParseValue(op_type, operands[1])) {
+      return false;
+    }
+    inst = _module.New<ICmpInst>(pred->second, nullptr, nullptr);
+    type = TYPE::MakePrimType(Type::Bool, true);
+  } else if (opname == "call") {
+    // call <type> @func(<type> <arg>, ...)
+    std::string callee_name;
+    if (!ParseType(type) || !ReadName('@', callee_name) || !Expect('(')) return false;
+    auto callee = _module.GetFunction(callee_name);
+    if (!callee) return Error("undefined function '" + callee_name + "'");
+    operands.resize(1);
+    operands[0].value = callee;
+    if (!Eat(')')) {
+      do {
+        operands.emplace_back();
+        if (!ParseTypedValue(operands.back())) return false;
+      } while (Eat(','));
+      if (!Expect(')')) return false;
+    }
+    inst = _module.New<CallInst>(nullptr, std::vector<SSAPtr>(operands.size() - 1));
+  } else if (opname == "phi") {
+    // phi <type> [ <value>, %<block> ], ...
+    if (!ParseType(type)) return false;
+    do {
+      Operand value, block;
+      std::string label;
+      if (!Expect('[') || !ParseValue(type, value) || !Expect(',') ||
+          !ReadName('%', label) || !Expect(']')) {
+        return false;
+      }
+      block.value = GetBlock(label);
+      operands.push_back(value);
+      operands.push_back(block);
+    } while (Eat(','));
+    auto phi = _module.New<PHINode>();
+    for (std::size_t i = 0; i < operands.size(); i += 2) phi->AddIncoming(nullptr, nullptr);
+    inst = phi;
+  } else if (opname == "br") {
+    // br label <dest> or br i1 <cond>, label <true>, label <false>
+    auto line = _line;
+    if (ReadWord() == "label") {
+      _line = line;
+      operands.resize(1);
+      if (!ParseLabel(operands[0])) return false;
+      inst = _module.New<JumpInst>(nullptr);
+    } else {
+      _line = line;
+      operands.resize(3);
+      if (!ParseTypedValue(operands[0]) || !Expect(',') ||
+          !ParseLabel(operands[1]) || !Expect(',') || !ParseLabel(operands[2])) {
+        return false;
+      }
+      inst = _module.New<BranchInst>(nullptr, nullptr, nullptr);
+    }
+  } else if (opname == "ret") {
+    // ret void or ret <type> <value>
+    operands.resize(1);
+    if (!EatWord("void") && !ParseTypedValue(operands[0])) return false;
+    inst = _module.New<ReturnInst>(nullptr);
+  } else {
+    // binary operator: <op> <type> <lhs>, <rhs>
+    unsigned opcode = Instruction::BinaryOpsBegin;
+    while (opcode < Instruction::BinaryOpsEnd &&
+           Instruction::GetOpcodeAsString(opcode) != opname) {
+      ++opcode;
+    }
+    if (opcode == Instruction::BinaryOpsEnd) {
+      return Error(loc, "unknown instruction '" + std::string(opname) + "'");
+    }
+    operands.resize(2);
+    if (!ParseType(type) || !ParseValue(type, operands[0]) || !Expect(',') ||
+        !ParseValue(type, operands[1])) {
+      return false;
+    }
+    auto binary = static_cast<Instruction::BinaryOps>(opcode);
+    inst = _module.New<BinaryOperator>(binary, nullptr, nullptr, type);
+  }
+  if (!AtEnd()) return Error("expected end of line");
+
+  // instructions without result have no type
+  bool has_result = type != nullptr;
+  if (has_result != !name.empty() && opname != "call") {
+    return Error(loc, has_result ? "result of instruction is not named"
+                                 : "instruction has no result");
+  }
+  inst->set_type(type);
+  inst->set_loc(loc);
+  SetOperands(inst, operands);
+  _block->AddInstToEnd(inst);
+  return name.empty() || DefineValue(name, inst);
+}
+
+bool IRParser::FinishFunction() {
+  for (const auto &it : _fixups) {
+    auto value = _values.find(it.operand.name);
+    if (value == _values.end()) {
+      return Error(it.operand.loc, "undefined value '%" + it.operand.name + "'");
+    }
+    (*it.user)[it.index].set(value->second);
+  }
+  for (const auto &[label, block] : _blocks) {
+    if (!_defined.count(block)) {
+      return Error(_func->loc(), "undefined block '" + label + "'");
+    }
+  }
+
+  // exit block is dumped last, but it is the second block of function
+  auto &order = _block_order;
+  for (std::size_t i = 2; i < order.size(); ++i) {
+    if (order[i]->name() != "func_exit") continue;
+    auto exit = order[i];
+    order.erase(order.begin() + i);
+    order.insert(order.begin() + 1, exit);
+    break;
+  }
+  for (const auto &it : order) _func->AddValue(it);
+
+  _func = nullptr;
+  _block = nullptr;
+  _values.clear();
+  _blocks.clear();
+  _block_order.clear();
+  _defined.clear();
+  _fixups.clear();
+  return true;
+}
+
+bool IRParser::Parse() {
+  // declare all functions first
+  std::vector<std::size_t> defines;
+  for (_line_no = 0; _line_no < _lines.size(); ++_line_no) {
+    _line = _lines[_line_no];
+    auto line = _line;
+    if (ReadWord() != "define") continue;
+    _line = line;
+    defines.push_back(_line_no);
+    if (!DeclareFunction()) return false;
+  }
+
+  // parse bodies
+  std::size_t func_index = 0;
+  for (_line_no = 0; _line_no < _lines.size(); ++_line_no) {
+    _line = _lines[_line_no];
+    if (AtEnd() || _line[0] == ';') continue;
+
+    if (!_func) {
+      if (func_index >= defines.size() || defines[func_index] != _line_no) {
+        return Error("expected 'define'");
+      }
+      _func = _module.Functions()[func_index++];
+      for (const auto &arg : _func->args()) {
+        auto arg_name = static_cast<ArgRefSSA *>(arg)->arg_name();
+        if (!DefineValue(arg_name, arg)) return false;
+      }
+      continue;
+    }
+
+    if (Eat('}')) {
+      if (!AtEnd()) return Error("expected end of line");
+      if (!FinishFunction()) return false;
+      continue;
+    }
+    bool is_header;
+    if (!ParseBlockHeader(is_header)) return false;
+    if (!is_header && !ParseInst()) return false;
+  }
+  return !_func || Error("expected '}'");
+}
+
+}
+
+bool ParseIR(const std::string &file, Module &M) {
+  std::ifstream ifs(file);
+  auto file_id = front::SourceManager::get().addFile(file);
+  if (!ifs) {
+    front::Logger(front::SourceLoc(file_id, 0, 0)).LogError("can not open file");
+    return false;
+  }
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(ifs, line);) lines.push_back(std::move(line));
+  IRParser parser(M, file_id, std::move(lines));
+  return parser.Parse();
+}
+
+}
@@ -0,0 +1,33 @@
+#ifndef RJIT_IRPARSER_H
+#define RJIT_IRPARSER_H
+
+#include <string>
+
+#include "mid/ir/module.h"
+
+namespace RJIT::mid {
+
+/* Textual IR
+ * 'ParseIR' reads the syntax written by 'Module::Dump':
+ *   define i32 @f(i32 %x) {
+ *   entry:
+ *     %x.addr = alloca i32
+ *     store i32 %x, i32* %x.addr
+ *     br label %block0
+ *
+ *   block0: ; preds: entry
+ *     %0 = load i32, i32* %x.addr
+ *     ret i32 %0
+ *   }
+ * Blocks are listed in their predecessors by '; preds:', values and
+ * blocks can be used before they are defined. Types only keep their
+ * width in text, so 'i8' and 'i32' are read as signed integers.
+ */
+
+// parse textual IR file into empty module 'M', errors are reported by
+// 'Logger', return false if failed
+bool ParseIR(const std::string &file, Module &M);
+
+}
+
+#endif //RJIT_IRPARSER_H
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <memory>
 #include "module.h"
 #include "constant.h"
@@ -9,6 +10,28 @@ void Module::reset() {
   _global_vars.clear();
   _value_symtab.reset();
   _functions.clear();
+  _func_symtab.clear();
+}
+
+Module::~Module() {
+  // break all use-def links first, so that values can be destroyed
+  // in any order when releasing the arenas
+  for (const auto &[_, it] : _arenas) {
+    for (const auto &user : it->users) user->DropAllReferences();
+  }
+  _value_symtab.reset();
+}
+
+std::uint64_t Module::NewId() {
+  static std::atomic<std::uint64_t> next_id = 1;
+  return next_id++;
+}
+
+Module::ThreadArena &Module::CreateArena() {
+  std::lock_guard<std::mutex> lock(_arenas_mutex);
+  auto &arena = _arenas[std::this_thread::get_id()];
+  if (!arena) arena = std::make_unique<ThreadArena>();
+  return *arena;
 }
 
 Guard Module::NewEnv() {
@@ -18,6 +41,7 @@ Guard Module::NewEnv() {
 
 void Module::Dump(std::ostream &os) {
   IdManager id_mgr;
+  if (!MaterializeAll()) return;
 
   // dump global value
   for (const auto &it : _global_vars) {
@@ -30,13 +54,9 @@ void Module::Dump(std::ostream &os) {
   }
 }
 
-Guard Module::SetContext(const front::Logger &logger) {
-  return SetContext(std::make_shared<front::Logger>(logger));
-}
-
-Guard Module::SetContext(const front::LoggerPtr &logger) {
-  _loggers.push(logger);
-  return Guard([this] { _loggers.pop(); });
+Guard Module::SetContext(const front::SourceLoc &loc) {
+  _locs.push(loc);
+  return Guard([this] { _locs.pop(); });
 }
 
 FuncPtr Module::CreateFunction(const std::string &name, const TYPE::TypeInfoPtr &type) {
@@ -44,20 +64,40 @@ FuncPtr Module::CreateFunction(const std::string &name, const TYPE::TypeInfoPtr
   auto func = MakeSSA<Function>(name);
   func->set_type(type);
   _functions.push_back(func);
+  _func_symtab[lib::Intern(name)] = func;
   return func;
 }
 
-FuncPtr Module::GetFunction(const std::string &func_name) {
+void Module::AddFunction(const FuncPtr &func) {
+  _functions.push_back(func);
+  _func_symtab[lib::Intern(func->GetFunctionName())] = func;
+}
+
+bool Module::Materialize(const FuncPtr &F) {
+  if (!F->IsMaterializable()) return true;
+  DBG_ASSERT(_materializer != nullptr, "no materializer in module");
+  if (!_materializer->Materialize(F)) return false;
+  F->set_materializable(false);
+  return true;
+}
+
+bool Module::MaterializeAll() {
   for (const auto &it : _functions) {
-    it->GetFunctionName();
-    if (it->GetFunctionName() == func_name) {
-      return it;
-    }
+    if (!Materialize(it)) return false;
   }
-  return nullptr;
+  return true;
+}
+
+FuncPtr Module::GetFunction(lib::Symbol func_name) {
+  auto it = _func_symtab.find(func_name);
+  return it != _func_symtab.end() ? it->second : nullptr;
 }
 
-SSAPtr Module::GetValues(const std::string &var_name) {
+FuncPtr Module::GetFunction(std::string_view func_name) {
+  return GetFunction(lib::Intern(func_name));
+}
+
+SSAPtr Module::GetValues(lib::Symbol var_name) {
   return _value_symtab->GetItem(var_name);
 }
 
@@ -125,7 +165,7 @@ SSAPtr Module::CreateArgRef(const SSAPtr &func, std::size_t index, const std::st
   arg_ref->set_type(args_type[index]);
 
   // update function
-  std::dynamic_pointer_cast<Function>(func)->set_arg(index, arg_ref);
+  static_cast<Function *>(func)->set_arg(index, arg_ref);
   return arg_ref;
 }
 
@@ -217,16 +257,20 @@ static unsigned OpToOpcode(AST::Operator op) {
   return OtherOps::Undef;
 }
 
-// S1 = S2;
-SSAPtr Module::CreateAssign(const SSAPtr &S1, const SSAPtr &S2) {
-  std::shared_ptr<Instruction> inst;
-
+// values that can be used directly, others are variables and must be loaded
+// first (result of assignment is a load or an rvalue, e.g. 'a = b = 3')
+static bool IsRightValue(const SSAPtr &S) {
+  return S->type()->IsConst() || IsBinaryOperator(S) || IsCallInst(S) ||
+         IsLoadInst(S);
+}
 
-  if (S2->type()->IsConst() || IsBinaryOperator(S2) || IsCallInst(S2)) {
+// S1 = S2; returns the stored value
+SSAPtr Module::CreateAssign(const SSAPtr &S1, const SSAPtr &S2) {
+  if (IsRightValue(S2)) {
     // S1 = C ---> store C, s1
     auto store_inst = AddInst<StoreInst>(S2, S1);
     DBG_ASSERT(store_inst != nullptr, "emit store inst failed");
-    return store_inst;
+    return S2;
   } else {
     // S1 = S2 ---> %0 = load s2; store %0, i32* s1
     auto load_inst = CreateLoad(S2);
@@ -234,7 +278,7 @@ SSAPtr Module::CreateAssign(const SSAPtr &S1, const SSAPtr &S2) {
     // TODO: add necessary cast here
     auto store_inst = AddInst<StoreInst>(load_inst, S1);
     DBG_ASSERT(store_inst != nullptr, "emit store inst failed");
-    return store_inst;
+    return load_inst;
   }
 }
 
@@ -243,17 +287,17 @@ SSAPtr Module::CreatePureBinaryInst(Instruction::BinaryOps opcode,
   DBG_ASSERT(opcode >= Instruction::BinaryOps::Add, "opcode is not pure binary operator");
   SSAPtr load_s1 = nullptr;
   SSAPtr load_s2 = nullptr;
-  if (!S1->type()->IsConst() && !IsBinaryOperator(S1) && !IsCallInst(S1)) {
+  if (!IsRightValue(S1)) {
     load_s1 = CreateLoad(S1);
     DBG_ASSERT(load_s1 != nullptr, "emit load S1 failed");
   }
 
-  if (!S2->type()->IsConst() && !IsBinaryOperator(S2) && !IsCallInst(S2)) {
+  if (!IsRightValue(S2)) {
     load_s2 = CreateLoad(S2);
-    DBG_ASSERT(load_s1 != nullptr, "emit load S2 failed");
+    DBG_ASSERT(load_s2 != nullptr, "emit load S2 failed");
   }
 
-  auto bin_inst = BinaryOperator::Create(opcode,
+  auto bin_inst = BinaryOperator::Create(*this, opcode,
                                          ((load_s1 != nullptr) ? load_s1 : S1),
                                          ((load_s2 != nullptr) ? load_s2 : S2));
 
@@ -308,7 +352,7 @@ SSAPtr Module::CreateCallInst(const SSAPtr &callee, const std::vector<SSAPtr>& a
   std::vector<SSAPtr> new_args;
   for (const auto &it : args) {
 
-    if (it->type()->IsConst() || IsBinaryOperator(it) || IsCallInst(it)) {
+    if (IsRightValue(it)) {
       new_args.push_back(it);
     } else {
       auto load_inst = CreateLoad(it);
@@ -327,34 +371,9 @@ SSAPtr Module::CreateICmpInst(AST::Operator opcode, const SSAPtr &lhs, const SSA
   DBG_ASSERT(lhs != nullptr, "lhs SSA is null ptr");
   DBG_ASSERT(rhs != nullptr, "rhs SSA is null ptr");
 
-  SSAPtr icmp_inst, lhs_ssa, rhs_ssa;
-  bool is_lhs_bin = false, is_rhs_bin = false;
-
-  if (lhs->isInstruction()) {
-    auto lhs_inst = std::static_pointer_cast<Instruction>(lhs);
-    if (lhs_inst->isBinaryOp()) {
-      is_lhs_bin = true;
-    }
-  }
-
-  if (rhs->isInstruction()) {
-    auto rhs_inst = std::static_pointer_cast<Instruction>(rhs);
-    if (rhs_inst->isBinaryOp()) {
-      is_rhs_bin = true;
-    }
-  }
-
-  if (lhs->type()->IsConst() || is_lhs_bin) {
-    lhs_ssa = lhs;
-  } else {
-    lhs_ssa = CreateLoad(lhs);
-  }
-
-  if (rhs->type()->IsConst() || is_rhs_bin) {
-    rhs_ssa = rhs;
-  } else {
-    rhs_ssa = CreateLoad(rhs);
-  }
+  SSAPtr icmp_inst;
+  auto lhs_ssa = IsRightValue(lhs) ? lhs : CreateLoad(lhs);
+  auto rhs_ssa = IsRightValue(rhs) ? rhs : CreateLoad(rhs);
 
   icmp_inst = AddInst<ICmpInst>(opcode, lhs_ssa, rhs_ssa);
   DBG_ASSERT(icmp_inst != nullptr, "emit ICmp instruction failed");
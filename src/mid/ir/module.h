@@ -1,12 +1,19 @@
 #ifndef RJIT_MODULE_H
 #define RJIT_MODULE_H
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <stack>
+#include <thread>
+#include <unordered_map>
 
 #include "ssa.h"
 #include "lib/debug.h"
 #include "lib/guard.h"
 #include "lib/nestedmap.h"
+#include "lib/intern.h"
+#include "lib/arena.h"
 #include "define/AST.h"
 #include "define/type.h"
 
@@ -14,7 +21,20 @@ namespace RJIT::mid {
 
 using UserList     = std::vector<UserPtr>;
 using FunctionList = std::vector<FuncPtr>;
-using ValueEnvPtr  = lib::Nested::NestedMapPtr<std::string, SSAPtr>;
+using ValueEnvPtr  = lib::Nested::NestedMapPtr<lib::Symbol, SSAPtr>;
+using FunctionMap  = std::unordered_map<lib::Symbol, FuncPtr>;
+
+/* Materializer
+ * Load bodies of functions that are declared in a module but not
+ * loaded yet, e.g. functions of a module read from a binary IR file.
+ */
+class Materializer {
+public:
+  virtual ~Materializer() = default;
+
+  // load body of 'F', return false if failed
+  virtual bool Materialize(Function *F) = 0;
+};
 
 /* Module
  * Contain all information about program.
@@ -22,23 +42,53 @@ using ValueEnvPtr  = lib::Nested::NestedMapPtr<std::string, SSAPtr>;
  */
 class Module {
 private:
-  SSAPtr                       _return_val;
+  // IR objects are owned by the arena of thread that creates them, so
+  // that function passes running in parallel allocate without locking
+  struct ThreadArena {
+    lib::Arena arena;
+    UserList   users;     // all users in arena
+  };
+  using ThreadArenaMap = std::unordered_map<std::thread::id, std::unique_ptr<ThreadArena>>;
+
+  const std::uint64_t          _id;       // unique id, never reused
+  ThreadArenaMap               _arenas;
+  std::mutex                   _arenas_mutex;
+  SSAPtr                       _return_val = nullptr;
   UserList                     _global_vars;
-  BlockPtr                     _func_entry;
-  BlockPtr                     _func_exit;
-  BlockPtr                     _insert_point;
+  BlockPtr                     _func_entry = nullptr;
+  BlockPtr                     _func_exit = nullptr;
+  BlockPtr                     _insert_point = nullptr;
   ValueEnvPtr                  _value_symtab;
   FunctionList                 _functions;
-  SSAPtrList::iterator         _insert_pos;
-  std::stack<front::LoggerPtr> _loggers;
+  FunctionMap                  _func_symtab;
+  InstList::iterator           _insert_pos;
+  std::stack<front::SourceLoc> _locs;
+  std::unique_ptr<Materializer> _materializer;
+
+  static std::uint64_t NewId();
+
+  // get arena of current thread, only locks when a thread allocates in
+  // a module for the first time
+  ThreadArena &LocalArena() {
+    thread_local std::uint64_t cached_id = 0;
+    thread_local ThreadArena *cached = nullptr;
+    if (cached_id != _id) {
+      cached = &CreateArena();
+      cached_id = _id;
+    }
+    return *cached;
+  }
+
+  // get or create arena of current thread
+  ThreadArena &CreateArena();
 
-  // create a new SSA with current context (logger)
+  // create a new SSA with current context (source location)
   template <typename T, typename... Args>
   auto MakeSSA(Args &&... args) {
     static_assert(std::is_base_of_v<Value, T>);
-    auto ssa = std::make_shared<T>(std::forward<Args>(args)...);
+    auto ssa = New<T>(std::forward<Args>(args)...);
     ssa->SetParent(_insert_point);
-    ssa->set_logger(_loggers.top());
+    ssa->set_loc(_locs.top());
     return ssa;
   }
 
@@ -51,7 +101,22 @@ private:
   }
 
 public:
-  Module() { reset(); }
+  Module() : _id(NewId()) { reset(); }
+
+  Module(const Module &) = delete;
+  Module &operator=(const Module &) = delete;
+
+  ~Module();
+
+  // allocate a new IR object in module
+  template <typename T, typename... Args>
+  T *New(Args &&... args) {
+    static_assert(std::is_base_of_v<Value, T>);
+    auto &local = LocalArena();
+    auto ssa = local.arena.New<T>(std::forward<Args>(args)...);
+    if constexpr (std::is_base_of_v<User, T>) local.users.push_back(ssa);
+    return ssa;
+  }
 
   void reset();
 
@@ -93,15 +158,28 @@ public:
 
   SSAPtr   CreateICmpInst(AST::Operator opcode, const SSAPtr &lhs, const SSAPtr &rhs);
 
-  FuncPtr GetFunction(const std::string &func_name);
+  // add a function that is created outside of IR builder
+  void     AddFunction(const FuncPtr &func);
+
+  // load body of 'F' if it is not loaded yet, return false if failed
+  bool     Materialize(const FuncPtr &F);
+
+  // load bodies of all functions
+  bool     MaterializeAll();
+
+  void     SetMaterializer(std::unique_ptr<Materializer> materializer) {
+    _materializer = std::move(materializer);
+  }
+
+  FuncPtr  GetFunction(lib::Symbol func_name);
+
+  FuncPtr  GetFunction(std::string_view func_name);
 
-  SSAPtr   GetValues(const std::string &var_name);
+  SSAPtr   GetValues(lib::Symbol var_name);
 
   // setters
-  // set current context (logger)
-  Guard SetContext(const front::Logger &logger);
-  // set current context (pointer to logger)
-  Guard SetContext(const front::LoggerPtr &logger);
+  // set current context (source location)
+  Guard SetContext(const front::SourceLoc &loc);
   void SetRetValue   (const SSAPtr  &val)  { _return_val = val;  }
   void SetFuncEntry  (const BlockPtr &BB)  { _func_entry = BB;   }
   void SetFuncExit   (const BlockPtr &BB)  { _func_exit = BB;    }
@@ -110,7 +188,7 @@ public:
     SetInsertPoint(BB, BB->insts().end());
   }
 
-  void SetInsertPoint(const BlockPtr &BB, SSAPtrList::iterator it) {
+  void SetInsertPoint(const BlockPtr &BB, InstList::iterator it) {
     _insert_point = BB;
     _insert_pos = it;
   }
@@ -123,7 +201,7 @@ public:
   BlockPtr             &InsertPoint() { return _insert_point; }
   BlockPtr             &FuncEntry()   { return _func_entry;   }
   BlockPtr             &FuncExit()    { return _func_exit;    }
-  SSAPtrList::iterator  InsertPos()   { return _insert_pos;   }
+  InstList::iterator    InsertPos()   { return _insert_pos;   }
 
   typedef FunctionList::iterator        iterator;
   typedef FunctionList::const_iterator  const_iterator;
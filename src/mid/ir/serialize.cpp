@@ -0,0 +1,732 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "mid/ir/serialize.h"
+#include "mid/ir/constant.h"
+
+namespace RJIT::mid {
+
+namespace {
+
+constexpr uint32_t kMagic   = 0x52495958;  // "XYIR"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kNone    = 0xffffffff;  // null operand or no type
+constexpr uint32_t kFuncRef = 0x80000000;  // operand refers to a function
+
+enum class TypeKind : uint8_t { Prim, Const, Pointer, Func };
+enum class ConstKind : uint32_t { Int, String };
+
+struct StrRef {
+  uint32_t offset, size;
+};
+
+struct Loc {
+  uint32_t line;
+  uint16_t col, file;
+};
+
+struct Header {
+  uint32_t magic, version;
+  uint32_t str_offset, str_size;
+  uint32_t file_offset, file_num;
+  uint32_t type_offset, type_num;
+  uint32_t func_offset, func_num;
+};
+
+// followed by 'arg_num' type indices
+struct TypeRecord {
+  uint8_t  kind, prim, is_right, pad;
+  uint32_t base;      // base type, or return type of function
+  uint32_t arg_num;
+};
+
+struct FuncRecord {
+  StrRef   name;
+  uint32_t type;
+  Loc      loc;
+  uint32_t body_offset, body_size;
+};
+
+// followed by records of args, blocks, instructions, constants and
+// operands, values are numbered in this order
+struct BodyHeader {
+  uint32_t arg_num, block_num, inst_num, const_num, operand_num;
+  uint32_t op_begin, op_num;  // blocks of function
+};
+
+struct ArgRecord {
+  StrRef   name;
+  uint32_t type;
+};
+
+struct BlockRecord {
+  StrRef   name;
+  Loc      loc;
+  uint32_t op_begin, op_num;  // predecessors
+};
+
+struct InstRecord {
+  uint32_t opcode, type, block;
+  uint32_t extra[2];  // operator of 'icmp', name of 'alloca'
+  Loc      loc;
+  uint32_t op_begin, op_num;
+};
+
+struct ConstRecord {
+  uint32_t kind, type;
+  StrRef   value;     // integer value is in 'offset'
+};
+
+static_assert(sizeof(Header) == 40 && sizeof(TypeRecord) == 12 &&
+              sizeof(FuncRecord) == 28 && sizeof(BodyHeader) == 28 &&
+              sizeof(ArgRecord) == 12 && sizeof(BlockRecord) == 24 &&
+              sizeof(InstRecord) == 36 && sizeof(ConstRecord) == 16,
+              "records should be packed");
+
+template <typename T>
+void Append(std::string &buf, const T &rec) {
+  buf.append(reinterpret_cast<const char *>(&rec), sizeof(T));
+}
+
+bool IsBinaryOpcode(uint32_t opcode) {
+  return (opcode >= Instruction::BinaryOpsBegin &&
+          opcode < Instruction::BinaryOpsEnd) ||
+         (opcode >= Instruction::AssignOpsBegin &&
+          opcode < Instruction::AssignOpsEnd);
+}
+
+// kind of values an operand can refer to
+enum class OperandKind { Value, Block, Func };
+
+// 'opcode' is 'kNone' for operands of functions and blocks
+OperandKind GetOperandKind(uint32_t opcode, uint32_t index) {
+  switch (opcode) {
+    case kNone:             return OperandKind::Block;
+    case Instruction::Jmp:  return OperandKind::Block;
+    case Instruction::Br:   return index ? OperandKind::Block : OperandKind::Value;
+    case Instruction::Call: return index ? OperandKind::Value : OperandKind::Func;
+    case Instruction::PHI:  return index % 2 ? OperandKind::Block : OperandKind::Value;
+    default:                return OperandKind::Value;
+  }
+}
+
+/* ModuleWriter
+ * Collect strings, types and function bodies of a module,
+ * then write all sections.
+ */
+class ModuleWriter {
+private:
+  Module                                                 &_module;
+  std::string                                             _strings;
+  std::unordered_map<std::string, StrRef>                 _str_refs;
+  std::vector<StrRef>                                     _files;
+  std::unordered_map<uint16_t, uint16_t>                  _file_ids;
+  std::string                                             _types;
+  uint32_t                                                _type_num = 0;
+  std::unordered_map<const TYPE::TypeInfo *, uint32_t>    _type_ids;
+  std::unordered_map<const Value *, uint32_t>             _func_ids;
+
+  StrRef   AddString(const std::string &str);
+  uint32_t AddType(const TYPE::TypeInfoPtr &type);
+  Loc      AddLoc(const front::SourceLoc &loc);
+  bool     WriteBody(Function *F, std::string &body);
+
+public:
+  explicit ModuleWriter(Module &M) : _module(M) {}
+
+  bool Write(std::ostream &os);
+};
+
+StrRef ModuleWriter::AddString(const std::string &str) {
+  auto it = _str_refs.find(str);
+  if (it != _str_refs.end()) return it->second;
+  StrRef ref = {static_cast<uint32_t>(_strings.size()),
+                static_cast<uint32_t>(str.size())};
+  _strings += str;
+  _str_refs[str] = ref;
+  return ref;
+}
+
+uint32_t ModuleWriter::AddType(const TYPE::TypeInfoPtr &type) {
+  if (!type) return kNone;
+  auto it = _type_ids.find(type.get());
+  if (it != _type_ids.end()) return it->second;
+
+  // add referenced types first
+  TypeRecord rec = {};
+  std::vector<uint32_t> args;
+  rec.base = kNone;
+  rec.is_right = type->IsRightValue();
+  if (type->IsConst()) {
+    rec.kind = static_cast<uint8_t>(TypeKind::Const);
+    rec.base = AddType(static_cast<TYPE::ConstType *>(type.get())->base());
+  } else if (type->IsPointer()) {
+    rec.kind = static_cast<uint8_t>(TypeKind::Pointer);
+    rec.base = AddType(type->GetDereferenceType());
+  } else if (type->IsFunction()) {
+    rec.kind = static_cast<uint8_t>(TypeKind::Func);
+    rec.base = AddType(type->GetReturnType());
+    auto arg_types = *type->GetArgsType();
+    for (const auto &arg : arg_types) args.push_back(AddType(arg));
+  } else {
+    rec.kind = static_cast<uint8_t>(TypeKind::Prim);
+    rec.prim = static_cast<uint8_t>(type->GetType());
+  }
+  rec.arg_num = static_cast<uint32_t>(args.size());
+  Append(_types, rec);
+  for (const auto &arg : args) Append(_types, arg);
+  _type_ids[type.get()] = _type_num;
+  return _type_num++;
+}
+
+Loc ModuleWriter::AddLoc(const front::SourceLoc &loc) {
+  auto it = _file_ids.find(loc.file);
+  if (it == _file_ids.end()) {
+    auto name = front::SourceManager::get().getFilename(loc.file);
+    it = _file_ids.emplace(loc.file, _files.size()).first;
+    _files.push_back(AddString(std::string(name)));
+  }
+  return {loc.line, loc.col, it->second};
+}
+
+bool ModuleWriter::WriteBody(Function *F, std::string &body) {
+  std::unordered_map<const Value *, uint32_t> ids;
+  std::vector<ArgRecord> args;
+  std::vector<BlockRecord> blocks;
+  std::vector<InstRecord> insts;
+  std::vector<ConstRecord> consts;
+  std::vector<uint32_t> operands;
+  std::vector<const User *> users = {F};
+
+  // number args, blocks and instructions
+  for (const auto &arg : F->args()) {
+    if (!arg) return false;
+    ids[arg] = static_cast<uint32_t>(ids.size());
+    auto name = static_cast<ArgRefSSA *>(arg)->arg_name();
+    args.push_back({AddString(name), AddType(arg->type())});
+  }
+  std::vector<BasicBlock *> block_list;
+  for (const auto &it : *F) {
+    auto block = dynamic_cast<BasicBlock *>(it.get());
+    if (!block) return false;
+    ids[block] = static_cast<uint32_t>(ids.size());
+    block_list.push_back(block);
+    users.push_back(block);
+    blocks.push_back({AddString(block->name()), AddLoc(block->loc()), 0, 0});
+  }
+  for (std::size_t i = 0; i < block_list.size(); ++i) {
+    for (const auto &inst : block_list[i]->insts()) {
+      ids[inst] = static_cast<uint32_t>(ids.size());
+      users.push_back(inst);
+      InstRecord rec = {};
+      rec.opcode = inst->opcode();
+      rec.type = AddType(inst->type());
+      rec.block = static_cast<uint32_t>(i);
+      rec.loc = AddLoc(inst->loc());
+      if (rec.opcode == Instruction::ICmp) {
+        rec.extra[0] = static_cast<uint32_t>(static_cast<ICmpInst *>(inst)->op());
+      } else if (rec.opcode == Instruction::Alloca) {
+        auto name = AddString(static_cast<AllocaInst *>(inst)->name());
+        rec.extra[0] = name.offset;
+        rec.extra[1] = name.size;
+      }
+      insts.push_back(rec);
+    }
+  }
+
+  // encode operands of function, blocks and instructions,
+  // constants are numbered when they are first used
+  auto const_base = ids.size();
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  for (const auto &user : users) {
+    auto begin = static_cast<uint32_t>(operands.size());
+    for (const auto &use : *user) {
+      auto value = use.get();
+      if (!value) {
+        operands.push_back(kNone);
+        continue;
+      }
+      if (auto it = ids.find(value); it != ids.end()) {
+        operands.push_back(it->second);
+        continue;
+      }
+      if (auto it = _func_ids.find(value); it != _func_ids.end()) {
+        operands.push_back(kFuncRef | it->second);
+        continue;
+      }
+      ConstRecord rec = {};
+      rec.type = AddType(value->type());
+      if (auto cint = dynamic_cast<ConstantInt *>(value)) {
+        rec.kind = static_cast<uint32_t>(ConstKind::Int);
+        rec.value.offset = cint->value();
+      } else if (auto cstr = dynamic_cast<ConstantString *>(value)) {
+        rec.kind = static_cast<uint32_t>(ConstKind::String);
+        rec.value = AddString(cstr->value());
+      } else {
+        // value of other functions
+        return false;
+      }
+      auto id = static_cast<uint32_t>(const_base + consts.size());
+      ids[value] = id;
+      consts.push_back(rec);
+      operands.push_back(id);
+    }
+    ranges.emplace_back(begin, static_cast<uint32_t>(operands.size()) - begin);
+  }
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    std::tie(blocks[i].op_begin, blocks[i].op_num) = ranges[1 + i];
+  }
+  for (std::size_t i = 0; i < insts.size(); ++i) {
+    std::tie(insts[i].op_begin, insts[i].op_num) = ranges[1 + blocks.size() + i];
+  }
+
+  BodyHeader header = {};
+  header.arg_num = static_cast<uint32_t>(args.size());
+  header.block_num = static_cast<uint32_t>(blocks.size());
+  header.inst_num = static_cast<uint32_t>(insts.size());
+  header.const_num = static_cast<uint32_t>(consts.size());
+  header.operand_num = static_cast<uint32_t>(operands.size());
+  std::tie(header.op_begin, header.op_num) = ranges[0];
+  Append(body, header);
+  for (const auto &it : args) Append(body, it);
+  for (const auto &it : blocks) Append(body, it);
+  for (const auto &it : insts) Append(body, it);
+  for (const auto &it : consts) Append(body, it);
+  for (const auto &it : operands) Append(body, it);
+  return true;
+}
+
+bool ModuleWriter::Write(std::ostream &os) {
+  if (!_module.MaterializeAll()) return false;
+  const auto &funcs = _module.Functions();
+  for (std::size_t i = 0; i < funcs.size(); ++i) {
+    _func_ids[funcs[i]] = static_cast<uint32_t>(i);
+  }
+
+  // write bodies first to collect all strings and types
+  std::string bodies;
+  std::vector<FuncRecord> records;
+  for (const auto &func : funcs) {
+    FuncRecord rec = {};
+    rec.name = AddString(func->GetFunctionName());
+    rec.type = AddType(func->type());
+    rec.loc = AddLoc(func->loc());
+    rec.body_offset = static_cast<uint32_t>(bodies.size());
+    if (!WriteBody(func, bodies)) {
+      func->logger().LogError("function '" + func->GetFunctionName() +
+                              "' can not be serialized");
+      return false;
+    }
+    rec.body_size = static_cast<uint32_t>(bodies.size() - rec.body_offset);
+    records.push_back(rec);
+  }
+
+  Header header = {};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.str_offset = sizeof(Header);
+  header.str_size = static_cast<uint32_t>(_strings.size());
+  header.file_offset = header.str_offset + header.str_size;
+  header.file_num = static_cast<uint32_t>(_files.size());
+  header.type_offset = header.file_offset + header.file_num * sizeof(StrRef);
+  header.type_num = _type_num;
+  header.func_offset = header.type_offset + static_cast<uint32_t>(_types.size());
+  header.func_num = static_cast<uint32_t>(records.size());
+  auto body_base = header.func_offset + header.func_num * sizeof(FuncRecord);
+  if (body_base + bodies.size() > kNone) return false;
+  for (auto &it : records) it.body_offset += body_base;
+
+  std::string buf;
+  Append(buf, header);
+  buf += _strings;
+  for (const auto &it : _files) Append(buf, it);
+  buf += _types;
+  for (const auto &it : records) Append(buf, it);
+  buf += bodies;
+  return static_cast<bool>(os.write(buf.data(), buf.size()));
+}
+
+/* ModuleReader
+ * Map a binary IR file and declare its functions in a module,
+ * function bodies are decoded from the mapped file on demand.
+ */
+class ModuleReader : public Materializer {
+private:
+  Module                                          &_module;
+  const char                                      *_data = nullptr;
+  std::size_t                                      _size = 0;
+  Header                                           _header = {};
+  std::vector<uint16_t>                            _files;
+  std::vector<TYPE::TypeInfoPtr>                   _types;
+  std::vector<FuncPtr>                             _funcs;
+  std::unordered_map<const Function *, uint32_t>   _func_ids;
+  std::unordered_set<const Function *>             _broken;
+
+  template <typename T>
+  bool Read(std::size_t offset, T &rec) const {
+    if (offset > _size || _size - offset < sizeof(T)) return false;
+    std::memcpy(&rec, _data + offset, sizeof(T));
+    return true;
+  }
+
+  bool GetString(const StrRef &ref, std::string &str) const;
+  bool GetType(uint32_t id, TYPE::TypeInfoPtr &type) const;
+  bool GetLoc(const Loc &loc, front::SourceLoc &src_loc) const;
+  bool ReadFiles();
+  bool ReadTypes();
+  bool ReadFunctions();
+  bool ReadBody(Function *F);
+
+public:
+  explicit ModuleReader(Module &M) : _module(M) {}
+
+  ~ModuleReader() override {
+    if (_data) munmap(const_cast<char *>(_data), _size);
+  }
+
+  bool Open(const std::string &file);
+
+  bool Materialize(Function *F) override;
+};
+
+bool ModuleReader::GetString(const StrRef &ref, std::string &str) const {
+  if (ref.offset > _header.str_size || _header.str_size - ref.offset < ref.size) {
+    return false;
+  }
+  str.assign(_data + _header.str_offset + ref.offset, ref.size);
+  return true;
+}
+
+bool ModuleReader::GetType(uint32_t id, TYPE::TypeInfoPtr &type) const {
+  if (id == kNone) {
+    type = nullptr;
+    return true;
+  }
+  if (id >= _types.size()) return false;
+  type = _types[id];
+  return true;
+}
+
+bool ModuleReader::GetLoc(const Loc &loc, front::SourceLoc &src_loc) const {
+  if (loc.file >= _files.size()) return false;
+  src_loc.line = loc.line;
+  src_loc.col = loc.col;
+  src_loc.file = _files[loc.file];
+  return true;
+}
+
+bool ModuleReader::ReadFiles() {
+  for (uint32_t i = 0; i < _header.file_num; ++i) {
+    StrRef ref;
+    std::string name;
+    if (!Read(_header.file_offset + i * sizeof(StrRef), ref) ||
+        !GetString(ref, name)) {
+      return false;
+    }
+    _files.push_back(front::SourceManager::get().addFile(name));
+  }
+  return true;
+}
+
+bool ModuleReader::ReadTypes() {
+  using namespace TYPE;
+  std::size_t pos = _header.type_offset;
+  for (uint32_t i = 0; i < _header.type_num; ++i) {
+    TypeRecord rec;
+    if (!Read(pos, rec)) return false;
+    pos += sizeof(rec);
+
+    // referenced types must be defined before
+    TypeInfoPtr base, type;
+    if (rec.base != kNone && rec.base >= i) return false;
+    if (!GetType(rec.base, base)) return false;
+    switch (static_cast<TypeKind>(rec.kind)) {
+      case TypeKind::Prim: {
+        if (rec.prim > static_cast<uint8_t>(Type::Dam)) return false;
+        type = MakePrimType(static_cast<Type>(rec.prim), rec.is_right);
+        break;
+      }
+      case TypeKind::Const: {
+        if (!base) return false;
+        type = MakeConst(base);
+        break;
+      }
+      case TypeKind::Pointer: {
+        if (!base) return false;
+        type = MakePointerType(base, rec.is_right);
+        break;
+      }
+      case TypeKind::Func: {
+        TypePtrList args;
+        for (uint32_t j = 0; j < rec.arg_num; ++j) {
+          uint32_t arg;
+          TypeInfoPtr arg_type;
+          if (!Read(pos, arg) || arg >= i || !GetType(arg, arg_type)) return false;
+          pos += sizeof(arg);
+          args.push_back(arg_type);
+        }
+        type = MakeFuncType(args, base, rec.is_right);
+        break;
+      }
+      default: return false;
+    }
+    _types.push_back(type);
+  }
+  return true;
+}
+
+bool ModuleReader::ReadFunctions() {
+  for (uint32_t i = 0; i < _header.func_num; ++i) {
+    FuncRecord rec;
+    std::string name;
+    TYPE::TypeInfoPtr type;
+    front::SourceLoc loc;
+    if (!Read(_header.func_offset + i * sizeof(FuncRecord), rec) ||
+        !GetString(rec.name, name) || !GetType(rec.type, type) ||
+        !type || !type->IsFunction() || !GetLoc(rec.loc, loc) ||
+        rec.body_offset > _size || _size - rec.body_offset < rec.body_size ||
+        _module.GetFunction(name)) {
+      return false;
+    }
+
+    // only declare the function, body is loaded by 'Materialize'
+    auto func = _module.New<Function>(name);
+    func->set_type(type);
+    func->set_loc(loc);
+    func->set_materializable(true);
+    _module.AddFunction(func);
+    _func_ids[func] = i;
+    _funcs.push_back(func);
+  }
+  return true;
+}
+
+bool ModuleReader::ReadBody(Function *F) {
+  FuncRecord func;
+  BodyHeader header;
+  auto it = _func_ids.find(F);
+  if (it == _func_ids.end() ||
+      !Read(_header.func_offset + it->second * sizeof(FuncRecord), func) ||
+      !Read(func.body_offset, header)) {
+    return false;
+  }
+
+  // check size of body before decoding any record
+  auto size = sizeof(BodyHeader) + uint64_t(header.arg_num) * sizeof(ArgRecord) +
+              uint64_t(header.block_num) * sizeof(BlockRecord) +
+              uint64_t(header.inst_num) * sizeof(InstRecord) +
+              uint64_t(header.const_num) * sizeof(ConstRecord) +
+              uint64_t(header.operand_num) * sizeof(uint32_t);
+  if (size != func.body_size) return false;
+  auto pos = func.body_offset + sizeof(BodyHeader);
+
+  std::vector<SSAPtr> values;
+  std::vector<BlockPtr> blocks;
+  std::string name;
+  TYPE::TypeInfoPtr type;
+  front::SourceLoc loc;
+
+  // create args
+  for (uint32_t i = 0; i < header.arg_num; ++i, pos += sizeof(ArgRecord)) {
+    ArgRecord rec;
+    if (!Read(pos, rec) || !GetString(rec.name, name) || !GetType(rec.type, type)) {
+      return false;
+    }
+    auto arg = _module.New<ArgRefSSA>(F, i, name);
+    arg->set_type(type);
+    F->set_arg(i, arg);
+    values.push_back(arg);
+  }
+
+  // create blocks, operands are resolved after all values are created
+  struct OperandRange {
+    User     *user;
+    uint32_t  opcode, begin, num;
+  };
+  std::vector<OperandRange> ranges;
+  auto in_body = [&header](uint32_t begin, uint32_t num) {
+    return begin <= header.operand_num && header.operand_num - begin >= num;
+  };
+  ranges.push_back({F, kNone, header.op_begin, header.op_num});
+  for (uint32_t i = 0; i < header.block_num; ++i, pos += sizeof(BlockRecord)) {
+    BlockRecord rec;
+    if (!Read(pos, rec) || !GetString(rec.name, name) || !GetLoc(rec.loc, loc)) {
+      return false;
+    }
+    auto block = _module.New<BasicBlock>(F, name);
+    block->set_type(nullptr);
+    block->set_loc(loc);
+    values.push_back(block);
+    blocks.push_back(block);
+    ranges.push_back({block, kNone, rec.op_begin, rec.op_num});
+  }
+
+  // create instructions with null operands, operand range is checked
+  // first since operands of 'call' and 'phi' are allocated by its size
+  for (uint32_t i = 0; i < header.inst_num; ++i, pos += sizeof(InstRecord)) {
+    InstRecord rec;
+    if (!Read(pos, rec) || rec.block >= blocks.size() ||
+        !in_body(rec.op_begin, rec.op_num) ||
+        !GetType(rec.type, type) || !GetLoc(rec.loc, loc)) {
+      return false;
+    }
+    Instruction *inst = nullptr;
+    switch (rec.opcode) {
+      case Instruction::Ret: inst = _module.New<ReturnInst>(nullptr); break;
+      case Instruction::Jmp: inst = _module.New<JumpInst>(nullptr); break;
+      case Instruction::Br: {
+        inst = _module.New<BranchInst>(nullptr, nullptr, nullptr);
+        break;
+      }
+      case Instruction::Load: inst = _module.New<LoadInst>(nullptr); break;
+      case Instruction::Store: inst = _module.New<StoreInst>(nullptr, nullptr); break;
+      case Instruction::Alloca: {
+        if (!GetString({rec.extra[0], rec.extra[1]}, name)) return false;
+        inst = _module.New<AllocaInst>(name);
+        break;
+      }
+      case Instruction::ICmp: {
+        auto op = static_cast<AST::Operator>(rec.extra[0]);
+        if (op < AST::Operator::Equal || op > AST::Operator::UGreatEq) return false;
+        inst = _module.New<ICmpInst>(op, nullptr, nullptr);
+        break;
+      }
+      case Instruction::Call: {
+        if (!rec.op_num) return false;
+        std::vector<SSAPtr> args(rec.op_num - 1, nullptr);
+        inst = _module.New<CallInst>(nullptr, args);
+        break;
+      }
+      case Instruction::PHI: {
+        auto phi = _module.New<PHINode>();
+        for (uint32_t j = 0; j < rec.op_num / 2; ++j) phi->AddIncoming(nullptr, nullptr);
+        inst = phi;
+        break;
+      }
+      default: {
+        if (!IsBinaryOpcode(rec.opcode)) return false;
+        auto opcode = static_cast<Instruction::BinaryOps>(rec.opcode);
+        inst = _module.New<BinaryOperator>(opcode, nullptr, nullptr, type);
+        break;
+      }
+    }
+    if (inst->size() != rec.op_num) return false;
+    inst->set_type(type);
+    inst->set_loc(loc);
+    blocks[rec.block]->AddInstToEnd(inst);
+    values.push_back(inst);
+    ranges.push_back({inst, rec.opcode, rec.op_begin, rec.op_num});
+  }
+
+  // create constants
+  for (uint32_t i = 0; i < header.const_num; ++i, pos += sizeof(ConstRecord)) {
+    ConstRecord rec;
+    if (!Read(pos, rec) || !GetType(rec.type, type)) return false;
+    SSAPtr value;
+    if (rec.kind == static_cast<uint32_t>(ConstKind::Int)) {
+      value = _module.New<ConstantInt>(rec.value.offset);
+    } else if (rec.kind == static_cast<uint32_t>(ConstKind::String)) {
+      if (!GetString(rec.value, name)) return false;
+      value = _module.New<ConstantString>(name);
+    } else {
+      return false;
+    }
+    value->set_type(type);
+    values.push_back(value);
+  }
+
+  // resolve operands
+  auto block_begin = header.arg_num, block_end = block_begin + header.block_num;
+  for (const auto &[user, opcode, begin, num] : ranges) {
+    if (!in_body(begin, num)) return false;
+    for (uint32_t i = 0; i < num; ++i) {
+      uint32_t id;
+      SSAPtr value = nullptr;
+      if (!Read(pos + (begin + i) * sizeof(uint32_t), id)) return false;
+      auto kind = GetOperandKind(opcode, i);
+      if (id == kNone) {
+        // incoming values of phi nodes can not be null
+        if (kind != OperandKind::Value || opcode == Instruction::PHI) return false;
+      } else if (id & kFuncRef) {
+        if (kind != OperandKind::Func || (id & ~kFuncRef) >= _funcs.size()) return false;
+        value = _funcs[id & ~kFuncRef];
+      } else {
+        bool is_block = id >= block_begin && id < block_end;
+        if (id >= values.size() || is_block != (kind == OperandKind::Block) ||
+            kind == OperandKind::Func) {
+          return false;
+        }
+        value = values[id];
+      }
+      // operands of instructions are pre-allocated
+      if (user->isInstruction()) {
+        (*user)[i].set(value);
+      } else {
+        user->AddValue(value);
+      }
+    }
+  }
+  return true;
+}
+
+bool ModuleReader::Materialize(Function *F) {
+  if (_broken.count(F)) return false;
+  if (ReadBody(F)) return true;
+
+  // leave an empty body, so that partially loaded values are not reachable
+  F->DropAllReferences();
+  _broken.insert(F);
+  F->logger().LogError("invalid body of function '" + F->GetFunctionName() + "'");
+  return false;
+}
+
+bool ModuleReader::Open(const std::string &file) {
+  auto fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(Header))) {
+    close(fd);
+    return false;
+  }
+  auto mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) return false;
+  _data = static_cast<const char *>(mem);
+  _size = st.st_size;
+
+  // check header, then load all sections except function bodies
+  if (!Read(0, _header) || _header.magic != kMagic ||
+      _header.version != kVersion || _header.str_offset > _size ||
+      _size - _header.str_offset < _header.str_size) {
+    return false;
+  }
+  return ReadFiles() && ReadTypes() && ReadFunctions();
+}
+
+}
+
+bool WriteModule(Module &M, std::ostream &os) {
+  ModuleWriter writer(M);
+  return writer.Write(os);
+}
+
+bool WriteModule(Module &M, const std::string &file) {
+  std::ofstream ofs(file, std::ios::binary | std::ios::trunc);
+  return ofs && WriteModule(M, ofs) && ofs.flush();
+}
+
+bool ReadModule(const std::string &file, Module &M) {
+  auto reader = std::make_unique<ModuleReader>(M);
+  if (!reader->Open(file)) return false;
+  M.SetMaterializer(std::move(reader));
+  return true;
+}
+
+}
@@ -0,0 +1,37 @@
+#ifndef RJIT_SERIALIZE_H
+#define RJIT_SERIALIZE_H
+
+#include <ostream>
+#include <string>
+
+#include "mid/ir/module.h"
+
+namespace RJIT::mid {
+
+/* Binary IR format
+ * A module is written as a header followed by sections, all integers are
+ * little-endian and records have fixed size, so they can be read in place
+ * from a mapped file:
+ *   header    magic, version, offsets and sizes of other sections
+ *   strings   bytes of all names, referenced by (offset, length)
+ *   files     names of source files of source locations
+ *   types     type records, a type only refers to types before it
+ *   functions name, type, location and body range of each function
+ *   bodies    per function: args, constants, blocks, instructions and
+ *             operands, operands are indices of values in the body,
+ *             or indices of functions if the highest bit is set
+ * Bodies are self-contained, so a reader only needs to decode the body of
+ * a function when the function is used.
+ */
+
+// write module 'M' to 'os', return false if failed
+bool WriteModule(Module &M, std::ostream &os);
+bool WriteModule(Module &M, const std::string &file);
+
+// map binary IR file and declare all functions in empty module 'M',
+// bodies are loaded on 'Module::Materialize', return false if failed
+bool ReadModule(const std::string &file, Module &M);
+
+}
+
+#endif //RJIT_SERIALIZE_H
@@ -3,6 +3,7 @@
 #include "castssa.h"
 #include "constant.h"
 #include "idmanager.h"
+#include "module.h"
 #include "lib/guard.h"
 #include "define/type.h"
 
@@ -12,7 +13,7 @@ Instruction::Instruction(unsigned opcode, unsigned operand_nums, const SSAPtr& i
     : User(operand_nums), _opcode(opcode) {
   if (insertBefore != nullptr) {
     DBG_ASSERT(insertBefore->GetParent(), "InsertBefore do not contain a parent(BasicBlock)");
-    insertBefore->GetParent()->AddInstBefore(insertBefore, SSAPtr(this));
+    insertBefore->GetParent()->AddInstBefore(insertBefore, this);
   }
 }
 
@@ -21,23 +22,21 @@ Instruction::Instruction(unsigned opcode, unsigned operand_nums,
    : User(operand_nums, operands), _opcode(opcode) {
   if (insertBefore != nullptr) {
     DBG_ASSERT(insertBefore->GetParent(), "InsertBefore do not contain a parent(BasicBlock)");
-    auto insts = insertBefore->GetParent()->insts();
-    auto it = std::find(insts.begin(), insts.end(), insertBefore);
-    insts.insert(it, SSAPtr(this));
+    insertBefore->GetParent()->AddInstBefore(insertBefore, this);
   }
 }
 
 Instruction::Instruction(unsigned opcode, unsigned operand_nums, const BlockPtr &insertAtEnd)
     : User(operand_nums), _opcode(opcode) {
   DBG_ASSERT(insertAtEnd != nullptr, "Basic block to append to may not be NULL");
-  insertAtEnd->AddInstToEnd(SSAPtr(this));
+  insertAtEnd->AddInstToEnd(this);
 }
 
 Instruction::Instruction(unsigned opcode, unsigned operand_nums,
             const Operands& operands, const BlockPtr &insertAtEnd)
     : User(operand_nums, operands), _opcode(opcode) {
   DBG_ASSERT(insertAtEnd != nullptr, "Basic block to append to may not be NULL");
-  insertAtEnd->AddInstToEnd(SSAPtr(this));
+  insertAtEnd->AddInstToEnd(this);
 }
 
 
@@ -126,75 +125,101 @@ BinaryOperator::BinaryOperator(Instruction::BinaryOps opcode, const SSAPtr &S1,
   AddValue(S2);
 }
 
-BinaryPtr
-BinaryOperator::Create(Instruction::BinaryOps opcode, const SSAPtr &S1,
-     const SSAPtr &S2, const SSAPtr &IB) {
+// operand types are not the same object in general: integer literals are
+// 'const u32', loaded values may be left or right values, and operands of
+// different widths are not extended before here. So only check that both
+// are integers, result has the longer type
+static TYPE::TypeInfoPtr GetBinaryType(const SSAPtr &S1, const SSAPtr &S2) {
   auto s1_type = S1->type();
   auto s2_type = S2->type();
   DBG_ASSERT(s1_type->IsPrime(), "S1 is not prime type");
   DBG_ASSERT(s2_type->IsPrime(), "S2 is not prime type");
-  DBG_ASSERT(s1_type->IsInteger(), "binary operator can only being performed on int");
+  DBG_ASSERT(s1_type->IsInteger() && s2_type->IsInteger(),
+             "binary operator can only being performed on int");
+  return s1_type->IsNotShortThan(s2_type) ? s1_type : s2_type;
+}
 
-  // TODO: add necessary cast here
-//  DBG_ASSERT(s1_type == s2_type, "S1 has different type with S2");
-  if (s1_type->IsNotShortThan(s2_type))
-    return std::make_shared<BinaryOperator>(opcode, S1, S2, s1_type, IB);
-  else
-    return std::make_shared<BinaryOperator>(opcode, S1, S2, s2_type, IB);
+BinaryPtr
+BinaryOperator::Create(Module &M, Instruction::BinaryOps opcode, const SSAPtr &S1,
+     const SSAPtr &S2, const SSAPtr &IB) {
+  return M.New<BinaryOperator>(opcode, S1, S2, GetBinaryType(S1, S2), IB);
 }
 
 BinaryPtr
-BinaryOperator::Create(Instruction::BinaryOps opcode, const SSAPtr &S1,
+BinaryOperator::Create(Module &M, Instruction::BinaryOps opcode, const SSAPtr &S1,
      const SSAPtr &S2, const BlockPtr &IAE) {
-  auto s1_type = S1->type();
-  auto s2_type = S2->type();
-  DBG_ASSERT(s1_type->IsPrime(), "S1 is not prime type");
-  DBG_ASSERT(s2_type->IsPrime(), "S2 is not prime type");
-  DBG_ASSERT(s1_type->IsInteger(), "binary operator can only being performed on int");
-
-  DBG_ASSERT(s1_type == s2_type, "S1 has different type with S2");
-  if (s1_type->IsNotShortThan(s2_type))
-    return std::make_shared<BinaryOperator>(opcode, S1, S2, s1_type, IAE);
-  else
-    return std::make_shared<BinaryOperator>(opcode, S1, S2, s2_type, IAE);
+  return M.New<BinaryOperator>(opcode, S1, S2, GetBinaryType(S1, S2), IAE);
 }
 
-BinaryPtr BinaryOperator::createNeg(const SSAPtr &Op, const SSAPtr &InsertBefore) {
+BinaryPtr BinaryOperator::createNeg(Module &M, const SSAPtr &Op, const SSAPtr &InsertBefore) {
   auto typeInfo = Op->type();
   DBG_ASSERT(typeInfo->IsInteger(), "Neg operator is not integer");
-  auto zero = GetZeroValue(typeInfo->GetType());
-  return std::make_shared<BinaryOperator>(Instruction::Sub, zero, Op,
-                                          typeInfo, InsertBefore);
+  auto zero = GetZeroValue(M, typeInfo->GetType());
+  return M.New<BinaryOperator>(Instruction::Sub, zero, Op,
+                              typeInfo, InsertBefore);
 }
 
-BinaryPtr BinaryOperator::createNeg(const SSAPtr &Op, const BlockPtr &InsertAtEnd) {
+BinaryPtr BinaryOperator::createNeg(Module &M, const SSAPtr &Op, const BlockPtr &InsertAtEnd) {
   auto typeInfo = Op->type();
   DBG_ASSERT(typeInfo->IsInteger(), "Neg operator is not integer");
-  auto zero = GetZeroValue(typeInfo->GetType());
-  return std::make_shared<BinaryOperator>(Instruction::Sub, zero, Op,
-                                          typeInfo, InsertAtEnd);
+  auto zero = GetZeroValue(M, typeInfo->GetType());
+  return M.New<BinaryOperator>(Instruction::Sub, zero, Op,
+                              typeInfo, InsertAtEnd);
 }
 
-BinaryPtr BinaryOperator::createNot(const SSAPtr &Op, const SSAPtr &InsertBefore) {
+BinaryPtr BinaryOperator::createNot(Module &M, const SSAPtr &Op, const SSAPtr &InsertBefore) {
   auto typeInfo = Op->type();
   DBG_ASSERT(typeInfo->IsInteger(), "Not operator is not integer");
-  auto C = GetAllOneValue(typeInfo->GetType());
-  return std::make_shared<BinaryOperator>(Instruction::Xor, Op, C,
-                                          typeInfo, InsertBefore);
+  auto C = GetAllOneValue(M, typeInfo->GetType());
+  return M.New<BinaryOperator>(Instruction::Xor, Op, C,
+                              typeInfo, InsertBefore);
 }
 
-BinaryPtr BinaryOperator::createNot(const SSAPtr &Op, const BlockPtr &InsertAtEnd) {
+BinaryPtr BinaryOperator::createNot(Module &M, const SSAPtr &Op, const BlockPtr &InsertAtEnd) {
   auto typeInfo = Op->type();
   DBG_ASSERT(typeInfo->IsInteger(), "Not operator is not integer");
-  auto C = GetAllOneValue(typeInfo->GetType());
-  return std::make_shared<BinaryOperator>(Instruction::Sub, Op, C,
-                                          typeInfo, InsertAtEnd);
+  auto C = GetAllOneValue(M, typeInfo->GetType());
+  return M.New<BinaryOperator>(Instruction::Sub, Op, C,
+                              typeInfo, InsertAtEnd);
 }
 
 void BasicBlock::AddInstBefore(const SSAPtr &insertBefore, const SSAPtr &inst) {
-  auto it = std::find(_insts.begin(), _insts.end(), insertBefore);
-  DBG_ASSERT(it != _insts.end(), "Basic block don't has this instruction");
-  _insts.insert(it, inst);
+  DBG_ASSERT(insertBefore->GetParent() == this, "Basic block don't has this instruction");
+  auto it = _insts.iterator_to(static_cast<Instruction *>(insertBefore));
+  _insts.insert(it, static_cast<Instruction *>(inst));
+}
+
+InstList::iterator InstList::insert(iterator pos, Instruction *inst) {
+  DBG_ASSERT(inst->_prev == nullptr && inst->_next == nullptr && inst != _head,
+             "instruction is already in a list");
+  auto next = *pos;
+  auto prev = next ? next->_prev : _tail;
+  inst->_prev = prev;
+  inst->_next = next;
+  if (prev) prev->_next = inst; else _head = inst;
+  if (next) next->_prev = inst; else _tail = inst;
+  inst->SetParent(_parent);
+  ++_size;
+  return {this, inst};
+}
+
+InstList::iterator InstList::erase(iterator pos) {
+  auto inst = *pos;
+  DBG_ASSERT(inst != nullptr, "erase end of list");
+  auto next = inst->_next;
+  if (inst->_prev) inst->_prev->_next = next; else _head = next;
+  if (next) next->_prev = inst->_prev; else _tail = inst->_prev;
+  inst->_prev = inst->_next = nullptr;
+  --_size;
+  return {this, next};
+}
+
+void InstList::splice(iterator pos, InstList &other) {
+  while (!other.empty()) {
+    auto inst = other.front();
+    other.erase(other.begin());
+    insert(pos, inst);
+  }
 }
 
 BranchInst::BranchInst(const SSAPtr &cond, const SSAPtr &true_block,
@@ -217,6 +242,19 @@ ICmpInst::ICmpInst(AST::Operator op, const SSAPtr &lhs, const SSAPtr &rhs, const
   AddValue(rhs);
 }
 
+void PHINode::RemoveValue(Value *V) {
+  for (auto i = GetIncomingNum(); i-- > 0;) {
+    if (GetIncomingValue(i) == V || GetIncomingBlock(i) == V) RemoveIncoming(i);
+  }
+}
+
+SSAPtr PHINode::GetIncomingValueFor(const BasicBlock *block) const {
+  for (unsigned i = 0; i < GetIncomingNum(); ++i) {
+    if (GetIncomingBlock(i) == block) return GetIncomingValue(i);
+  }
+  return nullptr;
+}
+
 std::string ICmpInst::opStr() const {
   std::string  op;
   switch (_op) {
@@ -240,9 +278,9 @@ std::string ICmpInst::opStr() const {
 /* ---------------------------- Methods of Constant Value ------------------------------- */
 
 
-SSAPtr GetZeroValue(TYPE::Type type) {
+SSAPtr GetZeroValue(Module &M, TYPE::Type type) {
   using TYPE::Type;
-  auto zero = std::make_shared<ConstantInt>(0);
+  auto zero = M.New<ConstantInt>(0);
   switch (type) {
     case Type::Void:
       zero->set_type(TYPE::MakeVoid());
@@ -265,9 +303,9 @@ SSAPtr GetZeroValue(TYPE::Type type) {
   return zero;
 }
 
-SSAPtr GetAllOneValue(TYPE::Type type) {
+SSAPtr GetAllOneValue(Module &M, TYPE::Type type) {
   using TYPE::Type;
-  auto allOne = std::make_shared<ConstantInt>(-1);
+  auto allOne = M.New<ConstantInt>(-1);
   switch (type) {
     case Type::Void:
       allOne->set_type(TYPE::MakeVoid());
@@ -300,6 +338,34 @@ bool IsCallInst(const SSAPtr &ptr) {
   return false;
 }
 
+bool IsLoadInst(const SSAPtr &ptr) {
+  if (ptr->isInstruction()) {
+    auto inst = CastTo<Instruction>(ptr);
+    if (inst->opcode() == Instruction::MemoryOps::Load) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Blocks GetSuccessors(const BasicBlock *block) {
+  if (block->insts().empty()) return {};
+  auto term = block->insts().back();
+  switch (term->opcode()) {
+    case Instruction::Br: {
+      auto br = static_cast<BranchInst *>(term);
+      auto true_block = CastTo<BasicBlock>(br->true_block());
+      auto false_block = CastTo<BasicBlock>(br->false_block());
+      if (true_block == false_block) return {true_block};
+      return {true_block, false_block};
+    }
+    case Instruction::Jmp:
+      return {CastTo<BasicBlock>(static_cast<JumpInst *>(term)->target())};
+    default:
+      return {};
+  }
+}
+
 bool IsBinaryOperator(const SSAPtr &ptr){
   if (ptr->isInstruction()) {
     auto inst = CastTo<Instruction>(ptr);
@@ -579,7 +645,7 @@ void CallInst::Dump(std::ostream &os, IdManager &id_mgr) const {
 
   // dump callee name
   auto callee = Callee();
-  auto name = std::static_pointer_cast<Function>(callee)->GetFunctionName();
+  auto name = static_cast<Function *>(callee)->GetFunctionName();
   os << name << "(";
 
   for (std::size_t i = 1; i < size(); i++) {
@@ -601,6 +667,20 @@ void ICmpInst::Dump(std::ostream &os, IdManager &id_mgr) const {
   os << std::endl;
 }
 
+void PHINode::Dump(std::ostream &os, IdManager &id_mgr) const {
+  if (PrintPrefix(os, id_mgr, this)) return;
+  auto guard = InExpr();
+  os << "phi ";
+  DumpType(os, type());
+  for (unsigned i = 0; i < GetIncomingNum(); ++i) {
+    os << (i ? ", [ " : " [ ");
+    DumpValue(os, id_mgr, GetIncomingValue(i));
+    os << ", ";
+    auto bguard = InBranch();
+    DumpValue(os, id_mgr, GetIncomingBlock(i));
+    os << " ]";
+  }
+  os << std::endl;
+}
 
-
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #ifndef RJIT_SSA_H
 #define RJIT_SSA_H
 
+#include <iterator>
 #include <utility>
 
 #include "define/AST.h"
@@ -8,56 +9,14 @@
 
 namespace RJIT::mid {
 
-class BasicBlock : public User {
-private:
-  SSAPtrList  _insts;
-  std::string _name;    // block name
-  UserPtr     _parent;  // block's parent(function)
-
-public:
-
-  BasicBlock(UserPtr parent, std::string name)
-      : _name(std::move(name)), _parent(std::move(parent)) {}
-
-  bool isInstruction() const override { return false; }
-
-  // dump ir
-  void Dump(std::ostream &os, IdManager &id_mgr) const override;
-
-  void set_parent(const UserPtr &parent) { _parent = parent; }
-
-  void AddInstToEnd(const SSAPtr &inst) { _insts.emplace_back(inst); }
-
-  void AddInstBefore(const SSAPtr &insertBefore, const SSAPtr &inst);
-
-  //getters
-  SSAPtrList          &insts()        { return _insts;         }
-  SSAPtrList::iterator inst_begin()   { return _insts.begin(); }
-  SSAPtrList::iterator inst_end()     { return _insts.end();   }
-  const UserPtr       &parent() const { return _parent;        }
-  const std::string   &name()   const { return _name;          }
-
-};
+class Module;
 
 class Instruction : public User {
 private:
   unsigned _opcode;
-  InstPtr _prev, _next;
-
-  void SetPrev(InstPtr P) { _prev = std::move(P); }
+  Instruction *_prev = nullptr, *_next = nullptr;   // links of 'InstList'
 
-  void SetNext(InstPtr N) { _next = std::move(N); }
-
-
-  // getNext/Prev - Return the next or previous instruction in the list.  The
-  // last node in the list is a terminator instruction.
-  InstPtr GetNext() { return _next; }
-
-  const InstPtr &GetNext() const { return _next; }
-
-  InstPtr GetPrev() { return _prev; }
-
-  const InstPtr &GetPrev() const { return _prev; }
+  friend class InstList;
 
 public:
   Instruction(unsigned opcode, unsigned operand_nums,
@@ -72,6 +31,12 @@ public:
   Instruction(unsigned opcode, unsigned operand_nums,
               const Operands &operands, const BlockPtr &insertAtEnd);
 
+  // getNext/Prev - Return the next or previous instruction in the list.  The
+  // last node in the list is a terminator instruction.
+  Instruction *GetNext() const { return _next; }
+
+  Instruction *GetPrev() const { return _prev; }
+
   virtual ~Instruction() = default;
 
   void Dump(std::ostream &os, IdManager &id_mgr) const override {}
@@ -136,6 +101,113 @@ public:
 #include "opcode.inc"
 };
 
+/* InstList
+ * Intrusive doubly linked list of instructions, nodes are linked through
+ * 'Instruction::_prev/_next', so insertion and removal are O(1) and need
+ * no allocation. An instruction can only be in one list at a time.
+ */
+class InstList {
+private:
+  BasicBlock  *_parent;
+  Instruction *_head = nullptr;
+  Instruction *_tail = nullptr;
+  std::size_t  _size = 0;
+
+  static Instruction *next(Instruction *inst) { return inst->_next; }
+  static Instruction *prev(Instruction *inst) { return inst->_prev; }
+
+public:
+  class iterator {
+  private:
+    const InstList *_list = nullptr;
+    Instruction    *_node = nullptr;  // nullptr if end
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = Instruction *;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = Instruction **;
+    using reference         = Instruction *;
+
+    iterator() = default;
+    iterator(const InstList *list, Instruction *node) : _list(list), _node(node) {}
+
+    Instruction *operator*()  const { return _node; }
+    Instruction *operator->() const { return _node; }
+
+    iterator &operator++() { _node = next(_node); return *this; }
+    iterator &operator--() { _node = _node ? prev(_node) : _list->_tail; return *this; }
+    iterator operator++(int) { auto it = *this; ++*this; return it; }
+    iterator operator--(int) { auto it = *this; --*this; return it; }
+
+    bool operator==(const iterator &rhs) const { return _node == rhs._node; }
+    bool operator!=(const iterator &rhs) const { return _node != rhs._node; }
+  };
+
+  using const_iterator = iterator;
+
+  explicit InstList(BasicBlock *parent) : _parent(parent) {}
+  InstList(const InstList &) = delete;
+  InstList &operator=(const InstList &) = delete;
+
+  // insert 'inst' before 'pos', returns iterator of 'inst'
+  iterator insert(iterator pos, Instruction *inst);
+
+  // unlink instruction at 'pos', returns iterator of the next one
+  iterator erase(iterator pos);
+
+  // move all instructions of 'other' before 'pos'
+  void splice(iterator pos, InstList &other);
+
+  void push_back(Instruction *inst) { insert(end(), inst); }
+  void pop_back() { erase(iterator(this, _tail)); }
+  void remove(Instruction *inst) { erase(iterator(this, inst)); }
+
+  // iterator of an instruction in current list
+  iterator iterator_to(Instruction *inst) const { return {this, inst}; }
+
+  iterator     begin() const { return {this, _head}; }
+  iterator     end()   const { return {this, nullptr}; }
+  Instruction *front() const { return _head; }
+  Instruction *back()  const { return _tail; }
+  std::size_t  size()  const { return _size; }
+  bool         empty() const { return _size == 0; }
+};
+
+class BasicBlock : public User {
+private:
+  InstList    _insts;
+  std::string _name;    // block name
+  UserPtr     _parent;  // block's parent(function)
+
+public:
+
+  BasicBlock(UserPtr parent, std::string name)
+      : _insts(this), _name(std::move(name)), _parent(parent) {}
+
+  bool isInstruction() const override { return false; }
+
+  // dump ir
+  void Dump(std::ostream &os, IdManager &id_mgr) const override;
+
+  void set_parent(const UserPtr &parent) { _parent = parent; }
+
+  void AddInstToEnd(const SSAPtr &inst) {
+    _insts.push_back(static_cast<Instruction *>(inst));
+  }
+
+  void AddInstBefore(const SSAPtr &insertBefore, const SSAPtr &inst);
+
+  //getters
+  InstList            &insts()        { return _insts;         }
+  const InstList      &insts()  const { return _insts;         }
+  InstList::iterator   inst_begin()   { return _insts.begin(); }
+  InstList::iterator   inst_end()     { return _insts.end();   }
+  const UserPtr       &parent() const { return _parent;        }
+  const std::string   &name()   const { return _name;          }
+
+};
+
 //===----------------------------------------------------------------------===//
 //                            TerminatorInst Class
 //===----------------------------------------------------------------------===//
@@ -219,10 +291,11 @@ public:
 
   static unsigned GetNumOperands() { return 2; }
 
-  static BinaryPtr Create(BinaryOps opcode, const SSAPtr &S1,
+  // instructions are allocated in the arena of module 'M'
+  static BinaryPtr Create(Module &M, BinaryOps opcode, const SSAPtr &S1,
                           const SSAPtr &S2, const SSAPtr &IB = nullptr);
 
-  static BinaryPtr Create(BinaryOps opcode, const SSAPtr &S1,
+  static BinaryPtr Create(Module &M, BinaryOps opcode, const SSAPtr &S1,
                           const SSAPtr &S2, const BlockPtr &IAE);
 
   bool isInstruction() const override { return true; }
@@ -231,24 +304,25 @@ public:
   // statically know what type of instruction you're going to create.  These
   // helpers just save some typing.
 #define HANDLE_BINARY_INST(N, OPC, ClASS)                            \
-  static BinaryPtr Create##OPC(const SSAPtr &V1, const SSAPtr &V2) { \
-    return Create(Instruction::OPC, V1, V2);                         \
+  static BinaryPtr Create##OPC(Module &M, const SSAPtr &V1,          \
+            const SSAPtr &V2) {                                      \
+    return Create(M, Instruction::OPC, V1, V2);                      \
   }
 
 #include "instruction.inc"
 
 #define HANDLE_BINARY_INST(N, OPC, ClASS)                            \
-  static BinaryPtr Create##OPC(const SSAPtr &V1, const SSAPtr &V2,   \
-            const BlockPtr &IAE) {                                   \
-    return Create(Instruction::OPC, V1, V2, IAE);                    \
+  static BinaryPtr Create##OPC(Module &M, const SSAPtr &V1,          \
+            const SSAPtr &V2, const BlockPtr &IAE) {                 \
+    return Create(M, Instruction::OPC, V1, V2, IAE);                 \
   }
 
 #include "instruction.inc"
 
 #define HANDLE_BINARY_INST(N, OPC, ClASS)                            \
-  static BinaryPtr Create##OPC(const SSAPtr &V1, const SSAPtr &V2,   \
-            const SSAPtr &IB) {                                      \
-    return Create(Instruction::OPC, V1, V2, IB);                     \
+  static BinaryPtr Create##OPC(Module &M, const SSAPtr &V1,          \
+            const SSAPtr &V2, const SSAPtr &IB) {                    \
+    return Create(M, Instruction::OPC, V1, V2, IB);                  \
   }
 
 #include "instruction.inc"
@@ -260,10 +334,10 @@ public:
   /// createNeg, createNot - Create the NEG and NOT
   ///     instructions out of SUB and XOR instructions.
   ///
-  static BinaryPtr createNeg(const SSAPtr &Op, const SSAPtr &InsertBefore = nullptr);
-  static BinaryPtr createNeg(const SSAPtr &Op, const BlockPtr &InsertAtEnd);
-  static BinaryPtr createNot(const SSAPtr &Op, const SSAPtr &InsertBefore = nullptr);
-  static BinaryPtr createNot(const SSAPtr &Op, const BlockPtr &InsertAtEnd);
+  static BinaryPtr createNeg(Module &M, const SSAPtr &Op, const SSAPtr &InsertBefore = nullptr);
+  static BinaryPtr createNeg(Module &M, const SSAPtr &Op, const BlockPtr &InsertAtEnd);
+  static BinaryPtr createNot(Module &M, const SSAPtr &Op, const SSAPtr &InsertBefore = nullptr);
+  static BinaryPtr createNot(Module &M, const SSAPtr &Op, const BlockPtr &InsertAtEnd);
 };
 
 // function definition
@@ -272,9 +346,13 @@ class Function : public User {
 private:
   std::vector<SSAPtr> _args;
   std::string _function_name;
+  bool _materializable = false;   // body is not loaded yet
 
 public:
-  explicit Function(std::string name) : _function_name(std::move(name)) {}
+  explicit Function(std::string name) : _function_name(std::move(name)) {
+    // used by calls in other functions
+    set_shared(true);
+  }
 
   bool isInstruction() const override { return false; }
 
@@ -287,9 +365,13 @@ public:
     _args[i] = arg;
   }
 
+  void set_materializable(bool materializable) { _materializable = materializable; }
+
   // getters
   const std::string &GetFunctionName() const { return _function_name; }
 
+  bool IsMaterializable() const { return _materializable; }
+
   const std::vector<SSAPtr> &args() { return _args; }
 };
 
@@ -513,8 +595,49 @@ public:
   std::string         opStr() const;
 };
 
+// select value by the predecessor that control comes from
+// operands: value0, block0, value1, block1, ...
+class PHINode : public Instruction {
+public:
+  explicit PHINode(const SSAPtr &IB = nullptr)
+      : Instruction(Instruction::OtherOps::PHI, 0, IB) {}
+
+  bool isInstruction() const override { return true; }
+
+  // dump ir
+  void Dump(std::ostream &os, IdManager &id_mgr) const override;
+
+  // remove incoming pairs that contain 'V'
+  void RemoveValue(Value *V) override;
+
+  void AddIncoming(const SSAPtr &value, const BlockPtr &block) {
+    AddValue(value);
+    AddValue(block);
+  }
+
+  void RemoveIncoming(unsigned i) {
+    RemoveOperand(i * 2 + 1);
+    RemoveOperand(i * 2);
+  }
+
+  // get value that comes from 'block', null if 'block' is not a predecessor
+  SSAPtr GetIncomingValueFor(const BasicBlock *block) const;
+
+  // getter/setter
+  unsigned GetIncomingNum() const { return size() / 2; }
+  const SSAPtr &GetIncomingValue(unsigned i) const { return (*this)[i * 2].get(); }
+  BlockPtr GetIncomingBlock(unsigned i) const {
+    return static_cast<BlockPtr>((*this)[i * 2 + 1].get());
+  }
+  void SetIncomingValue(unsigned i, const SSAPtr &value) { (*this)[i * 2].set(value); }
+};
+
 bool IsCallInst(const SSAPtr &ptr);
 bool IsBinaryOperator(const SSAPtr &ptr);
+bool IsLoadInst(const SSAPtr &ptr);
+
+// get successors of block from its terminator, without duplicates
+Blocks GetSuccessors(const BasicBlock *block);
 
 }
 #endif //RJIT_SSA_H
@@ -11,11 +11,12 @@ void Use::addToList(const SSAPtr &V) {
 }
 
 Use::Use(Use &&use) noexcept
-    : _value(std::move(use._value)), _user(use._user) {
+    : _value(use._value), _user(use._user) {
   if (_value) {
     _value->removeUse(&use);
     _value->addUse(this);
   }
+  use._value = nullptr;
 }
 
 } //RJIT::mid
@@ -1,10 +1,9 @@
 #ifndef RJIT_USE_H
 #define RJIT_USE_H
 
-#include <list>
-#include <vector>
-#include <memory>
+#include <iterator>
 #include "lib/debug.h"
+#include "lib/smallvec.h"
 
 
 namespace RJIT::mid {
@@ -13,16 +12,17 @@ class Use;
 class User;
 class Value;
 
-using UseList    = std::list<Use *>;
-using Operands   = std::vector<Use>;
-using SSAPtr     = std::shared_ptr<Value>;
-using UserPtr    = std::shared_ptr<User>;
-using SSAPtrList = std::list<SSAPtr>;
+// IR objects are owned by the arena of 'Module', handles are raw pointers
+using SSAPtr     = Value *;
+using UserPtr    = User *;
 
 class Use {
 private:
   SSAPtr _value;
   User  *_user;
+  Use   *_prev = nullptr, *_next = nullptr;   // links of 'UseList'
+
+  friend class UseList;
 
 public:
   Use(const SSAPtr& V, User *U) : _value(V), _user(U) {
@@ -69,6 +69,70 @@ public:
   }
 
 };
+
+/* UseList
+ * Intrusive list of all uses of a value, nodes are linked through
+ * 'Use::_prev/_next', so adding and removing a use are both O(1).
+ */
+class UseList {
+private:
+  Use         *_head = nullptr;
+  std::size_t  _size = 0;
+
+public:
+  class iterator {
+  private:
+    Use *_node = nullptr;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Use *;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = Use **;
+    using reference         = Use *;
+
+    iterator() = default;
+    explicit iterator(Use *node) : _node(node) {}
+
+    Use *operator*() const { return _node; }
+    iterator &operator++() { _node = _node->_next; return *this; }
+    iterator operator++(int) { auto it = *this; ++*this; return it; }
+
+    bool operator==(const iterator &rhs) const { return _node == rhs._node; }
+    bool operator!=(const iterator &rhs) const { return _node != rhs._node; }
+  };
+
+  UseList() = default;
+  UseList(const UseList &) = delete;
+  UseList &operator=(const UseList &) = delete;
+
+  void push_front(Use *U) {
+    DBG_ASSERT(U->_prev == nullptr && U->_next == nullptr && U != _head,
+               "use is already in a list");
+    U->_next = _head;
+    if (_head) _head->_prev = U;
+    _head = U;
+    ++_size;
+  }
+
+  void remove(Use *U) {
+    DBG_ASSERT(U->_prev != nullptr || U == _head, "use is not in this list");
+    if (U->_prev) U->_prev->_next = U->_next; else _head = U->_next;
+    if (U->_next) U->_next->_prev = U->_prev;
+    U->_prev = U->_next = nullptr;
+    --_size;
+  }
+
+  iterator    begin() const { return iterator(_head);    }
+  iterator    end()   const { return iterator(nullptr);  }
+  Use        *front() const { return _head;              }
+  std::size_t size()  const { return _size;              }
+  bool        empty() const { return _head == nullptr;   }
+};
+
+// operands of fixed-arity instructions are kept inline
+using Operands   = lib::SmallVector<Use, 3>;
+
 }
 
 #endif // RJIT_USE_H
@@ -15,10 +15,13 @@ private:
 
 public:
   User() : _operands_num(0) {}
-  explicit User(unsigned operands_num) : _operands_num(operands_num) {}
+  explicit User(unsigned operands_num) : _operands_num(operands_num) {
+    _operands.reserve(operands_num);
+  }
 
   User(unsigned operands_num, const Operands &operands)
     : _operands_num(operands_num) {
+    _operands.reserve(operands_num);
     DBG_ASSERT(_operands.size() <= _operands_num, "User() operands out of range");
     for (const auto &it : operands) {
       AddValue(it.get());
@@ -42,28 +45,36 @@ public:
     _operands.push_back(Use(V, this));
   }
 
-  void RemoveValue(const SSAPtr& V) {
-    RemoveValue(V.get());
-  }
-
-  void RemoveValue(Value *V) {
+  virtual void RemoveValue(Value *V) {
     _operands.erase(
         std::remove_if(_operands.begin(), _operands.end(),
                [&V](const Use &use) {
-                 return use.get().get() == V;
+                 return use.get() == V;
                }), _operands.end());
   }
 
+  // remove operand at 'pos', following operands are moved forward
+  void RemoveOperand(std::size_t pos) {
+    DBG_ASSERT(pos < _operands.size(), "position out of range");
+    _operands.erase(_operands.begin() + pos, _operands.begin() + pos + 1);
+  }
+
+  // remove all operands, so that operands no longer refer to this user
+  void DropAllReferences() { _operands.clear(); }
+
   // access value in current user
   Use &operator[](std::size_t pos) {
-    if(_operands_num == 0) { _operands_num = _operands.size(); }
-    DBG_ASSERT(pos < _operands_num, "position out of range");
+    // users with variable operands have no fixed number of operands
+    DBG_ASSERT(pos < (_operands_num ? _operands_num : _operands.size()),
+               "position out of range");
     return _operands[pos];
   }
 
   // access value in current user (const)
   const Use &operator[](std::size_t pos) const {
-    DBG_ASSERT(pos < _operands_num, "position out of range");
+    // users with variable operands have no fixed number of operands
+    DBG_ASSERT(pos < (_operands_num ? _operands_num : _operands.size()),
+               "position out of range");
     return _operands[pos];
   }
 
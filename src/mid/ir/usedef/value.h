@@ -1,7 +1,9 @@
 #ifndef RJIT_VALUE_H
 #define RJIT_VALUE_H
 
+#include <mutex>
 #include <ostream>
+#include <vector>
 
 #include "define/type.h"
 #include "front/logger.h"
@@ -25,29 +27,47 @@ class TypeSymbolTable;
 
 
 // type aliases
-using FuncPtr       = std::shared_ptr<Function>;
-using InstPtr       = std::shared_ptr<Instruction>;
-using BlockPtr      = std::shared_ptr<BasicBlock>;
-using BinaryPtr     = std::shared_ptr<BinaryOperator>;
-using GlobalVarPtr  = std::shared_ptr<GlobalVariable>;
+using FuncPtr       = Function *;
+using InstPtr       = Instruction *;
+using BlockPtr      = BasicBlock *;
+using BinaryPtr     = BinaryOperator *;
+using GlobalVarPtr  = GlobalVariable *;
 using Blocks        = std::vector<BlockPtr>;
 
 class Value {
 private:
   TYPE::TypeInfoPtr _type;
-  front::LoggerPtr  _logger;
-  BlockPtr          _parent;  // block
+  front::SourceLoc  _loc;
+  BlockPtr          _parent = nullptr;  // block
   UseList           _use_list;
+  bool              _shared = false;    // can be used by other functions
+
+  // function passes may run in parallel, so uses of shared values
+  // are added and removed with this lock
+  static std::mutex &SharedUseMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
 
 public:
   Value() = default;
   virtual ~Value() = default;
 
-  void addUse(Use *U) { _use_list.emplace_back(U); }
+  void addUse(Use *U) {
+    if (!_shared) return _use_list.push_front(U);
+    std::lock_guard<std::mutex> lock(SharedUseMutex());
+    _use_list.push_front(U);
+  }
+
+  void removeUse(Use *U) {
+    if (!_shared) return _use_list.remove(U);
+    std::lock_guard<std::mutex> lock(SharedUseMutex());
+    _use_list.remove(U);
+  }
 
-  void removeUse(Use *U) { _use_list.remove(U); }
+  void set_shared(bool shared) { _shared = shared; }
 
-  void set_logger(const front::LoggerPtr &logger) { _logger = logger;}
+  void set_loc(const front::SourceLoc &loc) { _loc = loc; }
 
   void set_type(const TYPE::TypeInfoPtr &type) { _type = type; }
 
@@ -55,7 +75,7 @@ public:
   virtual void SetParent(const BlockPtr &BB) { _parent = BB; }
 
   void ReplaceBy(const SSAPtr &value) {
-    if (value.get() == this) return;
+    if (value == this) return;
     // reroute all uses to new value
     while (!_use_list.empty()) {
       _use_list.front()->set(value);
@@ -69,8 +89,11 @@ public:
 
   virtual bool isInstruction() const { return false; }
   const UseList &uses() const { return _use_list; }
-  const front::LoggerPtr &logger() const { return _logger; }
+  const front::SourceLoc &loc() const { return _loc; }
+
+  front::Logger logger() const { return front::Logger(_loc); }
   const TYPE::TypeInfoPtr &type() const { return _type; }
+  bool is_shared() const { return _shared; }
 };
 };
 
@@ -29,7 +29,7 @@ namespace RJIT::mid::analyzer {
   }
 
   TypeInfoPtr SemAnalyzer::visit(VariableAST *node) {
-    auto type_ = _symbol->GetItem(node->getName());
+    auto type_ = _symbol->GetItem(node->getSymbol());
     std::string info = "undefined symbol";
     if (!type_) return LogError(node->Logger(), info, node->getName());
     return node->set_ast_type(type_);
@@ -58,7 +58,7 @@ namespace RJIT::mid::analyzer {
     std::string info;
 
     // check if redeclared
-    if (_symbol->GetItem(node->getIdentifier(), false)) {
+    if (_symbol->GetItem(node->getSymbol(), false)) {
       info = "variable has been defined";
       return LogError(node->Logger(), info, node->getIdentifier());
     }
@@ -79,7 +79,7 @@ namespace RJIT::mid::analyzer {
 
     // Add to environment
     var_type = MakePrimType(_decl_type, false);
-    _symbol->AddItem(node->getIdentifier(), var_type);
+    _symbol->AddItem(node->getSymbol(), var_type);
 
     return node->set_ast_type(MakePrimType(node->type(), false));
   }
@@ -240,8 +240,9 @@ namespace RJIT::mid::analyzer {
 
     // check return type here
     auto callee = _symbol->GetItem(node->getSymbol());
+    auto name = node->getName();
     if (callee == nullptr) {
-      info = "function '" + node->getSymbol() + "' undefined";
+      info = "function '" + std::string(name) + "' undefined";
       return LogError(node->Logger(), info);
     }
     auto ret_typeinfo = callee->GetReturnType();
@@ -258,28 +259,28 @@ namespace RJIT::mid::analyzer {
     if (args) {
       if (!args->empty()) {
         if (args->size() != real_args.size()) {
-          info = "function '" + node->getSymbol() + "' need " + std::to_string(args->size());
+          info = "function '" + std::string(name) + "' need " + std::to_string(args->size());
           info += " parameters, but given " + std::to_string(real_args.size()) + " values.";
-          return LogError(node->Logger(), info, node->getSymbol());
+          return LogError(node->Logger(), info, name);
         }
 
         auto args_types = args.value();
         for (std::size_t i = 0; i < args_types.size(); i++) {
           if (args_types[i]->GetTypeId() != real_args[i]->GetTypeId()) {
-            info = "function '" + node->getSymbol() + "(";
+            info = "function '" + std::string(name) + "(";
             auto tail = --(args_types.end());
             for (const auto &it : args_types) {
               info += type2String(it->GetType());
               if (it != *tail) info += ", ";
             }
             info += ")' parameter types are incompliant.";
-            return LogError(node->Logger(), info, node->getSymbol());
+            return LogError(node->Logger(), info, name);
           }
         }
       } else {
         if (!node->getArgs().empty()) {
           info = "function don't need parameters here";
-          return LogError(node->Logger(), info, node->getSymbol());
+          return LogError(node->Logger(), info, name);
         }
       }
     }
@@ -302,15 +303,14 @@ namespace RJIT::mid::analyzer {
 
     // make function type
     auto retType = MakePrimType(ret, false);
-    std::shared_ptr<FuncType> type =
-        std::make_shared<FuncType>(std::move(params), std::move(retType), true);
+    auto type = MakeFuncType(params, retType, true);
 
     const auto &sym = _in_func ? _symbol->outer() : _symbol;
-    if (sym->GetItem(node->getFuncName(), false)) {
+    if (sym->GetItem(node->getSymbol(), false)) {
       info = "symbol has already been defined";
       return LogError(node->Logger(), info, node->getFuncName());
     }
-    sym->AddItem(node->getFuncName(), type);
+    sym->AddItem(node->getSymbol(), type);
 
 
     return node->set_ast_type(type);
@@ -334,11 +334,11 @@ namespace RJIT::mid::analyzer {
 
     if (_in_func) {
       // check if is conflicted
-      if (_symbol->GetItem(node->ArgName(), false)) {
+      if (_symbol->GetItem(node->getSymbol(), false)) {
         info = "argument has already been declared";
         return LogError(node->Logger(), info, node->ArgName());
       }
-      _symbol->AddItem(node->ArgName(), type);
+      _symbol->AddItem(node->getSymbol(), type);
     }
 
     type = MakePrimType(type->GetType(), true);
@@ -366,13 +366,13 @@ namespace RJIT::mid::analyzer {
     return nullptr;
   }
 
-  inline TypeInfoPtr LogError(const LoggerPtr &log, std::string &message, const std::string &id) {
-    log->LogError(message, id);
+  inline TypeInfoPtr LogError(const Logger &log, std::string &message, std::string_view id) {
+    log.LogError(message, id);
     return nullptr;
   }
 
-  inline TypeInfoPtr LogError(const LoggerPtr &log, std::string &message) {
-    log->LogError(message);
+  inline TypeInfoPtr LogError(const Logger &log, std::string &message) {
+    log.LogError(message);
     return nullptr;
   }
 
@@ -5,6 +5,7 @@
 #include "front/logger.h"
 #include "lib/guard.h"
 #include "lib/nestedmap.h"
+#include "lib/intern.h"
 #include "mid/visitor/visitor.h"
 
 using namespace RJIT::lib;
@@ -13,7 +14,7 @@ using namespace RJIT::front;
 
 namespace RJIT::mid::analyzer {
 
-using EnvPtr = lib::Nested::NestedMapPtr<std::string, TypeInfoPtr>;
+using EnvPtr = lib::Nested::NestedMapPtr<lib::Symbol, TypeInfoPtr>;
 
 class SemAnalyzer : Visitor<TypeInfoPtr> {
 private:
@@ -55,9 +56,9 @@ public:
 };
 
 // print error message
-inline TypeInfoPtr LogError(const LoggerPtr &log, std::string &message, const std::string &id);
+inline TypeInfoPtr LogError(const Logger &log, std::string &message, std::string_view id);
 
-inline TypeInfoPtr LogError(const LoggerPtr &log, std::string &message);
+inline TypeInfoPtr LogError(const Logger &log, std::string &message);
 
 }
 
@@ -98,7 +98,7 @@ namespace RJIT::mid {
   }
 
   void Dumper::visit(CallStmt *node) {
-    os << "[ \"" << node->getSymbol() << "\" : function ] ";
+    os << "[ \"" << node->getName() << "\" : function ] ";
     os << "(";
 
     auto tail = --(node->getArgs().end());
@@ -125,7 +125,7 @@ namespace RJIT::mid {
   }
 
   void Dumper::visit(FuncParamAST *node) {
-    os << "\"" << node->ArgName() << "\" : "
+    os << "\"" << lib::SymbolName(node->getSymbol()) << "\" : "
        << node->getTypeStr();
   }
 
@@ -15,13 +15,13 @@ SSAPtr IRBuilder::visit(StringAST *node) {
 }
 
 SSAPtr IRBuilder::visit(VariableAST *node) {
-  auto var_ssa = _module.GetValues(node->getName());
+  auto var_ssa = _module.GetValues(node->getSymbol());
   DBG_ASSERT(var_ssa != nullptr, "variable not found");
   return var_ssa;
 }
 
 SSAPtr IRBuilder::visit(VariableDecl *node) {
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
 
   // save current insert point
   auto cur_insert = _module.InsertPoint();
@@ -38,7 +38,7 @@ SSAPtr IRBuilder::visit(VariableDefAST *node) {
   auto variable = _module.CreateAlloca(node->AstType());
 
   auto symtab = _module.ValueSymTab();
-  symtab->AddItem(node->getIdentifier(), variable);
+  symtab->AddItem(node->getSymbol(), variable);
 
   if (node->hasInit()) {
     auto init_ssa = node->getInitValue()->CodeGeneAction(this);
@@ -68,7 +68,7 @@ SSAPtr IRBuilder::visit(UnaryStmt *node) {
 }
 
 SSAPtr IRBuilder::visit(ReturnStmt *node) {
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
   if (!node->hasReturnVal()) return nullptr;
 
   // create a new block
@@ -130,12 +130,11 @@ SSAPtr IRBuilder::visit(CompoundStmt *node) {
  *            end_block
  */
 SSAPtr IRBuilder::visit(IfElseStmt *node) {
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
   auto func = _module.InsertPoint()->parent();
 
   // create condition block
   auto &cond = node->getCondition();
-  auto cond_block = cond->CodeGeneAction(this);
   auto then_block = _module.CreateBlock(func, "if.then");
   auto else_block = _module.CreateBlock(func, "if.else");
 
@@ -169,10 +168,11 @@ SSAPtr IRBuilder::visit(IfElseStmt *node) {
 }
 
 SSAPtr IRBuilder::visit(CallStmt *node) {
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
 
   auto callee = _module.GetFunction(node->getSymbol());
-  DBG_ASSERT(callee != nullptr, "can't find function %s in symtable", node->getSymbol().c_str());
+  DBG_ASSERT(callee != nullptr, "can't find function %s in symtable",
+            std::string(node->getName()).c_str());
 
   // emit args
   std::vector<SSAPtr> args;
@@ -189,15 +189,15 @@ SSAPtr IRBuilder::visit(CallStmt *node) {
 
 SSAPtr IRBuilder::visit(ProtoTypeAST *node) {
   std::string info;
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
 
   // generate function prototype
   FuncPtr func;
   auto functions = _module.Functions();
-  auto func_name = node->getFuncName();
+  auto func_name = node->getSymbol();
   auto func_type = node->AstType();
-  if (!_module.GetFunction(node->getFuncName())) {
-    func = _module.CreateFunction(func_name, func_type);
+  if (!_module.GetFunction(func_name)) {
+    func = _module.CreateFunction(std::string(node->getFuncName()), func_type);
     functions.push_back(func);
 
     // add to environment
@@ -218,7 +218,7 @@ SSAPtr IRBuilder::visit(ProtoTypeAST *node) {
     auto arg_name = it->ArgName();
     auto param_alloc = it->CodeGeneAction(this);
     // set param_name
-    std::static_pointer_cast<AllocaInst>(param_alloc)->set_name(arg_name + ".addr");
+    static_cast<AllocaInst *>(param_alloc)->set_name(arg_name + ".addr");
     auto arg_ref = _module.CreateArgRef(func, index++, arg_name);
     _module.CreateStore(arg_ref, param_alloc);
   }
@@ -226,7 +226,7 @@ SSAPtr IRBuilder::visit(ProtoTypeAST *node) {
   // create func_exit block to init the return value
   auto ret_type = func_type->GetReturnType();
   auto ret_val = (ret_type->IsVoid()) ? nullptr : _module.CreateAlloca(ret_type);
-  if (ret_val) std::static_pointer_cast<AllocaInst>(ret_val)->set_name("retval");
+  if (ret_val) static_cast<AllocaInst *>(ret_val)->set_name("retval");
   _module.SetRetValue(ret_val);
 
   // jump to exit
@@ -236,17 +236,17 @@ SSAPtr IRBuilder::visit(ProtoTypeAST *node) {
 }
 
 SSAPtr IRBuilder::visit(FunctionDefAST *node) {
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
 
   // make new environment
   auto env = NewEnv();
   _in_func = true;
 
   // generate prototype
-  auto prototype = node->getProtoType()->CodeGeneAction(this);
+  node->getProtoType()->CodeGeneAction(this);
 
   // generate body
-  auto body = node->getBody()->CodeGeneAction(this);
+  node->getBody()->CodeGeneAction(this);
 
   auto func_exit = _module.FuncExit();
   _module.CreateJump(func_exit);
@@ -264,14 +264,14 @@ SSAPtr IRBuilder::visit(FunctionDefAST *node) {
 }
 
 SSAPtr IRBuilder::visit(FuncParamAST *node) {
-  auto cxt = _module.SetContext(node->Logger());
+  auto cxt = _module.SetContext(node->Loc());
   DBG_ASSERT(_in_func, "create parameter should in function");
 
   // create alloca
   auto param = _module.CreateAlloca(node->AstType());
 
   // add param to symtab
-  _module.ValueSymTab()->AddItem(node->ArgName(), param);
+  _module.ValueSymTab()->AddItem(node->getSymbol(), param);
   return param;
 }
 
@@ -292,7 +292,7 @@ SSAPtr IRBuilder::visit(PrimTypeAST *node) {
  *
  */
 SSAPtr IRBuilder::visit(WhileStmt *node) {
-  auto context = _module.SetContext(node->Logger());
+  auto context = _module.SetContext(node->Loc());
   auto cur_insert = _module.InsertPoint();  // save current insert point
   auto func = cur_insert->parent();
 
@@ -330,14 +330,14 @@ SSAPtr IRBuilder::visit(TranslationUnitDecl *node) {
 }
 
 // print error message
-SSAPtr IRBuilder::LogError(const front::LoggerPtr &log,
-                           std::string &message, const std::string &id) {
-  log->LogError(message, id);
+SSAPtr IRBuilder::LogError(const front::Logger &log,
+                           std::string &message, std::string_view id) {
+  log.LogError(message, id);
   return nullptr;
 }
 
-SSAPtr IRBuilder::LogError(const front::LoggerPtr &log, std::string &message) {
-  log->LogError(message);
+SSAPtr IRBuilder::LogError(const front::Logger &log, std::string &message) {
+  log.LogError(message);
   return nullptr;
 }
 
@@ -48,8 +48,8 @@ public:
   void EmitIR() { _translation_decl_unit->CodeGeneAction(this); }
 
   // print error message
-  SSAPtr LogError(const front::LoggerPtr &log, std::string &message);
-  SSAPtr LogError(const front::LoggerPtr &log, std::string &message, const std::string &id);
+  SSAPtr LogError(const front::Logger &log, std::string &message);
+  SSAPtr LogError(const front::Logger &log, std::string &message, std::string_view id);
 };
 
 }
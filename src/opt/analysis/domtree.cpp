@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include "opt/analysis/domtree.h"
+#include "opt/pass.h"
+#include "mid/ir/castssa.h"
+#include "opt/pass_manager.h"
+
+int DominatorTree;
+
+namespace RJIT::opt {
+
+DominatorTree::DominatorTree(const FuncPtr &F) {
+  if (F->empty()) return;
+  ComputeOrder(CastTo<BasicBlock>((*F)[0].get()));
+  ComputeDominators();
+  ComputeFrontiers();
+  NumberTree();
+}
+
+void DominatorTree::ComputeOrder(const BlockPtr &entry) {
+  // iterative DFS, blocks are added in post order
+  std::unordered_map<const BasicBlock *, bool> visited;
+  std::vector<std::pair<BlockPtr, Blocks>> stack;
+  visited[entry] = true;
+  stack.push_back({entry, GetSuccessors(entry)});
+  while (!stack.empty()) {
+    auto &[block, succs] = stack.back();
+    if (succs.empty()) {
+      _blocks.push_back(block);
+      stack.pop_back();
+      continue;
+    }
+    auto succ = succs.back();
+    succs.pop_back();
+    if (!visited[succ]) {
+      visited[succ] = true;
+      stack.push_back({succ, GetSuccessors(succ)});
+    }
+  }
+  std::reverse(_blocks.begin(), _blocks.end());
+  for (std::size_t i = 0; i < _blocks.size(); ++i) _ids[_blocks[i]] = i;
+}
+
+void DominatorTree::ComputeDominators() {
+  auto intersect = [this](std::size_t lhs, std::size_t rhs) {
+    while (lhs != rhs) {
+      while (lhs > rhs) lhs = _idoms[lhs];
+      while (rhs > lhs) rhs = _idoms[rhs];
+    }
+    return lhs;
+  };
+
+  _idoms.assign(_blocks.size(), kNone);
+  _idoms[0] = 0;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (std::size_t b = 1; b < _blocks.size(); ++b) {
+      auto idom = kNone;
+      for (const auto &pred : *_blocks[b]) {
+        auto p = GetIndex(CastTo<BasicBlock>(pred.get()));
+        if (p == kNone || _idoms[p] == kNone) continue;
+        idom = idom == kNone ? p : intersect(p, idom);
+      }
+      if (idom != _idoms[b]) {
+        _idoms[b] = idom;
+        changed = true;
+      }
+    }
+  }
+}
+
+void DominatorTree::ComputeFrontiers() {
+  _children.assign(_blocks.size(), {});
+  _frontiers.assign(_blocks.size(), {});
+  for (std::size_t b = 1; b < _blocks.size(); ++b) {
+    _children[_idoms[b]].push_back(b);
+    if (_blocks[b]->size() < 2) continue;
+    // 'b' is in frontier of blocks on the path from its predecessors
+    // to its immediate dominator
+    for (const auto &pred : *_blocks[b]) {
+      auto runner = GetIndex(CastTo<BasicBlock>(pred.get()));
+      if (runner == kNone) continue;
+      for (; runner != _idoms[b]; runner = _idoms[runner]) {
+        auto &df = _frontiers[runner];
+        if (std::find(df.begin(), df.end(), b) == df.end()) df.push_back(b);
+      }
+    }
+  }
+}
+
+void DominatorTree::NumberTree() {
+  _enter.assign(_blocks.size(), 0);
+  _leave.assign(_blocks.size(), 0);
+  std::size_t counter = 0;
+  std::vector<std::pair<std::size_t, std::size_t>> stack = {{0, 0}};
+  _enter[0] = counter++;
+  while (!stack.empty()) {
+    auto &[b, next] = stack.back();
+    if (next == _children[b].size()) {
+      _leave[b] = counter++;
+      stack.pop_back();
+      continue;
+    }
+    auto child = _children[b][next++];
+    _enter[child] = counter++;
+    stack.push_back({child, 0});
+  }
+}
+
+BlockPtr DominatorTree::GetIDom(const BasicBlock *block) const {
+  auto b = GetIndex(block);
+  return b == kNone || !b ? nullptr : _blocks[_idoms[b]];
+}
+
+bool DominatorTree::Dominates(const BasicBlock *lhs, const BasicBlock *rhs) const {
+  auto l = GetIndex(lhs), r = GetIndex(rhs);
+  if (l == kNone || r == kNone) return false;
+  return _enter[l] <= _enter[r] && _leave[r] <= _leave[l];
+}
+
+/*
+  analysis pass of dominator tree, computes trees of functions that are
+  not cached, so that they are ready before passes that require them
+*/
+class DominatorTreePass : public FunctionPass {
+public:
+  bool runOnFunction(const FuncPtr &F) final {
+    getAnalysis<DominatorTree>(F);
+    return false;
+  }
+
+  std::shared_ptr<FunctionPass> Clone() const final {
+    return std::make_shared<DominatorTreePass>();
+  }
+};
+
+class DominatorTreeFactory : public PassFactory {
+public:
+  PassInfoPtr CreatePass(PassManager *) override {
+    auto pass = std::make_shared<DominatorTreePass>();
+    return std::make_shared<PassInfo>(pass, DominatorTree::kName, true, 0);
+  }
+};
+
+static PassRegisterFactory<DominatorTreeFactory> registry;
+
+}
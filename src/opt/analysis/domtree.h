@@ -0,0 +1,69 @@
+#ifndef XY_LANG_DOMTREE_H
+#define XY_LANG_DOMTREE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "mid/ir/ssa.h"
+#include "opt/analysis_manager.h"
+
+namespace RJIT::opt {
+
+/* DominatorTree
+ * Dominator tree of reachable blocks of a function, computed by the
+ * iterative algorithm of Cooper, Harvey & Kennedy. Blocks are numbered
+ * in reverse post order of the CFG, so passes can keep per-block data
+ * in vectors, the entry block is numbered 0. Dominance frontiers are
+ * computed along with the tree.
+ */
+class DominatorTree : public AnalysisResult {
+public:
+  using IndexList = std::vector<std::size_t>;
+
+  static constexpr const char *kName = "DominatorTree";
+
+  static constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+private:
+  mid::Blocks                                          _blocks;   // reverse post order
+  std::unordered_map<const mid::BasicBlock *, std::size_t> _ids;
+  IndexList                                            _idoms;
+  std::vector<IndexList>                               _children, _frontiers;
+  IndexList                                            _enter, _leave;  // DFS order of tree
+
+  void ComputeOrder(const mid::BlockPtr &entry);
+  void ComputeDominators();
+  void ComputeFrontiers();
+  void NumberTree();
+
+public:
+  explicit DominatorTree(const mid::FuncPtr &F);
+
+  // index of block, kNone if block is unreachable
+  std::size_t GetIndex(const mid::BasicBlock *block) const {
+    auto it = _ids.find(block);
+    return it != _ids.end() ? it->second : kNone;
+  }
+
+  bool IsReachable(const mid::BasicBlock *block) const {
+    return GetIndex(block) != kNone;
+  }
+
+  // immediate dominator of block, null for entry and unreachable blocks
+  mid::BlockPtr GetIDom(const mid::BasicBlock *block) const;
+
+  // check if 'lhs' dominates 'rhs', every block dominates itself
+  bool Dominates(const mid::BasicBlock *lhs, const mid::BasicBlock *rhs) const;
+
+  // getters, by index of block
+  const mid::Blocks &blocks()                  const { return _blocks;       }
+  std::size_t        size()                    const { return _blocks.size(); }
+  std::size_t        idom(std::size_t i)       const { return _idoms[i];     }
+  const IndexList   &children(std::size_t i)   const { return _children[i];  }
+  const IndexList   &frontier(std::size_t i)   const { return _frontiers[i]; }
+};
+
+}
+
+#endif //XY_LANG_DOMTREE_H
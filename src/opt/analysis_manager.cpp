@@ -0,0 +1,21 @@
+#include "opt/analysis_manager.h"
+
+namespace RJIT::opt {
+
+void AnalysisManager::Invalidate(const std::string &name, const mid::FuncPtr &F) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _results.find(F);
+  if (it != _results.end()) it->second.erase(name);
+}
+
+void AnalysisManager::Invalidate(const mid::FuncPtr &F) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _results.erase(F);
+}
+
+void AnalysisManager::Clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _results.clear();
+}
+
+}
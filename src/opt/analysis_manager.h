@@ -0,0 +1,68 @@
+#ifndef XY_LANG_ANALYSIS_MANAGER_H
+#define XY_LANG_ANALYSIS_MANAGER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "mid/ir/ssa.h"
+
+namespace RJIT::opt {
+
+// base class of results of analyses, a result type 'T' has a constructor
+// 'T(const FuncPtr &)' and a name 'T::kName' that is same as the name
+// of its analysis pass
+class AnalysisResult {
+public:
+  virtual ~AnalysisResult() = default;
+};
+
+/* AnalysisManager
+ * Cache of analysis results, keyed by analysis name and function.
+ * Results are computed on first query, and kept until the function is
+ * changed by a pass that invalidates them. Function passes may query
+ * results from worker threads, each function is only changed by one
+ * thread at a time.
+ */
+class AnalysisManager {
+private:
+  using ResultPtr = std::unique_ptr<AnalysisResult>;
+  using ResultMap = std::unordered_map<std::string, ResultPtr>;
+
+  std::mutex                                 _mutex;
+  std::unordered_map<mid::FuncPtr, ResultMap> _results;
+
+public:
+  // get result of analysis 'T' on function 'F'
+  template <typename T>
+  const T &Get(const mid::FuncPtr &F) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _results.find(F);
+      if (it != _results.end()) {
+        auto result = it->second.find(T::kName);
+        if (result != it->second.end()) return static_cast<const T &>(*result->second);
+      }
+    }
+    // compute without lock, other threads are working on other functions
+    auto result = std::make_unique<T>(F);
+    const auto &ref = *result;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _results[F][T::kName] = std::move(result);
+    return ref;
+  }
+
+  // drop result of analysis 'name' on function 'F'
+  void Invalidate(const std::string &name, const mid::FuncPtr &F);
+
+  // drop all results on function 'F'
+  void Invalidate(const mid::FuncPtr &F);
+
+  // drop all results
+  void Clear();
+};
+
+}
+
+#endif //XY_LANG_ANALYSIS_MANAGER_H
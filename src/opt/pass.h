@@ -1,6 +1,7 @@
 #ifndef XY_LANG_PASS_H
 #define XY_LANG_PASS_H
 
+#include <memory>
 #include <string>
 
 #include "mid/ir/ssa.h"
@@ -86,6 +87,17 @@ public:
   // not implement
   bool runOnModule(Module &M) final { return false; }
 
+  // Clone - Return a copy of this pass that can run on another thread at the
+  // same time, it should only share state that is safe to share. Passes
+  // return null by default, and are run on one function at a time.
+  virtual std::shared_ptr<FunctionPass> Clone() const { return nullptr; }
+
+  // getAnalysis - Get result of analysis 'T' on function 'F', it's computed
+  // on first use and cached by the pass manager until 'F' is changed by a
+  // pass that invalidates it.
+  template <typename T>
+  const T &getAnalysis(const FuncPtr &F);
+
   // doFinalization - Virtual method overriden by subclasses to do any post
   // processing needed after all passes have run.
   virtual bool doFinalization(Module &M) { return false; }
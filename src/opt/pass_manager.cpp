@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
 #include "lib/debug.h"
 #include "pass_manager.h"
 
@@ -27,46 +31,96 @@ bool PassManager::RunPass(PassNameSet &valid, const PassInfoPtr &info) {
   // check dependencies, run required passes first
   changed = RunRequiredPasses(valid, info);
   // run current pass
-  if (RunPass(info->pass())) {
+  auto &stats = _instance._stats[info->name()];
+  auto start = std::chrono::steady_clock::now();
+  bool pass_changed = RunPass(info->pass());
+  stats.seconds += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  ++stats.runs;
+  if (info->pass()->IsFunctionPass()) stats.functions += _instance._dirty.size();
+  if (pass_changed) {
     changed = true;
-    // invalidate passes
-    for (const auto &name : info->invalidated_passes()) {
-      InvalidatePass(valid, name);
-    }
+    ++stats.changes;
+    InvalidateResults(valid, info);
   }
   return changed;
 }
 
 
 bool PassManager::RunPass(const PassPtr &pass) {
-  bool changed = false;
-
+  _instance._pass_changed.clear();
   if (pass->IsModulePass()) {
-    changed = pass->runOnModule(module());
-  } else {
-    DBG_ASSERT(pass->IsFunctionPass(), "unknown pass class");
-    for (const auto &it : module().Functions()) {
-      auto func = std::static_pointer_cast<Function>(it);
-      changed = pass->runOnFunction(func);
+    // module passes are skipped if only run on one function
+    if (_instance._function || !pass->runOnModule(module())) return false;
+    // any function may be changed
+    _instance._pass_changed = module().Functions();
+    for (const auto &func : module().Functions()) _instance._changed.insert(func);
+    return true;
+  }
+  DBG_ASSERT(pass->IsFunctionPass(), "unknown pass class");
+  return RunOnFunctions(pass);
+}
+
+bool PassManager::RunOnFunctions(const PassPtr &pass) {
+  const auto &funcs = _instance._dirty;
+  auto func_pass = std::static_pointer_cast<FunctionPass>(pass);
+  const auto &pool = _instance._pool;
+  auto clone = pool && funcs.size() > 1 ? func_pass->Clone() : nullptr;
+
+  std::vector<char> changed(funcs.size(), false);
+  if (!clone) {
+    // pass can not be cloned, run on one function at a time
+    for (std::size_t i = 0; i < funcs.size(); ++i) {
+      changed[i] = pass->runOnFunction(funcs[i]);
     }
+  } else {
+    // one task per function, each worker runs its own copy of pass
+    std::vector<std::shared_ptr<FunctionPass>> passes(pool->size());
+    passes[0] = func_pass;
+    passes[1] = clone;
+    pool->ParallelFor(funcs.size(), [&](std::size_t i, std::size_t worker) {
+      auto &worker_pass = passes[worker];
+      if (!worker_pass) worker_pass = func_pass->Clone();
+      changed[i] = worker_pass->runOnFunction(funcs[i]);
+    });
   }
 
-  return changed;
+  bool any = false;
+  for (std::size_t i = 0; i < funcs.size(); ++i) {
+    if (!changed[i]) continue;
+    _instance._changed.insert(funcs[i]);
+    _instance._pass_changed.push_back(funcs[i]);
+    any = true;
+  }
+  return any;
 }
 
 void PassManager::RunPasses(const PassPtrList &passes) {
-  bool changed = true;
-  PassNameSet valid;
-
-  while (changed) {
-    changed = false;
-    valid.clear();
+  auto &inst = _instance;
+  if (inst._function) {
+    inst._dirty = {inst._function};
+  } else {
+    inst._dirty = module().Functions();
+  }
 
-    // run all passes
+  // passes may keep changing each other's result, so rounds are bounded
+  for (std::size_t round = 0; round < kMaxRounds && !inst._dirty.empty(); ++round) {
+    inst._changed.clear();
+    PassNameSet valid;
     for (const auto &it : passes) {
-      changed |= RunPass(valid, it);
+      RunPass(valid, it);
+    }
+    ++inst._rounds;
+
+    // keep order of functions in module
+    auto dirty = std::move(inst._dirty);
+    inst._dirty.clear();
+    for (const auto &func : dirty) {
+      if (inst._changed.count(func)) inst._dirty.push_back(func);
     }
   }
+  inst._dirty.clear();
+  inst._changed.clear();
 }
 
 bool PassManager::RunRequiredPasses(PassNameSet &valid, const PassInfoPtr &info) {
@@ -106,9 +160,32 @@ void PassManager::InvalidatePass(PassNameSet &valid, const std::string &name) {
   }
 }
 
+void PassManager::InvalidateResults(PassNameSet &valid, const PassInfoPtr &info) {
+  auto &analyses = _instance._analyses;
+  for (const auto &name : info->invalidated_passes()) {
+    InvalidatePass(valid, name);
+    for (const auto &func : _instance._pass_changed) analyses.Invalidate(name, func);
+  }
+  if (info->preserves_cfg()) return;
+
+  // all analyses depend on the CFG
+  for (const auto &[name, it] : GetPasses()) {
+    if (it->is_analysis()) InvalidatePass(valid, name);
+  }
+  for (const auto &func : _instance._pass_changed) analyses.Invalidate(func);
+}
+
 void PassManager::RunPasses() {
+  // passes need bodies of lazily loaded functions
+  if (_instance._function) {
+    if (!module().Materialize(_instance._function)) return;
+  } else if (!module().MaterializeAll()) {
+    return;
+  }
+
+  // iteration order of 'GetPasses' is unspecified, use the sorted list
   auto candidates = Candidates();
-  for (const auto &[_, info] : GetPasses()) {
+  for (const auto &info : GetPassList()) {
     if (!info->is_analysis() && opt_level() >= info->min_opt_level()) {
       candidates.push_back(info);
     }
@@ -116,13 +193,69 @@ void PassManager::RunPasses() {
   RunPasses(candidates);
 }
 
+void PassManager::RunPasses(const mid::FuncPtr &F) {
+  _instance._function = F;
+  RunPasses();
+  _instance._function = nullptr;
+}
+
+void PassManager::PrintStats(std::ostream &os) {
+  std::vector<std::pair<std::string, PassStats>> stats(_instance._stats.begin(),
+                                                       _instance._stats.end());
+  std::sort(stats.begin(), stats.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.second.seconds > rhs.second.seconds;
+  });
+
+  os << "===--- pass execution report ---===\n"
+     << "  rounds: " << _instance._rounds << "\n"
+     << "  time(ms)   runs  functions  changes  pass\n";
+  auto flags = os.flags();
+  for (const auto &[name, it] : stats) {
+    os << std::fixed << std::setprecision(3) << std::setw(10) << it.seconds * 1000
+       << std::setw(7) << it.runs << std::setw(11) << it.functions
+       << std::setw(9) << it.changes << "  " << name << "\n";
+  }
+  os.flags(flags);
+
+  // counters are sorted by name of pass
+  std::map<std::string, const PassStats *> sorted;
+  for (const auto &[name, it] : _instance._stats) {
+    if (!it.counters.empty()) sorted[name] = &it;
+  }
+  if (!sorted.empty()) os << "===--- pass statistics ---===\n";
+  for (const auto &[name, it] : sorted) {
+    for (const auto &[counter, value] : it->counters) {
+      os << std::setw(10) << value << "  " << name << " - " << counter << "\n";
+    }
+  }
+  os.flush();
+}
+
+void PassManager::AddCounter(const std::string &pass_name,
+                             const std::string &counter, std::size_t value) {
+  std::lock_guard<std::mutex> lock(_instance._stats_mutex);
+  _instance._stats[pass_name].counters[counter] += value;
+}
+
+void PassManager::SetThreads(std::size_t threads) {
+  if (!threads) threads = 1;
+  _instance._threads = threads;
+  _instance._pool.reset();
+  if (threads > 1) _instance._pool = std::make_unique<lib::ThreadPool>(threads);
+}
+
 void PassManager::init() {
   for (const auto &it : _factories) {
     auto pass = it->CreatePass(this);
     auto pass_name = pass->name();
     DBG_ASSERT(_pass_infos.find(pass_name) == _pass_infos.end(), "pass %s has been registered", pass_name.c_str());
     _pass_infos.insert(std::make_pair(pass_name, pass));
+    _pass_list.push_back(pass);
   }
+  std::stable_sort(_pass_list.begin(), _pass_list.end(),
+                   [](const PassInfoPtr &lhs, const PassInfoPtr &rhs) {
+                     return lhs->priority() < rhs->priority();
+                   });
 }
 
 }
\ No newline at end of file
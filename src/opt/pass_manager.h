@@ -2,11 +2,15 @@
 #define XY_LANG_PASS_MANAGER_H
 
 #include <map>
+#include <mutex>
+#include <ostream>
 #include <string_view>
 #include <unordered_set>
 #include <utility>
 
 #include "opt/pass.h"
+#include "opt/analysis_manager.h"
+#include "lib/threadpool.h"
 #include "mid/ir/module.h"
 
 namespace RJIT::opt {
@@ -22,6 +26,18 @@ using PassNameList    = std::vector<std::string>;
 using PassInfoMap     = std::unordered_map<std::string, PassInfoPtr>;
 using PassNameSet     = std::unordered_set<std::string>;
 using RequirementMap  = std::unordered_map<std::string, PassNameSet>;
+using FunctionSet     = std::unordered_set<mid::FuncPtr>;
+
+// statistics of a pass, collected by 'RunPasses'
+struct PassStats {
+  std::size_t runs      = 0;    // rounds that pass is run in
+  std::size_t functions = 0;    // functions that pass is run on
+  std::size_t changes   = 0;    // runs that changed the IR
+  double      seconds   = 0;
+  std::map<std::string, std::size_t> counters;  // reported by pass itself
+};
+
+using PassStatsMap    = std::unordered_map<std::string, PassStats>;
 
 // pass factory
 class PassFactory {
@@ -38,6 +54,8 @@ private:
   std::string   _pass_name;
   bool          _is_analysis;
   std::size_t   _min_opt_level;
+  std::size_t   _priority = 0;
+  bool          _preserves_cfg = false;
   PassNameList  _required_passes;
   PassNameList  _invalidated_passes;
 
@@ -65,12 +83,26 @@ public:
     _min_opt_level = min_opt_level;
     return *this;
   }
+  // set position of current pass in default pass list, passes with lower
+  // priority are run first, passes with same priority in registration order
+  PassInfo &set_priority(std::size_t priority) {
+    _priority = priority;
+    return *this;
+  }
+  // set if current pass never changes the CFG, so that analyses of the
+  // CFG are kept, otherwise all analyses of changed functions are dropped
+  PassInfo &set_preserves_cfg(bool preserves_cfg) {
+    _preserves_cfg = preserves_cfg;
+    return *this;
+  }
 
   // getter/setter
   const PassPtr &pass()          const { return _pass;          }
   std::string    name()          const { return _pass_name;     }
   bool           is_analysis()   const { return _is_analysis;   }
   std::size_t    min_opt_level() const { return _min_opt_level; }
+  std::size_t    priority()      const { return _priority;      }
+  bool           preserves_cfg() const { return _preserves_cfg; }
 
   const PassNameList &required_passes()    const { return _required_passes;    }
   const PassNameList &invalidated_passes() const { return _invalidated_passes; }
@@ -81,10 +113,24 @@ class PassManager {
 private:
   std::size_t     _opt_level;
   mid::Module    *_module;
+  mid::FuncPtr    _function;    // only run on this function if not null
   PassInfoMap     _pass_infos;
+  PassPtrList     _pass_list;   // all passes, sorted by priority
   RequirementMap  _requirements;
   PassPtrList     _candidates;
   PassFactoryList _factories;
+  std::size_t     _threads = 1;
+  std::unique_ptr<lib::ThreadPool> _pool;   // null if only one thread
+  mid::FunctionList _dirty;     // functions that passes run on in current round
+  FunctionSet     _changed;     // functions changed in current round
+  mid::FunctionList _pass_changed;  // functions changed by last pass
+  std::size_t     _rounds = 0;
+  PassStatsMap    _stats;
+  std::mutex      _stats_mutex; // passes may report counters from workers
+  AnalysisManager _analyses;
+
+  // passes are run again on changed functions at most this many rounds
+  static constexpr std::size_t kMaxRounds = 16;
 
   void AddFactory(const std::shared_ptr<PassFactory> &factory) {
     _factories.push_back(factory);
@@ -92,13 +138,16 @@ private:
 
   void init();
 
+  // run function pass on dirty functions, record changed functions
+  static bool RunOnFunctions(const PassPtr &pass);
+
 public:
   static PassManager _instance;
 
-  PassManager() : _opt_level(0), _module(nullptr) {}
+  PassManager() : _opt_level(0), _module(nullptr), _function(nullptr) {}
 
   explicit PassManager(mid::Module &module)
-    : _opt_level(0), _module(&module) {}
+    : _opt_level(0), _module(&module), _function(nullptr) {}
 
   static void Initialize() { _instance.init(); }
 
@@ -106,6 +155,9 @@ public:
 
   static PassInfoMap &GetPasses() { return _instance._pass_infos; }
 
+  // passes in the order that default pass list runs them
+  static const PassPtrList &GetPassList() { return _instance._pass_list; }
+
   static RequirementMap &GetRequiredBy() { return _instance._requirements; }
 
   static PassPtrList &Candidates() { return _instance._candidates; }
@@ -118,6 +170,9 @@ public:
   // invalidate the specific pass
   static void InvalidatePass(PassNameSet &valid, const std::string &name);
 
+  // invalidate analyses of functions changed by pass 'info'
+  static void InvalidateResults(PassNameSet &valid, const PassInfoPtr &info);
+
   // register pass
   static void RegisterPassFactory(const PassFactoryPtr &factory) {
     _instance.AddFactory(factory);
@@ -130,17 +185,44 @@ public:
   // returns true if changed
   static bool RunPass(PassNameSet &valid, const PassInfoPtr &info);
 
-  // run all passes
+  // run passes in rounds, each round only runs function passes on
+  // functions changed in last round, until no function is changed
   static void RunPasses(const PassPtrList &passes);
   static void RunPasses();
 
+  // run all function passes on function 'F' only, module passes are skipped
+  static void RunPasses(const mid::FuncPtr &F);
+
+  // add 'value' to counter 'counter' of pass 'pass_name', e.g. number of
+  // instructions removed, can be called from worker threads
+  static void AddCounter(const std::string &pass_name,
+                         const std::string &counter, std::size_t value);
+
+  // print statistics of all passes that have been run
+  static void PrintStats(std::ostream &os);
+
   // getter/setter
   static std::size_t  opt_level() { return _instance._opt_level; }
+  static std::size_t  threads()   { return _instance._threads;   }
   static mid::Module &module()    { return *_instance._module; }
+  static AnalysisManager &analyses() { return _instance._analyses; }
 
-  static void SetModule(mid::Module &module) { _instance._module = &module; }
+  static void SetModule(mid::Module &module) {
+    _instance._module = &module;
+    _instance._analyses.Clear();
+  }
+  static void SetOptLevel(std::size_t level) { _instance._opt_level = level; }
+
+  // run function passes that can be cloned on 'threads' threads,
+  // module passes are run after all functions are done
+  static void SetThreads(std::size_t threads);
 };
 
+template <typename T>
+const T &FunctionPass::getAnalysis(const FuncPtr &F) {
+  return PassManager::analyses().Get<T>(F);
+}
+
 template <typename PassClassFactory>
 class PassRegisterFactory {
 public:
@@ -0,0 +1,144 @@
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "opt/pass.h"
+#include "lib/debug.h"
+#include "mid/ir/castssa.h"
+#include "mid/ir/constant.h"
+#include "opt/pass_manager.h"
+
+int ADCE;
+
+namespace RJIT::opt {
+
+/*
+  aggressive dead code elimination, instructions are assumed dead until
+  proved live: roots (terminators, calls, stores that may be read later
+  and divisions that may trap) are live, and so are operands of live
+  instructions. All other instructions are removed, including variables
+  that are only stored to
+
+  e.g.
+    entry:                              entry:
+      %x = alloca i32                     %0 = load i32, %a
+      store 1, %x                         %1 = icmp sgt i32 %0, 0
+      %0 = load i32, %a                   br %1, %if.then, %if.end
+      %1 = icmp sgt i32 %0, 0     ==>>
+      %2 = load i32, %a
+      %3 = icmp sgt i32 %2, 0
+      br %1, %if.then, %if.end
+*/
+class ADCE : public FunctionPass {
+private:
+  std::unordered_set<Instruction *>   _live;
+  std::vector<Instruction *>          _worklist;
+  std::unordered_map<SSAPtr, bool>    _write_only;  // cache of 'IsWriteOnly'
+
+  // check if 'ptr' is a local variable that is never read
+  bool IsWriteOnly(const SSAPtr &ptr) {
+    if (!ptr->isInstruction() ||
+        static_cast<Instruction *>(ptr)->opcode() != Instruction::Alloca) {
+      return false;
+    }
+    auto it = _write_only.find(ptr);
+    if (it != _write_only.end()) return it->second;
+
+    bool write_only = true;
+    for (const auto &use : ptr->uses()) {
+      auto user = use->getUser();
+      // address may escape if it's stored
+      if (!user->isInstruction() ||
+          static_cast<Instruction *>(user)->opcode() != Instruction::Store ||
+          static_cast<StoreInst *>(user)->value() == ptr) {
+        write_only = false;
+        break;
+      }
+    }
+    _write_only[ptr] = write_only;
+    return write_only;
+  }
+
+  // divisions trap at runtime unless divisor is a known safe constant
+  static bool MayTrap(Instruction *inst) {
+    bool is_signed = inst->opcode() == Instruction::SDiv ||
+                     inst->opcode() == Instruction::SRem;
+    if (!is_signed && inst->opcode() != Instruction::UDiv &&
+        inst->opcode() != Instruction::URem) {
+      return false;
+    }
+    auto divisor = dynamic_cast<ConstantInt *>((*inst)[1].get());
+    return !divisor || divisor->IsZero() || (is_signed && divisor->value() == ~0u);
+  }
+
+  bool IsRoot(Instruction *inst) {
+    switch (inst->opcode()) {
+      case Instruction::Store:
+        return !IsWriteOnly(static_cast<StoreInst *>(inst)->pointer());
+      case Instruction::Call:
+        return true;
+      default:
+        return inst->isTerminator() || MayTrap(inst);
+    }
+  }
+
+  void MarkLive(Instruction *inst) {
+    if (_live.insert(inst).second) _worklist.push_back(inst);
+  }
+
+public:
+  bool runOnFunction(const FuncPtr &F) final {
+    _live.clear();
+    _worklist.clear();
+    _write_only.clear();
+
+    // mark roots
+    for (const auto &it : *F) {
+      for (const auto &inst : CastTo<BasicBlock>(it.get())->insts()) {
+        if (IsRoot(inst)) MarkLive(inst);
+      }
+    }
+
+    // operands of live instructions are live
+    while (!_worklist.empty()) {
+      auto inst = _worklist.back();
+      _worklist.pop_back();
+      for (const auto &use : *inst) {
+        auto value = use.get();
+        if (value && value->isInstruction()) MarkLive(static_cast<Instruction *>(value));
+      }
+    }
+
+    // dead instructions are only used by dead instructions, so drop all
+    // references before removing them
+    std::vector<Instruction *> dead;
+    for (const auto &it : *F) {
+      for (const auto &inst : CastTo<BasicBlock>(it.get())->insts()) {
+        if (!_live.count(inst)) dead.push_back(inst);
+      }
+    }
+    if (dead.empty()) return false;
+    for (const auto &inst : dead) inst->DropAllReferences();
+    for (const auto &inst : dead) inst->GetParent()->insts().remove(inst);
+    PassManager::AddCounter("ADCE", "instructions removed", dead.size());
+    return true;
+  }
+
+  std::shared_ptr<FunctionPass> Clone() const final {
+    return std::make_shared<ADCE>();
+  }
+};
+
+class ADCEFactory : public PassFactory {
+public:
+  PassInfoPtr CreatePass(PassManager *) override {
+    auto pass = std::make_shared<ADCE>();
+    auto passinfo = std::make_shared<PassInfo>(pass, "ADCE", false, 1);
+    passinfo->set_priority(40).set_preserves_cfg(true);
+    return passinfo;
+  }
+};
+
+static PassRegisterFactory<ADCEFactory> registry;
+
+}
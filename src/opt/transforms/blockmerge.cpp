@@ -32,7 +32,7 @@ private:
 public:
   bool runOnFunction(const FuncPtr &F) final {
     _changed = false;
-    SSAPtr entry;
+    SSAPtr entry = nullptr;
     for (auto &it : *F) {
       if (entry == nullptr) entry = it.get();
       auto block = CastTo<BasicBlock>(it.get());
@@ -79,14 +79,29 @@ public:
     return _changed;
   }
 
+  std::shared_ptr<FunctionPass> Clone() const final {
+    return std::make_shared<BlockMerge>();
+  }
+
   void MergeBlocks(const BlockPtr &pred, const BlockPtr &succ) {
 
     auto &insts = pred->insts();
     // remove jump instruction
+    auto jump = insts.back();
     insts.pop_back();
+    jump->DropAllReferences();
+
+    // phi nodes of successor have only one incoming value
+    auto &succ_insts = succ->insts();
+    while (!succ_insts.empty() && succ_insts.front()->opcode() == Instruction::PHI) {
+      auto phi = static_cast<PHINode *>(succ_insts.front());
+      succ_insts.erase(succ_insts.begin());
+      phi->ReplaceBy(phi->GetIncomingValue(0));
+      phi->DropAllReferences();
+    }
 
     // move successor's instructions into predecessor
-    insts.insert(pred->inst_end(), succ->inst_begin(), succ->inst_end());
+    insts.splice(pred->inst_end(), succ->insts());
 
   }
 };
@@ -96,6 +111,7 @@ public:
   PassInfoPtr CreatePass(PassManager *) override {
     auto pass = std::make_shared<BlockMerge>();
     auto passinfo =  std::make_shared<PassInfo>(pass, "BlockMerge", false, false);
+    passinfo->set_priority(50);
     return passinfo;
   }
 };
@@ -0,0 +1,237 @@
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "opt/pass.h"
+#include "lib/debug.h"
+#include "mid/ir/castssa.h"
+#include "mid/ir/constant.h"
+#include "opt/analysis/domtree.h"
+#include "opt/pass_manager.h"
+
+int GVN;
+
+namespace RJIT::opt {
+
+namespace {
+
+// expression computed by an instruction, operands are value numbers
+struct Expression {
+  unsigned    opcode;
+  unsigned    pred;         // operator of 'icmp'
+  SSAPtr      lhs, rhs;
+  unsigned    type;         // see 'TypeClass'
+  std::size_t generation;   // memory state of loads
+
+  bool operator==(const Expression &rhs_expr) const {
+    return opcode == rhs_expr.opcode && pred == rhs_expr.pred &&
+           lhs == rhs_expr.lhs && rhs == rhs_expr.rhs &&
+           type == rhs_expr.type && generation == rhs_expr.generation;
+  }
+};
+
+struct ExpressionHash {
+  std::size_t operator()(const Expression &expr) const {
+    std::size_t hash = std::hash<SSAPtr>()(expr.lhs);
+    auto combine = [&hash](std::size_t value) {
+      hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    combine(std::hash<SSAPtr>()(expr.rhs));
+    combine(expr.opcode << 16 | expr.pred << 8 | expr.type);
+    combine(expr.generation);
+    return hash;
+  }
+};
+
+// values with same bits but different types are not interchangeable
+// for back ends, so types are compared by size and signedness
+unsigned TypeClass(const TYPE::TypeInfoPtr &type) {
+  return type->GetSize() << 3 | type->IsUnsigned() << 2 | type->IsBool() << 1 |
+         type->IsPointer();
+}
+
+bool IsCommutative(unsigned opcode) {
+  return opcode == Instruction::Add || opcode == Instruction::Mul ||
+         opcode == Instruction::And || opcode == Instruction::Or ||
+         opcode == Instruction::Xor;
+}
+
+// operator of 'rhs op lhs' that is same as 'lhs op rhs'
+AST::Operator SwapOperator(AST::Operator op) {
+  using AST::Operator;
+  switch (op) {
+    case Operator::SLess:    return Operator::SGreat;
+    case Operator::SLessEq:  return Operator::SGreatEq;
+    case Operator::SGreat:   return Operator::SLess;
+    case Operator::SGreatEq: return Operator::SLessEq;
+    case Operator::ULess:    return Operator::UGreat;
+    case Operator::ULessEq:  return Operator::UGreatEq;
+    case Operator::UGreat:   return Operator::ULess;
+    case Operator::UGreatEq: return Operator::ULessEq;
+    default:                 return op;
+  }
+}
+
+}
+
+/*
+  global value numbering, instructions are visited in dominator tree
+  order, an instruction that computes the same expression as a dominating
+  one is replaced by it (scoped hash table, as EarlyCSE in LLVM)
+
+  e.g.
+    while.cond: ; preds: ...            while.cond: ; preds: ...
+      %0 = add i32 %x, %y                 %0 = add i32 %x, %y
+      %1 = icmp slt i32 %0, %n            %1 = icmp slt i32 %0, %n
+      br %1, %body, %end          ==>>    br %1, %body, %end
+    body: ; preds: while.cond           body: ; preds: while.cond
+      %2 = add i32 %y, %x                 call @f(i32 %0)
+      call @f(i32 %2)
+
+  loads are reused only if no store or call may write memory between
+  them, so the pass works on variables that are not promoted as well
+*/
+class GVN : public FunctionPass {
+private:
+  const DominatorTree                                        *_tree;
+  std::unordered_map<Expression, SSAPtr, ExpressionHash>      _table;
+  std::vector<Expression>                                    _scope;      // keys added in order
+  std::unordered_map<unsigned, SSAPtr>                        _constants;  // value -> number
+  std::size_t                                                _generation, _last_generation;
+  std::size_t                                                _eliminated, _loads;
+
+  // memory state after a write, or at a block that is not only reached
+  // from its immediate dominator
+  std::size_t NewGeneration() { return ++_last_generation; }
+
+  // value number of operand, constants with same value are same
+  SSAPtr Number(const SSAPtr &value) {
+    auto cint = dynamic_cast<ConstantInt *>(value);
+    if (!cint) return value;
+    return _constants.insert({cint->value(), value}).first->second;
+  }
+
+  // get expression of instruction, return false if not supported
+  bool GetExpression(Instruction *inst, Expression &expr) {
+    if (!inst->type()) return false;
+    expr = {inst->opcode(), 0, nullptr, nullptr, TypeClass(inst->type()), 0};
+    if (inst->isBinaryOp()) {
+      expr.lhs = Number((*inst)[0].get());
+      expr.rhs = Number((*inst)[1].get());
+      if (IsCommutative(expr.opcode) && std::less<SSAPtr>()(expr.rhs, expr.lhs)) {
+        std::swap(expr.lhs, expr.rhs);
+      }
+    } else if (inst->opcode() == Instruction::ICmp) {
+      auto icmp = static_cast<ICmpInst *>(inst);
+      auto op = icmp->op();
+      expr.lhs = Number(icmp->LHS());
+      expr.rhs = Number(icmp->RHS());
+      if (std::less<SSAPtr>()(expr.rhs, expr.lhs)) {
+        std::swap(expr.lhs, expr.rhs);
+        op = SwapOperator(op);
+      }
+      expr.pred = static_cast<unsigned>(op);
+    } else if (inst->opcode() == Instruction::Load) {
+      expr.lhs = Number(static_cast<LoadInst *>(inst)->Pointer());
+      expr.generation = _generation;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void VisitBlock(const BlockPtr &block) {
+    auto &insts = block->insts();
+    for (auto it = insts.begin(); it != insts.end();) {
+      auto inst = *it;
+      if (inst->opcode() == Instruction::Store || inst->opcode() == Instruction::Call) {
+        // memory may be changed
+        _generation = NewGeneration();
+      }
+
+      Expression expr;
+      if (!GetExpression(inst, expr)) {
+        ++it;
+        continue;
+      }
+      auto leader = _table.find(expr);
+      if (leader == _table.end()) {
+        _table.insert({expr, inst});
+        _scope.push_back(expr);
+        ++it;
+        continue;
+      }
+
+      // redundant instruction
+      inst->ReplaceBy(leader->second);
+      it = insts.erase(it);
+      inst->DropAllReferences();
+      ++_eliminated;
+      if (expr.opcode == Instruction::Load) ++_loads;
+    }
+  }
+
+public:
+  bool runOnFunction(const FuncPtr &F) final {
+    if (F->empty()) return false;
+    _tree = &getAnalysis<DominatorTree>(F);
+    _table.clear();
+    _scope.clear();
+    _constants.clear();
+    _generation = _last_generation = 0;
+    _eliminated = _loads = 0;
+
+    // walk dominator tree, blocks keep table and memory state of their
+    // immediate dominators, second of pair is true when leaving the block
+    std::vector<std::size_t> scope_size(_tree->size()), generation(_tree->size());
+    std::vector<std::pair<std::size_t, bool>> stack = {{0, false}};
+    while (!stack.empty()) {
+      auto [b, leave] = stack.back();
+      stack.pop_back();
+      if (leave) {
+        for (; _scope.size() > scope_size[b]; _scope.pop_back()) {
+          _table.erase(_scope.back());
+        }
+        continue;
+      }
+
+      auto block = _tree->blocks()[b];
+      scope_size[b] = _scope.size();
+      if (b && block->size() == 1) {
+        _generation = generation[_tree->idom(b)];
+      } else {
+        _generation = NewGeneration();
+      }
+      VisitBlock(block);
+      generation[b] = _generation;
+
+      stack.push_back({b, true});
+      for (auto child : _tree->children(b)) stack.push_back({child, false});
+    }
+
+    if (!_eliminated) return false;
+    PassManager::AddCounter("GVN", "instructions eliminated", _eliminated);
+    if (_loads) PassManager::AddCounter("GVN", "loads eliminated", _loads);
+    return true;
+  }
+
+  std::shared_ptr<FunctionPass> Clone() const final {
+    return std::make_shared<GVN>();
+  }
+};
+
+class GVNFactory : public PassFactory {
+public:
+  PassInfoPtr CreatePass(PassManager *) override {
+    auto pass = std::make_shared<GVN>();
+    auto passinfo = std::make_shared<PassInfo>(pass, "GVN", false, 1);
+    passinfo->Requires(DominatorTree::kName).set_priority(30).set_preserves_cfg(true);
+    return passinfo;
+  }
+};
+
+static PassRegisterFactory<GVNFactory> registry;
+
+}
@@ -13,7 +13,7 @@ public:
   bool runOnModule(Module &M) final {
     for (const auto &func : M.Functions()) {
       std::cout << "Hi! "
-                << std::static_pointer_cast<Function>(func)->GetFunctionName()
+                << func->GetFunctionName()
                 << std::endl;
     }
     return false;
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "opt/pass.h"
+#include "lib/debug.h"
+#include "mid/ir/castssa.h"
+#include "mid/ir/constant.h"
+#include "opt/analysis/domtree.h"
+#include "opt/pass_manager.h"
+
+int Mem2Reg;
+
+namespace RJIT::opt {
+
+namespace {
+
+// size of a value in memory, same as back ends
+std::size_t MemSize(const TYPE::TypeInfoPtr &type) {
+  if (type->IsPointer()) return 8;
+  return type->GetSize() == 1 ? 1 : 4;
+}
+
+bool IsSigned(const TYPE::TypeInfoPtr &type) {
+  return !type->IsUnsigned() && !type->IsBool();
+}
+
+// check if loading 'var' after storing 'value' to it gives 'value' back
+bool IsExactStore(const TYPE::TypeInfoPtr &var, const SSAPtr &value) {
+  auto size = MemSize(var);
+  if (auto cint = dynamic_cast<ConstantInt *>(value)) {
+    if (size != 1) return true;
+    auto byte = static_cast<uint8_t>(cint->value());
+    unsigned loaded = IsSigned(var) ? static_cast<unsigned>(static_cast<int8_t>(byte))
+                                    : byte;
+    return loaded == cint->value();
+  }
+  if (!value->type()) return false;
+  auto value_size = MemSize(value->type());
+  // 8-bit values are kept extended to 32 bits
+  if (size == 4) return value_size != 8;
+  return value_size == size &&
+         (size != 1 || IsSigned(value->type()) == IsSigned(var));
+}
+
+}
+
+/*
+  promote local variables that are only accessed by load/store to SSA
+  values, phi nodes are placed at iterated dominance frontiers of stores,
+  then loads are renamed in dominator tree order (Cytron et al.)
+
+  e.g.
+    entry:                              entry:
+      %x = alloca i32                     br %0, %if.then, %if.end
+      store 1, %x                       if.then: ; preds: entry
+      br %0, %if.then, %if.end            jump %if.end
+    if.then: ; preds: entry       ==>>  if.end: ; preds: entry, if.then
+      store 2, %x                         %2 = phi i32 [ 1, %entry ], [ 2, %if.then ]
+      jump %if.end                        ret %2
+    if.end: ; preds: entry, if.then
+      %1 = load i32, %x
+      ret %1
+
+  only reachable blocks are renamed, variables read before written are
+  zero
+*/
+class Mem2Reg : public FunctionPass {
+private:
+  const DominatorTree                      *_tree;
+  std::vector<AllocaInst *>                 _allocas;
+  std::unordered_map<SSAPtr, std::size_t>   _var_ids;   // index in '_allocas'
+  std::unordered_map<SSAPtr, std::size_t>   _phis;      // phi -> variable
+  std::vector<SSAPtr>                       _zeros;     // initial values
+
+  bool IsPromotable(AllocaInst *alloca) {
+    auto var = alloca->type() ? alloca->type()->GetDereferenceType() : nullptr;
+    if (!var) return false;
+    for (const auto &use : alloca->uses()) {
+      auto user = use->getUser();
+      if (!user->isInstruction()) return false;
+      auto inst = static_cast<Instruction *>(user);
+      if (inst->opcode() == Instruction::Load) {
+        if (!inst->type() || MemSize(inst->type()) != MemSize(var) ||
+            IsSigned(inst->type()) != IsSigned(var)) {
+          return false;
+        }
+      } else if (inst->opcode() == Instruction::Store) {
+        auto store = static_cast<StoreInst *>(inst);
+        if (store->value() == alloca || !IsExactStore(var, store->value())) {
+          return false;
+        }
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void CollectAllocas() {
+    _allocas.clear();
+    _var_ids.clear();
+    _zeros.clear();
+    for (const auto &block : _tree->blocks()) {
+      for (const auto &inst : block->insts()) {
+        if (inst->opcode() != Instruction::Alloca) continue;
+        auto alloca = static_cast<AllocaInst *>(inst);
+        if (!IsPromotable(alloca)) continue;
+        _var_ids[alloca] = _allocas.size();
+        _allocas.push_back(alloca);
+        _zeros.push_back(nullptr);
+      }
+    }
+  }
+
+  void InsertPhis() {
+    _phis.clear();
+    for (std::size_t v = 0; v < _allocas.size(); ++v) {
+      auto alloca = _allocas[v];
+      std::vector<bool> has_phi(_tree->size()), is_def(_tree->size());
+      std::vector<std::size_t> worklist;
+      for (const auto &use : alloca->uses()) {
+        auto inst = static_cast<Instruction *>(use->getUser());
+        auto b = _tree->GetIndex(inst->GetParent());
+        if (inst->opcode() != Instruction::Store || b == DominatorTree::kNone) continue;
+        if (!is_def[b]) worklist.push_back(b);
+        is_def[b] = true;
+      }
+
+      while (!worklist.empty()) {
+        auto b = worklist.back();
+        worklist.pop_back();
+        for (auto d : _tree->frontier(b)) {
+          if (has_phi[d]) continue;
+          has_phi[d] = true;
+          auto phi = PassManager::module().New<PHINode>();
+          phi->set_type(alloca->type()->GetDereferenceType());
+          phi->set_loc(alloca->loc());
+          auto &insts = _tree->blocks()[d]->insts();
+          insts.insert(insts.begin(), phi);
+          _phis[phi] = v;
+          if (!is_def[d]) worklist.push_back(d);
+        }
+      }
+    }
+  }
+
+  SSAPtr ZeroOf(std::size_t v) {
+    if (!_zeros[v]) {
+      auto zero = PassManager::module().New<ConstantInt>(0);
+      zero->set_type(TYPE::MakeConst(_allocas[v]->type()->GetDereferenceType()));
+      _zeros[v] = zero;
+    }
+    return _zeros[v];
+  }
+
+  void Rename() {
+    std::vector<std::vector<SSAPtr>> values(_allocas.size());
+    auto current = [&](std::size_t v) {
+      return values[v].empty() ? ZeroOf(v) : values[v].back();
+    };
+
+    // walk dominator tree, second of pair is true when leaving the block
+    std::vector<std::vector<std::size_t>> defined(_tree->size());
+    std::vector<std::pair<std::size_t, bool>> stack = {{0, false}};
+    while (!stack.empty()) {
+      auto [b, leave] = stack.back();
+      stack.pop_back();
+      if (leave) {
+        for (auto v : defined[b]) values[v].pop_back();
+        continue;
+      }
+
+      auto block = _tree->blocks()[b];
+      auto &insts = block->insts();
+      for (auto it = insts.begin(); it != insts.end();) {
+        auto inst = *it;
+        auto phi = _phis.find(inst);
+        if (phi != _phis.end()) {
+          values[phi->second].push_back(inst);
+          defined[b].push_back(phi->second);
+        } else if (inst->opcode() == Instruction::Load) {
+          auto var = _var_ids.find(static_cast<LoadInst *>(inst)->Pointer());
+          if (var != _var_ids.end()) {
+            inst->ReplaceBy(current(var->second));
+            it = insts.erase(it);
+            inst->DropAllReferences();
+            continue;
+          }
+        } else if (inst->opcode() == Instruction::Store) {
+          auto store = static_cast<StoreInst *>(inst);
+          auto var = _var_ids.find(store->pointer());
+          if (var != _var_ids.end()) {
+            values[var->second].push_back(store->value());
+            defined[b].push_back(var->second);
+            it = insts.erase(it);
+            inst->DropAllReferences();
+            continue;
+          }
+        }
+        ++it;
+      }
+
+      for (const auto &succ : GetSuccessors(block)) {
+        for (const auto &inst : succ->insts()) {
+          auto phi = _phis.find(inst);
+          if (phi == _phis.end()) break;
+          static_cast<PHINode *>(inst)->AddIncoming(current(phi->second), block);
+        }
+      }
+
+      stack.push_back({b, true});
+      for (auto child : _tree->children(b)) stack.push_back({child, false});
+    }
+  }
+
+  // remove phi nodes that are only used by themselves
+  void RemoveDeadPhis() {
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (auto it = _phis.begin(); it != _phis.end();) {
+        auto phi = static_cast<PHINode *>(it->first);
+        bool used = std::any_of(phi->uses().begin(), phi->uses().end(),
+                                [phi](Use *use) { return use->getUser() != phi; });
+        if (used) {
+          ++it;
+          continue;
+        }
+        phi->GetParent()->insts().remove(phi);
+        phi->DropAllReferences();
+        it = _phis.erase(it);
+        changed = true;
+      }
+    }
+  }
+
+  // remove accesses in unreachable blocks, then variables themselves
+  void RemoveAllocas() {
+    for (std::size_t v = 0; v < _allocas.size(); ++v) {
+      auto alloca = _allocas[v];
+      while (!alloca->uses().empty()) {
+        auto inst = static_cast<Instruction *>(alloca->uses().front()->getUser());
+        if (inst->opcode() == Instruction::Load) inst->ReplaceBy(ZeroOf(v));
+        inst->GetParent()->insts().remove(inst);
+        inst->DropAllReferences();
+      }
+      alloca->GetParent()->insts().remove(alloca);
+    }
+  }
+
+public:
+  bool runOnFunction(const FuncPtr &F) final {
+    if (F->empty()) return false;
+    _tree = &getAnalysis<DominatorTree>(F);
+    CollectAllocas();
+    if (_allocas.empty()) return false;
+
+    InsertPhis();
+    Rename();
+    RemoveDeadPhis();
+    RemoveAllocas();
+    PassManager::AddCounter("Mem2Reg", "allocas promoted", _allocas.size());
+    if (!_phis.empty()) {
+      PassManager::AddCounter("Mem2Reg", "phi nodes inserted", _phis.size());
+    }
+    return true;
+  }
+
+  std::shared_ptr<FunctionPass> Clone() const final {
+    return std::make_shared<Mem2Reg>();
+  }
+};
+
+class Mem2RegFactory : public PassFactory {
+public:
+  PassInfoPtr CreatePass(PassManager *) override {
+    auto pass = std::make_shared<Mem2Reg>();
+    auto passinfo = std::make_shared<PassInfo>(pass, "Mem2Reg", false, 1);
+    passinfo->Requires(DominatorTree::kName).set_priority(10).set_preserves_cfg(true);
+    return passinfo;
+  }
+};
+
+static PassRegisterFactory<Mem2RegFactory> registry;
+
+}
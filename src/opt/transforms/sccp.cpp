@@ -0,0 +1,380 @@
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "opt/pass.h"
+#include "lib/debug.h"
+#include "mid/ir/castssa.h"
+#include "mid/ir/constant.h"
+#include "opt/pass_manager.h"
+
+int SCCP;
+
+namespace RJIT::opt {
+
+namespace {
+
+// lattice value of SSA values, undefined values may still become any
+// constant, overdefined values are not constants
+struct LatticeValue {
+  enum State { Undefined, Constant, Overdefined };
+
+  State    state = Undefined;
+  uint32_t value = 0;
+
+  bool operator==(const LatticeValue &rhs) const {
+    return state == rhs.state && (state != Constant || value == rhs.value);
+  }
+  bool operator!=(const LatticeValue &rhs) const { return !(*this == rhs); }
+};
+
+LatticeValue MakeConstant(uint32_t value) {
+  return {LatticeValue::Constant, value};
+}
+
+LatticeValue Meet(const LatticeValue &lhs, const LatticeValue &rhs) {
+  if (lhs.state == LatticeValue::Undefined) return rhs;
+  if (rhs.state == LatticeValue::Undefined) return lhs;
+  if (lhs == rhs) return lhs;
+  return {LatticeValue::Overdefined, 0};
+}
+
+// evaluate binary operator as back ends do, operands are 32-bit values,
+// return false if operation traps at runtime
+bool FoldBinary(unsigned opcode, uint32_t lhs, uint32_t rhs, uint32_t &result) {
+  auto slhs = static_cast<int32_t>(lhs), srhs = static_cast<int32_t>(rhs);
+  bool is_div = opcode == Instruction::UDiv || opcode == Instruction::SDiv ||
+                opcode == Instruction::URem || opcode == Instruction::SRem;
+  bool is_sdiv = opcode == Instruction::SDiv || opcode == Instruction::SRem;
+  if (is_div && !rhs) return false;
+  if (is_sdiv && srhs == -1 && slhs == INT32_MIN) return false;
+  switch (opcode) {
+    case Instruction::Add:  result = lhs + rhs; break;
+    case Instruction::Sub:  result = lhs - rhs; break;
+    case Instruction::Mul:  result = lhs * rhs; break;
+    case Instruction::UDiv: result = lhs / rhs; break;
+    case Instruction::SDiv: result = static_cast<uint32_t>(slhs / srhs); break;
+    case Instruction::URem: result = lhs % rhs; break;
+    case Instruction::SRem: result = static_cast<uint32_t>(slhs % srhs); break;
+    // shift count is masked as x86 does
+    case Instruction::Shl:  result = lhs << (rhs & 31); break;
+    case Instruction::LShr: result = lhs >> (rhs & 31); break;
+    case Instruction::AShr: result = static_cast<uint32_t>(slhs >> (rhs & 31)); break;
+    case Instruction::And:  result = lhs & rhs; break;
+    case Instruction::Or:   result = lhs | rhs; break;
+    case Instruction::Xor:  result = lhs ^ rhs; break;
+    default: return false;
+  }
+  return true;
+}
+
+bool FoldCompare(AST::Operator op, uint32_t lhs, uint32_t rhs, uint32_t &result) {
+  using AST::Operator;
+  auto slhs = static_cast<int32_t>(lhs), srhs = static_cast<int32_t>(rhs);
+  switch (op) {
+    case Operator::Equal:    result = lhs == rhs;   break;
+    case Operator::NotEqual: result = lhs != rhs;   break;
+    case Operator::SLess:    result = slhs < srhs;  break;
+    case Operator::SLessEq:  result = slhs <= srhs; break;
+    case Operator::SGreat:   result = slhs > srhs;  break;
+    case Operator::SGreatEq: result = slhs >= srhs; break;
+    case Operator::ULess:    result = lhs < rhs;    break;
+    case Operator::ULessEq:  result = lhs <= rhs;   break;
+    case Operator::UGreat:   result = lhs > rhs;    break;
+    case Operator::UGreatEq: result = lhs >= rhs;   break;
+    default: return false;
+  }
+  return true;
+}
+
+}
+
+/*
+  sparse conditional constant propagation (Wegman & Zadeck), values are
+  propagated only along CFG edges that may be executed, so constants are
+  found through branches and phi nodes. Constant instructions are folded,
+  branches with constant conditions are replaced by jumps, blocks that are
+  never executed are removed, and 'BlockMerge' merges the jumps left
+
+  e.g.
+    entry:                              entry:
+      %0 = mul i32 2, 3                   jump %if.then
+      %1 = icmp slt i32 %0, 10          if.then: ; preds: entry
+      br %1, %if.then, %if.end    ==>>    jump %if.end
+    if.then: ; preds: entry             if.end: ; preds: if.then
+      jump %if.end                        ret 12
+    if.end: ; preds: entry, if.then
+      %2 = phi i32 [ %0, %entry ], [ 12, %if.then ]
+      ret %2
+
+  divisions that trap at runtime are not folded
+*/
+class SCCP : public FunctionPass {
+private:
+  std::unordered_map<SSAPtr, LatticeValue>   _values;
+  std::set<std::pair<BlockPtr, BlockPtr>>     _edges;       // executable edges
+  std::unordered_set<BlockPtr>                _executable;  // executable blocks
+  std::vector<BlockPtr>                       _block_list;
+  std::vector<Instruction *>                  _inst_list;
+
+  LatticeValue GetValue(const SSAPtr &value) const {
+    if (auto cint = dynamic_cast<ConstantInt *>(value)) {
+      return MakeConstant(cint->value());
+    }
+    // arguments, globals and so on are not known
+    if (!value->isInstruction()) return {LatticeValue::Overdefined, 0};
+    auto it = _values.find(value);
+    return it != _values.end() ? it->second : LatticeValue();
+  }
+
+  void SetValue(Instruction *inst, const LatticeValue &value) {
+    auto &old = _values[inst];
+    if (old == value) return;
+    old = value;
+    // revisit users
+    for (const auto &use : inst->uses()) {
+      auto user = use->getUser();
+      if (user->isInstruction()) _inst_list.push_back(static_cast<Instruction *>(user));
+    }
+  }
+
+  void MarkEdge(const BlockPtr &from, const BlockPtr &to) {
+    if (!_edges.insert({from, to}).second) return;
+    if (_executable.insert(to).second) {
+      _block_list.push_back(to);
+      return;
+    }
+    // incoming values of phi nodes are changed
+    for (const auto &inst : to->insts()) {
+      if (inst->opcode() != Instruction::PHI) break;
+      _inst_list.push_back(inst);
+    }
+  }
+
+  void VisitPHI(PHINode *phi) {
+    auto block = phi->GetParent();
+    LatticeValue value;
+    for (unsigned i = 0; i < phi->GetIncomingNum(); ++i) {
+      if (!_edges.count({phi->GetIncomingBlock(i), block})) continue;
+      value = Meet(value, GetValue(phi->GetIncomingValue(i)));
+    }
+    SetValue(phi, value);
+  }
+
+  void VisitBinary(Instruction *inst, const SSAPtr &lhs, const SSAPtr &rhs) {
+    auto l = GetValue(lhs), r = GetValue(rhs);
+    if (l.state == LatticeValue::Overdefined || r.state == LatticeValue::Overdefined) {
+      SetValue(inst, {LatticeValue::Overdefined, 0});
+      return;
+    }
+    if (l.state == LatticeValue::Undefined || r.state == LatticeValue::Undefined) return;
+
+    uint32_t result;
+    bool folded;
+    if (inst->opcode() == Instruction::ICmp) {
+      folded = FoldCompare(static_cast<ICmpInst *>(inst)->op(), l.value, r.value, result);
+    } else {
+      folded = FoldBinary(inst->opcode(), l.value, r.value, result);
+    }
+    SetValue(inst, folded ? MakeConstant(result) : LatticeValue{LatticeValue::Overdefined, 0});
+  }
+
+  void VisitBranch(BranchInst *br) {
+    auto block = br->GetParent();
+    auto cond = GetValue(br->cond());
+    auto true_block = CastTo<BasicBlock>(br->true_block());
+    auto false_block = CastTo<BasicBlock>(br->false_block());
+    if (cond.state == LatticeValue::Undefined) return;
+    if (cond.state == LatticeValue::Overdefined || cond.value) MarkEdge(block, true_block);
+    if (cond.state == LatticeValue::Overdefined || !cond.value) MarkEdge(block, false_block);
+  }
+
+  void Visit(Instruction *inst) {
+    switch (inst->opcode()) {
+      case Instruction::PHI:
+        VisitPHI(static_cast<PHINode *>(inst));
+        break;
+      case Instruction::ICmp: {
+        auto icmp = static_cast<ICmpInst *>(inst);
+        VisitBinary(icmp, icmp->LHS(), icmp->RHS());
+        break;
+      }
+      case Instruction::Br:
+        VisitBranch(static_cast<BranchInst *>(inst));
+        break;
+      case Instruction::Jmp:
+        MarkEdge(inst->GetParent(),
+                 CastTo<BasicBlock>(static_cast<JumpInst *>(inst)->target()));
+        break;
+      default:
+        // pointers are not folded
+        if (inst->isBinaryOp() && inst->type() && !inst->type()->IsPointer()) {
+          VisitBinary(inst, (*inst)[0].get(), (*inst)[1].get());
+        } else {
+          SetValue(inst, {LatticeValue::Overdefined, 0});
+        }
+        break;
+    }
+  }
+
+  // propagate from 'entry', or from pending work lists if it's null
+  void Solve(const BlockPtr &entry) {
+    if (entry) {
+      _executable.insert(entry);
+      _block_list.push_back(entry);
+    }
+    while (!_block_list.empty() || !_inst_list.empty()) {
+      while (!_inst_list.empty()) {
+        auto inst = _inst_list.back();
+        _inst_list.pop_back();
+        if (_executable.count(inst->GetParent())) Visit(inst);
+      }
+      if (!_block_list.empty()) {
+        auto block = _block_list.back();
+        _block_list.pop_back();
+        for (const auto &inst : block->insts()) Visit(inst);
+      }
+    }
+  }
+
+  // conditions that are still undefined (e.g. phi nodes that only refer
+  // to themselves) are not known at runtime, so both successors of their
+  // branches are executable, return true if any edge is marked
+  bool ResolveUndefBranches() {
+    // marking edges may add executable blocks, so collect blocks first
+    Blocks undef;
+    for (const auto &block : _executable) {
+      auto &insts = block->insts();
+      if (insts.empty() || insts.back()->opcode() != Instruction::Br) continue;
+      auto br = static_cast<BranchInst *>(insts.back());
+      if (GetValue(br->cond()).state == LatticeValue::Undefined) undef.push_back(block);
+    }
+    bool marked = false;
+    for (const auto &block : undef) {
+      for (const auto &succ : GetSuccessors(block)) {
+        if (!_edges.count({block, succ})) {
+          MarkEdge(block, succ);
+          marked = true;
+        }
+      }
+    }
+    return marked;
+  }
+
+  // replace constant instructions of block by constants, return number
+  // of replaced instructions
+  std::size_t FoldInsts(const BlockPtr &block) {
+    std::size_t folded = 0;
+    auto &insts = block->insts();
+    for (auto it = insts.begin(); it != insts.end();) {
+      auto inst = *it;
+      auto value = _values.find(inst);
+      if (value == _values.end() || value->second.state != LatticeValue::Constant) {
+        ++it;
+        continue;
+      }
+      auto cint = PassManager::module().New<ConstantInt>(value->second.value);
+      cint->set_type(TYPE::MakeConst(inst->type()));
+      inst->ReplaceBy(cint);
+      it = insts.erase(it);
+      inst->DropAllReferences();
+      ++folded;
+    }
+    return folded;
+  }
+
+  // remove block 'pred' from predecessors and phi nodes of 'block'
+  static void RemoveEdge(const BlockPtr &pred, const BlockPtr &block) {
+    block->RemoveValue(pred);
+    for (const auto &inst : block->insts()) {
+      if (inst->opcode() != Instruction::PHI) break;
+      inst->RemoveValue(pred);
+    }
+  }
+
+  // replace branch of block by jump if only one successor is executable
+  bool FoldBranch(const BlockPtr &block) {
+    auto &insts = block->insts();
+    if (insts.empty() || insts.back()->opcode() != Instruction::Br) return false;
+    auto br = static_cast<BranchInst *>(insts.back());
+    auto true_block = CastTo<BasicBlock>(br->true_block());
+    auto false_block = CastTo<BasicBlock>(br->false_block());
+    if (true_block == false_block) return false;
+    bool true_taken = _edges.count({block, true_block});
+    bool false_taken = _edges.count({block, false_block});
+    if (true_taken == false_taken) return false;
+
+    auto target = true_taken ? true_block : false_block;
+    RemoveEdge(block, true_taken ? false_block : true_block);
+    auto jump = PassManager::module().New<JumpInst>(target);
+    jump->set_loc(br->loc());
+    insts.pop_back();
+    br->DropAllReferences();
+    insts.push_back(jump);
+    return true;
+  }
+
+  void RemoveBlocks(const Blocks &dead) {
+    // remove edges to executable blocks, edges between dead blocks
+    // are dropped along with their instructions
+    for (const auto &block : dead) {
+      for (const auto &succ : GetSuccessors(block)) {
+        if (_executable.count(succ)) RemoveEdge(block, succ);
+      }
+    }
+    for (const auto &block : dead) {
+      for (const auto &inst : block->insts()) inst->DropAllReferences();
+      block->DropAllReferences();
+    }
+    for (const auto &block : dead) block->RemoveFromUser();
+  }
+
+public:
+  bool runOnFunction(const FuncPtr &F) final {
+    if (F->empty()) return false;
+    _values.clear();
+    _edges.clear();
+    _executable.clear();
+    Solve(CastTo<BasicBlock>((*F)[0].get()));
+    while (ResolveUndefBranches()) Solve(nullptr);
+
+    std::size_t folded = 0, branches = 0;
+    Blocks dead;
+    for (const auto &it : *F) {
+      auto block = CastTo<BasicBlock>(it.get());
+      if (!_executable.count(block)) {
+        dead.push_back(block);
+        continue;
+      }
+      folded += FoldInsts(block);
+      if (FoldBranch(block)) ++branches;
+    }
+    if (!dead.empty()) RemoveBlocks(dead);
+
+    if (folded) PassManager::AddCounter("SCCP", "instructions folded", folded);
+    if (branches) PassManager::AddCounter("SCCP", "branches folded", branches);
+    if (!dead.empty()) PassManager::AddCounter("SCCP", "blocks removed", dead.size());
+    return folded || branches || !dead.empty();
+  }
+
+  std::shared_ptr<FunctionPass> Clone() const final {
+    return std::make_shared<SCCP>();
+  }
+};
+
+class SCCPFactory : public PassFactory {
+public:
+  PassInfoPtr CreatePass(PassManager *) override {
+    auto pass = std::make_shared<SCCP>();
+    auto passinfo = std::make_shared<PassInfo>(pass, "SCCP", false, 1);
+    passinfo->set_priority(20);
+    return passinfo;
+  }
+};
+
+static PassRegisterFactory<SCCPFactory> registry;
+
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "compile.h"
+#include "treewalk.h"
+#include "back/interp/interpreter.h"
+#include "back/jit/jit.h"
+#include "opt/pass_manager.h"
+
+using namespace RJIT::back;
+using namespace RJIT::opt;
+
+// benchmark of execution modes, programs are run by a naive AST walker
+// as baseline, by the interpreter, by tiered execution and by the JIT at
+// -O1, all modes must return the same value. Usage: bench_exec [scale]
+
+namespace {
+
+struct Benchmark {
+  const char *name;
+  const char *source;   // '@N' is replaced by size of input
+  int         size;     // size at scale 1
+};
+
+const Benchmark kBenchmarks[] = {
+  {"fib", R"(
+def fib(n int) int {
+  if n < 2 {
+    return n;
+  }
+  return fib(n - 1) + fib(n - 2);
+}
+
+def main() int {
+  var i = 0 : int;
+  var s = 0 : int;
+  while i < @N {
+    s = s + fib(20);
+    i = i + 1;
+  }
+  return s % 256;
+}
+)", 5},
+  {"loops", R"(
+def main() int {
+  var i = 0 : int;
+  var j = 0 : int;
+  var s = 0 : int;
+  while i < @N {
+    j = 0;
+    while j < 1000 {
+      s = (s + i * j) % 65521;
+      j = j + 1;
+    }
+    i = i + 1;
+  }
+  return s % 256;
+}
+)", 1000},
+  {"calls", R"(
+def add(a int, b int) int {
+  return a + b;
+}
+
+def mix(a int, b int) int {
+  return add(a, b) % 4093 + add(b, 1);
+}
+
+def main() int {
+  var i = 0 : int;
+  var s = 0 : int;
+  while i < @N {
+    s = mix(s, i) % 65521;
+    i = i + 1;
+  }
+  return s % 256;
+}
+)", 200000},
+};
+
+enum class Mode { Walk, Interp, Tiered, JIT };
+
+constexpr int kModeNum = 4;
+const char *kModeNames[kModeNum] = {"walk", "interp", "tiered", "jit"};
+
+struct Result {
+  int      ret;
+  double   time;       // time of execution in ms, compilation excluded
+  uint64_t executed;   // bytecode instructions executed by interpreter
+};
+
+// compile and run 'main' of source, return false if failed
+bool Run(const std::string &source, Mode mode, Result &result) {
+  RJIT::test::Program program(source);
+  if (!program.ok()) return false;
+  auto &module = program.module();
+  PassManager::SetModule(module);
+  PassManager::SetOptLevel(1);
+
+  JIT jit(module);
+  interp::Interpreter interp(module);
+  if (mode == Mode::Walk) {
+    RJIT::test::TreeWalker walker(program.ast());
+    auto start = std::chrono::steady_clock::now();
+    result.ret = walker.RunMain();
+    result.time = RJIT::test::ElapsedMs(start);
+    return true;
+  } else if (mode == Mode::JIT) {
+    PassManager::RunPasses();
+    if (!jit.Compile({module.GetFunction("main")})) return false;
+    auto start = std::chrono::steady_clock::now();
+    result.ret = jit.RunMain();
+    result.time = RJIT::test::ElapsedMs(start);
+    return true;
+  }
+
+  // functions are compiled to native code during the run in tiered mode
+  if (!interp.Compile()) return false;
+  if (mode == Mode::Tiered) {
+    interp::TierOptions opts;
+    opts.optimize = [](RJIT::mid::Function *F) { PassManager::RunPasses(F); };
+    interp.EnableTiering(jit, opts);
+  }
+  auto start = std::chrono::steady_clock::now();
+  result.ret = interp.RunMain();
+  result.time = RJIT::test::ElapsedMs(start);
+  if (interp.trapped()) return false;
+  if (mode == Mode::Interp) {
+    // instructions are counted by another run, counting slows it down
+    interp.set_count_executed(true);
+    interp.RunMain();
+    result.executed = interp.executed();
+  }
+  return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  int scale = argc > 1 ? std::atoi(argv[1]) : 10;
+  if (scale < 1) scale = 1;
+  PassManager::Initialize();
+
+  // work of each benchmark is measured in bytecode instructions the
+  // interpreter executes for it, so that all modes are compared by
+  // instructions per second of the same program
+  std::cout << std::left << std::setw(8) << "bench" << std::right
+            << std::setw(12) << "insts";
+  for (const auto &name : kModeNames) {
+    std::cout << std::setw(10) << name << "(ms)" << std::setw(8) << "Minst/s";
+  }
+  std::cout << std::setw(10) << "speedup" << std::endl;
+
+  for (const auto &bench : kBenchmarks) {
+    std::string source = bench.source;
+    auto pos = source.find("@N");
+    source.replace(pos, 2, std::to_string(bench.size * scale));
+
+    Result results[kModeNum];
+    for (int m = 0; m < kModeNum; ++m) {
+      if (!Run(source, static_cast<Mode>(m), results[m])) {
+        std::cerr << bench.name << ": error: failed to run in mode '"
+                  << kModeNames[m] << "'" << std::endl;
+        return 1;
+      }
+      if (results[m].ret != results[0].ret) {
+        std::cerr << bench.name << ": error: mode '" << kModeNames[m]
+                  << "' returns " << results[m].ret << ", tree walker returns "
+                  << results[0].ret << std::endl;
+        return 1;
+      }
+    }
+
+    auto insts = results[static_cast<int>(Mode::Interp)].executed;
+    std::cout << std::left << std::setw(8) << bench.name << std::right
+              << std::setw(12) << insts << std::fixed;
+    for (const auto &result : results) {
+      std::cout << std::setprecision(1) << std::setw(14) << result.time
+                << std::setprecision(0) << std::setw(8)
+                << insts / 1000.0 / std::max(result.time, 1e-3);
+    }
+    // speedup of interpreter over tree walker
+    std::cout << std::setprecision(1) << std::setw(9)
+              << results[0].time / std::max(results[1].time, 1e-3) << "x"
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "compile.h"
+#include "front/lexer.h"
+#include "front/logger.h"
+#include "front/parser.h"
+#include "mid/ir/castssa.h"
+#include "mid/walker/analyzer/sema.h"
+#include "mid/walker/irbuilder/irbuilder.h"
+
+using namespace RJIT::front;
+using namespace RJIT::mid;
+
+// benchmark of IR construction, a function of about N instructions is
+// built from its analyzed AST. Usage: bench_irbuild [instructions]
+
+int main(int argc, char *argv[]) {
+  int target = argc > 1 ? std::atoi(argv[1]) : 100000;
+  if (target < 1) target = 1;
+
+  // each statement takes 5 instructions: 2 loads, mul, add and store
+  std::string source = "def main() int {\n  var a = 1 : int;\n  var b = 2 : int;\n";
+  for (int i = 0; i * 5 < target; ++i) {
+    source += i % 2 ? "  a = a + b * " : "  b = b + a * ";
+    source += std::to_string(i % 7 + 1) + ";\n";
+  }
+  source += "  return a + b;\n}\n";
+
+  auto lexer = Lexer::FromBuffer(source);
+  Parser parser(&lexer);
+  parser.Parse();
+  if (Logger::errorNum()) return 1;
+  analyzer::SemAnalyzer(parser.ast()).Analyze();
+  if (Logger::errorNum()) return 1;
+
+  auto start = std::chrono::steady_clock::now();
+  IRBuilder builder(parser.ast());
+  builder.EmitIR();
+  auto time = RJIT::test::ElapsedMs(start);
+  if (Logger::errorNum()) return 1;
+
+  std::size_t insts = 0;
+  for (const auto &func : builder.module().Functions()) {
+    for (const auto &it : *func) {
+      insts += RJIT::CastTo<BasicBlock>(it.get())->insts().size();
+    }
+  }
+  if (insts < static_cast<std::size_t>(target)) {
+    std::cerr << "error: " << insts << " instructions built, expected at least "
+              << target << std::endl;
+    return 1;
+  }
+  std::cout << insts << " instructions built in " << std::fixed
+            << std::setprecision(1) << time << " ms, " << insts / 1000.0 / time
+            << " M instructions/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "compile.h"
+#include "front/lexer.h"
+
+using namespace RJIT::front;
+
+// lexer benchmark, a large synthetic file is lexed and tokens per second
+// are reported. Usage: bench_lexer [functions]
+
+namespace {
+
+// source of one function, identifiers differ between functions
+std::string MakeFunction(int i) {
+  std::ostringstream oss;
+  oss << "# function " << i << " of synthetic file\n"
+      << "def func_" << i << "(count int, base int) int {\n"
+      << "  var index = 0 : int;\n"
+      << "  var total_" << i << " = base * " << i << " : int;\n"
+      << "  var name = \"function " << i << "\" : string;\n"
+      << "  var sep = ',' : char;\n"
+      << "  while index < count && total_" << i << " != 0 {\n"
+      << "    if (index % 3 == 0) || (index >= 100) {\n"
+      << "      total_" << i << " = total_" << i << " + (index << 2) - 17;\n"
+      << "    } else {\n"
+      << "      total_" << i << " = total_" << i << " ^ (index >> 1) | 255;\n"
+      << "    }\n"
+      << "    index = index + 1;\n"
+      << "  }\n"
+      << "  return total_" << i << ";\n"
+      << "}\n\n";
+  return oss.str();
+}
+
+// lex whole source, return number of tokens
+std::size_t Lex(const std::string &source) {
+  auto lexer = Lexer::FromBuffer(source);
+  std::size_t tokens = 0;
+  while (lexer.nextToken().getTokenType() != TokenType::END) ++tokens;
+  return tokens;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+  if (count < 1) count = 1;
+  std::string source;
+  for (int i = 0; i < count; ++i) source += MakeFunction(i);
+
+  // every function has the same number of tokens
+  auto expected = Lex(MakeFunction(0)) * count;
+  auto start = std::chrono::steady_clock::now();
+  auto tokens = Lex(source);
+  auto time = RJIT::test::ElapsedMs(start);
+  if (tokens != expected) {
+    std::cerr << "error: " << tokens << " tokens, expected " << expected << std::endl;
+    return 1;
+  }
+
+  std::cout << source.size() / 1024 << " KiB, " << tokens << " tokens in "
+            << std::fixed << std::setprecision(1) << time << " ms, "
+            << std::setprecision(1) << tokens / 1000.0 / time << " M tokens/s, "
+            << source.size() / 1048576.0 / (time / 1000) << " MiB/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "compile.h"
+#include "treewalk.h"
+#include "front/lexer.h"
+#include "front/logger.h"
+#include "front/parser.h"
+
+using namespace RJIT::front;
+
+// parser benchmark over deeply nested expressions, mixing precedence
+// levels and associativity at each level of nesting.
+// Usage: bench_parser [functions] [depth]
+
+namespace {
+
+// nested expression of 'depth' levels, its value is stored to 'value'
+std::string MakeExpr(int depth, uint32_t &value) {
+  std::string expr = "7";
+  value = 7;
+  for (int k = 1; k <= depth; ++k) {
+    auto n = std::to_string(k % 9 + 1), m = std::to_string(k % 5 + 2);
+    uint32_t nv = k % 9 + 1, mv = k % 5 + 2;
+    switch (k % 4) {
+      case 0:   // '*' binds tighter than '+'
+        expr = "(" + expr + " + " + n + " * " + m + ")";
+        value = value + nv * mv;
+        break;
+      case 1:   // '-' after '*'
+        expr = "(" + n + " * " + expr + " - " + m + ")";
+        value = nv * value - mv;
+        break;
+      case 2:   // '-' is left associative
+        expr = "(" + expr + " - " + n + " - " + m + ")";
+        value = value - nv - mv;
+        break;
+      default:  // '%' binds tighter than '+'
+        expr = "(" + m + " + " + expr + " % 1000)";
+        value = mv + static_cast<uint32_t>(static_cast<int32_t>(value) % 1000);
+        break;
+    }
+  }
+  return expr;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 20000;
+  int depth = argc > 2 ? std::atoi(argv[2]) : 200;
+  if (count < 1) count = 1;
+  if (depth < 1) depth = 1;
+
+  uint32_t value;
+  auto expr = MakeExpr(depth, value);
+
+  // parsed expression must have the value computed above
+  RJIT::test::Program program("def main() int {\n  return " + expr + ";\n}\n");
+  if (!program.ok()) return 1;
+  auto ret = RJIT::test::TreeWalker(program.ast()).RunMain();
+  if (ret != static_cast<int>(value)) {
+    std::cerr << "error: expression evaluates to " << ret << ", expected "
+              << static_cast<int>(value) << std::endl;
+    return 1;
+  }
+
+  std::string source;
+  for (int i = 0; i < count; ++i) {
+    source += "def f" + std::to_string(i) + "() int {\n  var a = 0 : int;\n"
+              "  var b = 0 : int;\n  a = b = " + expr + ";\n  return a;\n}\n\n";
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto lexer = Lexer::FromBuffer(source);
+  Parser parser(&lexer);
+  parser.Parse();
+  auto time = RJIT::test::ElapsedMs(start);
+  if (Logger::errorNum()) return 1;
+
+  std::cout << count << " functions, expressions of depth " << depth << ", "
+            << source.size() / 1024 << " KiB parsed in " << std::fixed
+            << std::setprecision(1) << time << " ms, " << count / time
+            << "K expressions/s, " << source.size() / 1048576.0 / (time / 1000)
+            << " MiB/s" << std::endl;
+  return 0;
+}
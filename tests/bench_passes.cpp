@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "compile.h"
+#include "opt/pass_manager.h"
+
+using namespace RJIT::opt;
+
+// scaling benchmark of function passes, a module of many functions is
+// optimized at -O1 on 1 to N threads, output must be same on any number
+// of threads. Usage: bench_passes [functions]
+
+namespace {
+
+// source of 'count' functions with loops and branches
+std::string MakeSource(int count) {
+  std::ostringstream oss;
+  for (int i = 0; i < count; ++i) {
+    oss << "def f" << i << "(n int) int {\n"
+        << "  var i = 0 : int;\n"
+        << "  var s = " << i << " : int;\n"
+        << "  var t = 0 : int;\n"
+        << "  while i < n {\n"
+        << "    t = s * " << i % 7 + 2 << " + i;\n"
+        << "    if t > 1000 {\n"
+        << "      s = t % 1000 + s * 0;\n"
+        << "    } else {\n"
+        << "      s = t + (i + 1) * (i + 1);\n"
+        << "    }\n"
+        << "    i = i + 1;\n"
+        << "  }\n"
+        << "  return s + t * 0;\n"
+        << "}\n\n";
+  }
+  oss << "def main() int {\n  return f0(10);\n}\n";
+  return oss.str();
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 2000;
+  if (count < 1) count = 1;
+  auto source = MakeSource(count);
+  PassManager::Initialize();
+  PassManager::SetOptLevel(1);
+
+  std::size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+  std::string expected;
+  double base = 0;
+  std::cout << count << " functions" << std::endl;
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    RJIT::test::Program program(source);
+    if (!program.ok()) return 1;
+    PassManager::SetModule(program.module());
+    PassManager::SetThreads(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    PassManager::RunPasses();
+    auto time = RJIT::test::ElapsedMs(start);
+
+    std::ostringstream oss;
+    program.module().Dump(oss);
+    if (threads == 1) {
+      expected = oss.str();
+      base = time;
+    } else if (oss.str() != expected) {
+      std::cerr << "error: output on " << threads
+                << " threads differs from output on 1 thread" << std::endl;
+      return 1;
+    }
+    std::cout << std::setw(3) << threads << " threads: " << std::fixed
+              << std::setprecision(1) << std::setw(9) << time << " ms, "
+              << std::setprecision(2) << base / time << "x" << std::endl;
+  }
+  return 0;
+}
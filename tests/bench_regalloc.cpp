@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#include "compile.h"
+#include "back/jit/jit.h"
+#include "back/x86/codegen.h"
+#include "mid/ir/castssa.h"
+#include "opt/pass_manager.h"
+
+using namespace RJIT::mid;
+using namespace RJIT::opt;
+
+// memory accesses per loop iteration of the 'while' example in README,
+// loads and stores of the IR are compared with memory accesses of the
+// native code after register allocation, then the loop is timed in
+// native code. Usage: bench_regalloc [iterations]
+
+namespace {
+
+const char *kSource = R"(
+def a(x int, y int) int {
+  var a = 1 : int;
+  while x + y > a {
+    a = a + 1;
+  }
+  return a;
+}
+
+def main() int {
+  return a(@N, 1) % 256;
+}
+)";
+
+// blocks of 'F' that are on a cycle, each one runs once per iteration
+// of the single loop of the example
+std::unordered_set<BasicBlock *> LoopBlocks(Function *F) {
+  std::unordered_set<BasicBlock *> loop;
+  for (const auto &it : *F) {
+    auto block = RJIT::CastTo<BasicBlock>(it.get());
+    std::unordered_set<BasicBlock *> visited;
+    std::function<bool(BasicBlock *)> reaches = [&](BasicBlock *cur) {
+      for (const auto &succ : GetSuccessors(cur)) {
+        if (succ == block) return true;
+        if (visited.insert(succ).second && reaches(succ)) return true;
+      }
+      return false;
+    };
+    if (reaches(block)) loop.insert(block);
+  }
+  return loop;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  long iterations = argc > 1 ? std::atol(argv[1]) : 100000000;
+  if (iterations < 1) iterations = 1;
+  std::string source = kSource;
+  source.replace(source.find("@N"), 2, std::to_string(iterations));
+  PassManager::Initialize();
+
+  std::cout << std::setw(6) << "level" << std::setw(16) << "IR loads/stores"
+            << std::setw(18) << "native accesses" << std::setw(14) << "ns/iteration"
+            << std::endl;
+  for (std::size_t level = 0; level <= 1; ++level) {
+    RJIT::test::Program program(source);
+    if (!program.ok()) return 1;
+    PassManager::SetModule(program.module());
+    PassManager::SetOptLevel(level);
+    PassManager::RunPasses();
+
+    auto func = program.module().GetFunction("a");
+    RJIT::back::x86::Assembler assembler;
+    RJIT::back::x86::CallRelocList relocs;
+    RJIT::back::x86::CodeGen codegen(assembler, relocs);
+    if (!codegen.GenerateFunction(func)) return 1;
+
+    std::size_t ir_accesses = 0, native_accesses = 0;
+    for (const auto &block : LoopBlocks(func)) {
+      for (const auto &inst : block->insts()) {
+        ir_accesses += inst->opcode() == Instruction::Load ||
+                       inst->opcode() == Instruction::Store;
+      }
+      native_accesses += codegen.MemAccesses(block);
+    }
+
+    RJIT::back::JIT jit(program.module());
+    if (!jit.Compile({program.module().GetFunction("main")})) return 1;
+    auto start = std::chrono::steady_clock::now();
+    auto ret = jit.RunMain();
+    auto time = RJIT::test::ElapsedMs(start);
+    if (ret != static_cast<int>((iterations + 1) % 256)) {
+      std::cerr << "error: returns " << ret << " at -O" << level << std::endl;
+      return 1;
+    }
+    std::cout << std::setw(4) << "-O" << level << std::setw(16) << ir_accesses
+              << std::setw(18) << native_accesses << std::fixed
+              << std::setprecision(3) << std::setw(14)
+              << time * 1e6 / static_cast<double>(iterations) << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef RJIT_TESTS_COMPILE_H
+#define RJIT_TESTS_COMPILE_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "front/lexer.h"
+#include "front/logger.h"
+#include "front/parser.h"
+#include "mid/walker/analyzer/sema.h"
+#include "mid/walker/irbuilder/irbuilder.h"
+
+namespace RJIT::test {
+
+// program compiled from an in-memory source to IR
+class Program {
+private:
+  std::string                        _source;
+  front::Lexer                       _lexer;
+  front::Parser                      _parser;
+  std::unique_ptr<mid::IRBuilder>    _builder;
+
+public:
+  explicit Program(std::string source)
+      : _source(std::move(source)), _lexer(front::Lexer::FromBuffer(_source)),
+        _parser(&_lexer) {
+    _parser.Parse();
+    if (front::Logger::errorNum()) return;
+    mid::analyzer::SemAnalyzer(_parser.ast()).Analyze();
+    if (front::Logger::errorNum()) return;
+    _builder = std::make_unique<mid::IRBuilder>(_parser.ast());
+    _builder->EmitIR();
+    if (front::Logger::errorNum()) _builder.reset();
+  }
+
+  // false if source has errors
+  bool ok() const { return _builder != nullptr; }
+
+  mid::Module &module() { return _builder->module(); }
+
+  // AST after semantic analysis
+  AST::ASTPtr ast() { return _parser.ast(); }
+};
+
+// milliseconds elapsed since 'start'
+inline double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+#endif //RJIT_TESTS_COMPILE_H
@@ -0,0 +1,35 @@
+# IR written by 'XYCC' at level 'LEVEL' to a binary IR file is loaded
+# again, its dump must be identical to dump of the source program, and
+# running it must exit with code in '# expect:' line
+
+get_filename_component(name ${FILE} NAME_WE)
+set(bin ${WORK_DIR}/${name}.O${LEVEL}.xyb)
+file(STRINGS ${FILE} expect REGEX "^# expect: ")
+string(REGEX REPLACE "^# expect: " "" expect "${expect}")
+
+execute_process(COMMAND ${XYCC} -O${LEVEL} --emit-bin ${bin} ${FILE}
+                RESULT_VARIABLE result ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${FILE}: failed to emit binary IR (${result})\n${error}")
+endif ()
+execute_process(COMMAND ${XYCC} -O${LEVEL} ${FILE}
+                RESULT_VARIABLE result OUTPUT_VARIABLE original ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${FILE}: xycc failed (${result})\n${error}")
+endif ()
+execute_process(COMMAND ${XYCC} ${bin}
+                RESULT_VARIABLE result OUTPUT_VARIABLE loaded ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${bin}: xycc failed (${result})\n${error}")
+endif ()
+if (NOT original STREQUAL loaded)
+  message(FATAL_ERROR "${bin}: IR changed after loading, got\n${loaded}")
+endif ()
+
+foreach (mode jit interp)
+  execute_process(COMMAND ${XYCC} --${mode} ${bin}
+                  RESULT_VARIABLE result ERROR_VARIABLE error OUTPUT_QUIET)
+  if (NOT result STREQUAL expect)
+    message(FATAL_ERROR "${bin}: exit code ${result} with --${mode}, expected ${expect}\n${error}")
+  endif ()
+endforeach ()
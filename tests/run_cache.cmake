@@ -0,0 +1,64 @@
+# compile source programs 'FILE' and 'OTHER' by 'XYCC' with a compile
+# cache in 'WORK_DIR', check hits, misses and entries reported by
+# '--cache-stats', and that cached results are the same as compiled ones
+
+set(dir ${WORK_DIR}/cache)
+file(REMOVE_RECURSE ${dir})
+
+# run 'XYCC' with cache and options 'ARGN', output is stored in 'output',
+# then cache statistics must be 'hits' 'misses' 'entries'
+function(run_cached hits misses entries)
+  execute_process(COMMAND ${XYCC} --cache-dir ${dir} --cache-stats ${ARGN}
+                  RESULT_VARIABLE result OUTPUT_VARIABLE out ERROR_VARIABLE error)
+  if (NOT error MATCHES "cache: ([0-9]+) hits, ([0-9]+) misses, ([0-9]+) entries, ([0-9]+) bytes")
+    message(FATAL_ERROR "'${ARGN}': no cache statistics (${result})\n${error}")
+  endif ()
+  set(stats "${CMAKE_MATCH_1} ${CMAKE_MATCH_2} ${CMAKE_MATCH_3}")
+  if (NOT stats STREQUAL "${hits} ${misses} ${entries}")
+    message(FATAL_ERROR "'${ARGN}': got '${stats}' hits, misses and entries, "
+                        "expected '${hits} ${misses} ${entries}'")
+  endif ()
+  set(output "${out}" PARENT_SCOPE)
+  set(result "${result}" PARENT_SCOPE)
+  set(bytes "${CMAKE_MATCH_4}" PARENT_SCOPE)
+endfunction()
+
+execute_process(COMMAND ${XYCC} -O1 ${FILE} OUTPUT_VARIABLE compiled)
+execute_process(COMMAND ${XYCC} --jit ${FILE} RESULT_VARIABLE expect)
+
+# IR dump is cached, and the cached one is printed
+run_cached(0 1 1 -O1 ${FILE})
+run_cached(1 1 1 -O1 ${FILE})
+if (NOT output STREQUAL compiled)
+  message(FATAL_ERROR "${FILE}: cached IR differs from compiled IR, got\n${output}")
+endif ()
+
+# native code is cached separately, options are part of key
+run_cached(1 2 2 --jit ${FILE})
+run_cached(2 2 2 --jit ${FILE})
+if (NOT result STREQUAL expect)
+  message(FATAL_ERROR "${FILE}: cached code exits with ${result}, expected ${expect}")
+endif ()
+run_cached(2 3 3 -O0 ${FILE})
+
+# results of another build of compiler are never used
+set(other_xycc ${WORK_DIR}/xycc-other)
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy ${XYCC} ${other_xycc})
+file(APPEND ${other_xycc} "\n")
+execute_process(COMMAND ${other_xycc} --cache-dir ${dir} --cache-stats -O1 ${FILE}
+                OUTPUT_QUIET ERROR_VARIABLE error)
+if (NOT error MATCHES "cache: 2 hits, 4 misses, 4 entries")
+  message(FATAL_ERROR "${FILE}: result of another build is used\n${error}")
+endif ()
+
+# with limit of two entries of same size, the least recently used one is
+# evicted, an entry is used again when it is hit
+file(REMOVE_RECURSE ${dir})
+set(copy ${WORK_DIR}/cache_copy.xy)
+file(READ ${OTHER} source)
+file(WRITE ${copy} "${source}# copy\n")
+run_cached(0 1 1 ${FILE})
+run_cached(0 2 2 ${OTHER})
+run_cached(1 2 2 ${FILE})
+run_cached(1 3 2 --cache-size ${bytes} ${copy})
+run_cached(2 3 2 --cache-size ${bytes} ${FILE})
@@ -0,0 +1,55 @@
+# optimize IR file 'FILE' by 'XYCC_OPT' with options of its '; run:' line,
+# output must contain text of every '; check:' line and must not contain
+# text of any '; check-not:' line, stderr must contain text of every
+# '; check-err:' line (e.g. pass statistics of '--time-passes'), and
+# output must be parsed back without errors
+
+file(STRINGS ${FILE} lines REGEX "^; (run|check|check-not|check-err): ")
+set(args "")
+set(checks "")
+set(check_nots "")
+set(check_errs "")
+foreach (line ${lines})
+  if (line MATCHES "^; run: (.*)")
+    separate_arguments(args UNIX_COMMAND "${CMAKE_MATCH_1}")
+  elseif (line MATCHES "^; check: (.*)")
+    list(APPEND checks "${CMAKE_MATCH_1}")
+  elseif (line MATCHES "^; check-not: (.*)")
+    list(APPEND check_nots "${CMAKE_MATCH_1}")
+  elseif (line MATCHES "^; check-err: (.*)")
+    list(APPEND check_errs "${CMAKE_MATCH_1}")
+  endif ()
+endforeach ()
+
+execute_process(COMMAND ${XYCC_OPT} ${args} ${FILE}
+                RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${FILE}: xycc-opt failed (${result})\n${error}")
+endif ()
+foreach (check ${checks})
+  string(FIND "${output}" "${check}" pos)
+  if (pos EQUAL -1)
+    message(FATAL_ERROR "${FILE}: output does not contain '${check}', got\n${output}")
+  endif ()
+endforeach ()
+foreach (check ${check_nots})
+  string(FIND "${output}" "${check}" pos)
+  if (NOT pos EQUAL -1)
+    message(FATAL_ERROR "${FILE}: output contains '${check}', got\n${output}")
+  endif ()
+endforeach ()
+foreach (check ${check_errs})
+  string(FIND "${error}" "${check}" pos)
+  if (pos EQUAL -1)
+    message(FATAL_ERROR "${FILE}: stderr does not contain '${check}', got\n${error}")
+  endif ()
+endforeach ()
+
+get_filename_component(name ${FILE} NAME_WE)
+set(dump ${WORK_DIR}/${name}.out.ir)
+file(WRITE ${dump} "${output}")
+execute_process(COMMAND ${XYCC_OPT} ${dump}
+                RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${dump}: output can not be parsed (${result})\n${error}")
+endif ()
@@ -0,0 +1,19 @@
+# IR dumped by 'XYCC' at level 'LEVEL' is parsed by 'XYCC_OPT' and dumped
+# again, both dumps must be identical
+
+get_filename_component(name ${FILE} NAME_WE)
+set(dump ${WORK_DIR}/${name}.O${LEVEL}.ir)
+execute_process(COMMAND ${XYCC} -O${LEVEL} ${FILE}
+                RESULT_VARIABLE result OUTPUT_FILE ${dump} ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${FILE}: xycc failed (${result})\n${error}")
+endif ()
+execute_process(COMMAND ${XYCC_OPT} ${dump}
+                RESULT_VARIABLE result OUTPUT_VARIABLE reparsed ERROR_VARIABLE error)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "${dump}: xycc-opt failed (${result})\n${error}")
+endif ()
+file(READ ${dump} original)
+if (NOT original STREQUAL reparsed)
+  message(FATAL_ERROR "${dump}: IR changed after parsing, got\n${reparsed}")
+endif ()
@@ -0,0 +1,23 @@
+# run source program 'FILE' with 'XYCC' and options 'ARGS', exit code must
+# be the one in '# expect:' line, and stderr must contain text of
+# '# stderr:' line if there is one
+
+file(STRINGS ${FILE} expect REGEX "^# expect: ")
+file(STRINGS ${FILE} stderr_text REGEX "^# stderr: ")
+if (NOT expect)
+  message(FATAL_ERROR "${FILE}: missing '# expect:' line")
+endif ()
+string(REGEX REPLACE "^# expect: " "" expect "${expect}")
+
+execute_process(COMMAND ${XYCC} ${ARGS} ${FILE}
+                RESULT_VARIABLE result ERROR_VARIABLE error OUTPUT_QUIET)
+if (NOT result STREQUAL expect)
+  message(FATAL_ERROR "${FILE}: exit code ${result}, expected ${expect}\n${error}")
+endif ()
+if (stderr_text)
+  string(REGEX REPLACE "^# stderr: " "" stderr_text "${stderr_text}")
+  string(FIND "${error}" "${stderr_text}" pos)
+  if (pos EQUAL -1)
+    message(FATAL_ERROR "${FILE}: stderr does not contain '${stderr_text}'\n${error}")
+  endif ()
+endif ()
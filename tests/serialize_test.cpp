@@ -0,0 +1,231 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "compile.h"
+#include "back/jit/jit.h"
+#include "mid/ir/ssa.h"
+#include "mid/ir/serialize.h"
+
+using namespace RJIT::mid;
+
+namespace {
+
+// 'unused' is never called, so it is never loaded when running 'main'
+const char *kSource = R"(
+def add(a int, b int) int {
+  return a + b;
+}
+
+def unused(n int) int {
+  var s = 0 : int;
+  while n > 0 {
+    s = s + n;
+    n = n - 1;
+  }
+  return s;
+}
+
+def main() int {
+  return add(40, 2);
+}
+)";
+
+const char *kFile = "serialize_test.xyb";
+
+// offsets of fields and sizes of records in binary IR file, see
+// 'serialize.cpp'
+constexpr std::size_t kMagic = 0, kVersion = 4, kStrSize = 12;
+constexpr std::size_t kTypeOffset = 24, kTypeNum = 28;
+constexpr std::size_t kFuncOffset = 32, kFuncNum = 36;
+constexpr std::size_t kFuncRecordSize = 28, kFuncType = 8;
+constexpr std::size_t kBodyOffset = 20, kBodySize = 24;
+constexpr std::size_t kBodyHeaderSize = 28, kBlockNum = 4, kInstNum = 8, kOpNum = 24;
+constexpr std::size_t kArgRecordSize = 12, kBlockRecordSize = 24;
+constexpr std::size_t kInstRecordSize = 36, kInstOpNum = 32;
+constexpr std::size_t kLastOperand = ~std::size_t(0);
+
+bool WriteFile(const std::string &data) {
+  std::ofstream ofs(kFile, std::ios::binary | std::ios::trunc);
+  return static_cast<bool>(ofs.write(data.data(), data.size()));
+}
+
+uint32_t Get32(const std::string &data, std::size_t offset) {
+  uint32_t value;
+  std::memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+void Set32(std::string &data, std::size_t offset, uint32_t value) {
+  std::memcpy(&data[offset], &value, sizeof(value));
+}
+
+// get offset and size of body of the 'index'th function
+std::pair<std::size_t, std::size_t> GetBody(const std::string &data,
+                                            std::size_t index) {
+  auto rec = Get32(data, kFuncOffset) + index * kFuncRecordSize;
+  return {Get32(data, rec + kBodyOffset), Get32(data, rec + kBodySize)};
+}
+
+// functions are loaded only when used, and loaded module is the same as
+// the written one
+bool TestRoundTrip(const std::string &dump) {
+  Module module;
+  if (!ReadModule(kFile, module)) {
+    std::cerr << "error: failed to read binary IR" << std::endl;
+    return false;
+  }
+  for (const auto &func : module.Functions()) {
+    if (!func->IsMaterializable()) {
+      std::cerr << "error: function '" << func->GetFunctionName()
+                << "' is loaded before it is used" << std::endl;
+      return false;
+    }
+  }
+
+  RJIT::back::JIT jit(module);
+  if (!jit.Compile({module.GetFunction("main")}) || jit.RunMain() != 42) {
+    std::cerr << "error: failed to run loaded 'main'" << std::endl;
+    return false;
+  }
+  if (module.GetFunction("add")->IsMaterializable() ||
+      !module.GetFunction("unused")->IsMaterializable()) {
+    std::cerr << "error: only 'main' and its callees must be loaded" << std::endl;
+    return false;
+  }
+
+  std::ostringstream oss;
+  module.Dump(oss);
+  if (oss.str() != dump) {
+    std::cerr << "error: IR changed after loading, got\n" << oss.str();
+    return false;
+  }
+  return true;
+}
+
+// a truncated file is rejected when it is opened, since the last body
+// ends at the end of file
+bool TestTruncated(const std::string &data) {
+  for (std::size_t size = 0; size < data.size(); ++size) {
+    Module module;
+    if (!WriteFile(data.substr(0, size))) return false;
+    if (ReadModule(kFile, module)) {
+      std::cerr << "error: file truncated to " << size << " bytes is accepted"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// a broken body is only rejected when it is loaded, other functions can
+// still be used
+bool TestBrokenBody(const std::string &data, std::size_t offset, uint32_t value,
+                    const char *desc) {
+  auto broken = data;
+  auto [body, size] = GetBody(data, 1);
+  Set32(broken, offset == kLastOperand ? body + size - sizeof(uint32_t)
+                                      : body + offset, value);
+  Module module;
+  if (!WriteFile(broken) || !ReadModule(kFile, module)) {
+    std::cerr << "error: failed to read file with " << desc << std::endl;
+    return false;
+  }
+  RJIT::back::JIT jit(module);
+  if (!jit.Compile({module.GetFunction("main")}) || jit.RunMain() != 42) {
+    std::cerr << "error: failed to run 'main' of file with " << desc << std::endl;
+    return false;
+  }
+  auto unused = module.GetFunction("unused");
+  if (module.Materialize(unused) || module.Materialize(unused) ||
+      module.MaterializeAll()) {
+    std::cerr << "error: body with " << desc << " is accepted" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// a file with a broken header or broken records of types or functions is
+// rejected when it is opened
+bool TestBrokenFile(const std::string &data) {
+  auto type_offset = Get32(data, kTypeOffset);
+  auto func_offset = Get32(data, kFuncOffset);
+  const std::pair<std::size_t, uint32_t> cases[] = {
+      {kMagic, 0},
+      {kVersion, 0xffffffff},
+      {kStrSize, 0xffffffff},
+      {kTypeNum, 0xffffffff},
+      {kFuncNum, 0xffffffff},
+      {type_offset, 0xff},                    // kind of type
+      {func_offset + kFuncType, 0xffff},
+      {func_offset + kBodyOffset, 0xffffffff},
+      {func_offset + kBodySize, 0xffffffff},
+  };
+  for (const auto &[offset, value] : cases) {
+    auto broken = data;
+    Set32(broken, offset, value);
+    Module module;
+    if (!WriteFile(broken)) return false;
+    if (ReadModule(kFile, module)) {
+      std::cerr << "error: file with " << value << " at offset " << offset
+                << " is accepted" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// operands of calls are allocated when decoding instruction records, so
+// the number of operands is checked before it is used
+bool TestBrokenCall(const std::string &data) {
+  auto broken = data;
+  auto body = GetBody(data, 2).first;
+  auto inst = body + kBodyHeaderSize + Get32(data, body) * kArgRecordSize +
+              Get32(data, body + kBlockNum) * kBlockRecordSize;
+  auto inst_end = inst + Get32(data, body + kInstNum) * kInstRecordSize;
+  while (inst < inst_end && Get32(data, inst) != Instruction::Call) {
+    inst += kInstRecordSize;
+  }
+  if (inst == inst_end) return false;
+  Set32(broken, inst + kInstOpNum, 0x40000000);
+  Module module;
+  if (!WriteFile(broken) || !ReadModule(kFile, module)) return false;
+  if (module.Materialize(module.GetFunction("main"))) {
+    std::cerr << "error: call with too many operands is accepted" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}
+
+int main() {
+  std::string dump;
+  {
+    RJIT::test::Program program(kSource);
+    if (!program.ok()) return 1;
+    std::ostringstream oss;
+    program.module().Dump(oss);
+    dump = oss.str();
+    if (!WriteModule(program.module(), kFile)) {
+      std::cerr << "error: failed to write binary IR" << std::endl;
+      return 1;
+    }
+  }
+  std::ifstream ifs(kFile, std::ios::binary);
+  std::string data(std::istreambuf_iterator<char>(ifs), {});
+
+  if (!TestRoundTrip(dump) || !TestTruncated(data)) return 1;
+  if (!TestBrokenBody(data, kInstNum, 0xffff, "wrong size") ||
+      !TestBrokenBody(data, kOpNum, 0xffffffff, "operands out of body") ||
+      !TestBrokenBody(data, kLastOperand, 0x7fffffff, "undefined operand") ||
+      !TestBrokenFile(data) || !TestBrokenCall(data)) {
+    return 1;
+  }
+  std::cout << "binary IR of " << data.size() << " bytes checked" << std::endl;
+  return 0;
+}
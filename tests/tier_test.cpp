@@ -0,0 +1,94 @@
+#include <iostream>
+
+#include "compile.h"
+#include "back/interp/interpreter.h"
+#include "back/jit/jit.h"
+#include "opt/pass_manager.h"
+
+using namespace RJIT::back;
+using namespace RJIT::opt;
+
+namespace {
+
+// 'step' tiers up by calls, the loop of 'run' by back edges while it is
+// running, so the invocation continues in native code mid-iteration.
+// Value live at loop header is a phi at -O1
+const char *kSource = R"(
+def step(x int, i int) int {
+  return (x * 31 + i) % 1000003;
+}
+
+def run(n int) int {
+  var a = 0 : int;
+  var b = 0 : int;
+  var i = 0 : int;
+  var s = 0 : int;
+  if n < 1 {
+    a = 3;
+  } else {
+    a = n;
+  }
+  b = a;
+  a = 5;
+  while i < n {
+    s = step(s + b, i);
+    i = i + 1;
+  }
+  return s + a;
+}
+
+def main() int {
+  return run(50000);
+}
+)";
+
+// run 'main' of source, return false if failed
+bool Run(bool tiered, std::size_t opt_level, int &ret) {
+  RJIT::test::Program program(kSource);
+  if (!program.ok()) return false;
+  PassManager::SetModule(program.module());
+  PassManager::SetOptLevel(opt_level);
+
+  JIT jit(program.module());
+  interp::Interpreter interp(program.module());
+  if (!interp.Compile()) return false;
+  if (tiered) {
+    interp::TierOptions opts;
+    opts.optimize = [](RJIT::mid::Function *F) { PassManager::RunPasses(F); };
+    interp.EnableTiering(jit, opts);
+  }
+  ret = interp.RunMain();
+  if (interp.trapped()) return false;
+  if (!tiered) return true;
+
+  // both functions must be in native code, and loop must be entered
+  auto step = interp.GetFunction("step"), run = interp.GetFunction("run");
+  if (!step->native || !run->native) {
+    std::cerr << "error: function not compiled at -O" << opt_level << std::endl;
+    return false;
+  }
+  if (run->osr_entries.empty() || !run->osr_entries[0]) {
+    std::cerr << "error: no OSR entry of loop at -O" << opt_level << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}
+
+int main() {
+  PassManager::Initialize();
+  int expected;
+  if (!Run(false, 0, expected)) return 1;
+  for (std::size_t level = 0; level <= 1; ++level) {
+    int ret;
+    if (!Run(true, level, ret)) return 1;
+    if (ret != expected) {
+      std::cerr << "error: tiered run at -O" << level << " returns " << ret
+                << ", interpreter returns " << expected << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "tiered runs return " << expected << std::endl;
+  return 0;
+}
@@ -0,0 +1,149 @@
+#ifndef RJIT_TESTS_TREEWALK_H
+#define RJIT_TESTS_TREEWALK_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "define/AST.h"
+#include "lib/debug.h"
+
+namespace RJIT::test {
+
+/* TreeWalker
+ * Naive evaluator of analyzed AST, the baseline of execution benchmarks.
+ * Nodes are dispatched by 'dynamic_cast', variables of each call live
+ * in a hash map keyed by symbol. Integer programs only, the language
+ * has no 'break' and 'continue' yet.
+ */
+class TreeWalker {
+private:
+  using Env = std::unordered_map<lib::Symbol, uint32_t>;
+
+  std::unordered_map<lib::Symbol, AST::FunctionDefAST *> _funcs;
+  std::vector<Env>                                       _frames;
+  uint32_t                                               _ret = 0;
+
+  Env &env() { return _frames.back(); }
+
+  uint32_t Call(AST::FunctionDefAST *func, const std::vector<uint32_t> &args) {
+    auto proto = static_cast<AST::ProtoTypeAST *>(func->getProtoType());
+    _frames.emplace_back();
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      auto param = static_cast<AST::FuncParamAST *>(proto->getArgs()[i]);
+      env()[param->getSymbol()] = args[i];
+    }
+    _ret = 0;
+    Exec(func->getBody());
+    _frames.pop_back();
+    return _ret;
+  }
+
+  static uint32_t Binary(AST::Operator op, uint32_t lhs, uint32_t rhs) {
+    using AST::Operator;
+    auto slhs = static_cast<int32_t>(lhs), srhs = static_cast<int32_t>(rhs);
+    switch (op) {
+      case Operator::Add:      return lhs + rhs;
+      case Operator::Sub:      return lhs - rhs;
+      case Operator::Mul:      return lhs * rhs;
+      case Operator::SDiv:     return static_cast<uint32_t>(slhs / srhs);
+      case Operator::UDiv:     return lhs / rhs;
+      case Operator::SRem:     return static_cast<uint32_t>(slhs % srhs);
+      case Operator::URem:     return lhs % rhs;
+      case Operator::And:      case Operator::LAnd: return lhs & rhs;
+      case Operator::Or:       case Operator::LOr:  return lhs | rhs;
+      case Operator::Xor:      return lhs ^ rhs;
+      case Operator::Shl:      return lhs << (rhs & 31);
+      case Operator::AShr:     return static_cast<uint32_t>(slhs >> (rhs & 31));
+      case Operator::LShr:     return lhs >> (rhs & 31);
+      case Operator::Equal:    return lhs == rhs;
+      case Operator::NotEqual: return lhs != rhs;
+      case Operator::SLess:    return slhs < srhs;
+      case Operator::ULess:    return lhs < rhs;
+      case Operator::SLessEq:  return slhs <= srhs;
+      case Operator::ULessEq:  return lhs <= rhs;
+      case Operator::SGreat:   return slhs > srhs;
+      case Operator::UGreat:   return lhs > rhs;
+      case Operator::SGreatEq: return slhs >= srhs;
+      case Operator::UGreatEq: return lhs >= rhs;
+      default:
+        DBG_ASSERT(0, "unsupported operator in tree walker");
+        return 0;
+    }
+  }
+
+  uint32_t Eval(AST::ASTPtr node) {
+    if (auto num = dynamic_cast<AST::IntAST *>(node)) {
+      return static_cast<uint32_t>(num->getValue());
+    } else if (auto var = dynamic_cast<AST::VariableAST *>(node)) {
+      return env()[var->getSymbol()];
+    } else if (auto bin = dynamic_cast<AST::BinaryStmt *>(node)) {
+      if (bin->getOp() == AST::Operator::Assign) {
+        auto var = static_cast<AST::VariableAST *>(bin->getLHS());
+        return env()[var->getSymbol()] = Eval(bin->getRHS());
+      }
+      auto lhs = Eval(bin->getLHS());
+      return Binary(bin->getOp(), lhs, Eval(bin->getRHS()));
+    } else if (auto unary = dynamic_cast<AST::UnaryStmt *>(node)) {
+      auto value = Eval(unary->Operand());
+      switch (unary->op()) {
+        case AST::Operator::Neg:  return 0 - value;
+        case AST::Operator::Not:  return ~value;
+        case AST::Operator::LNot: return !value;
+        default:                  return value;
+      }
+    } else if (auto call = dynamic_cast<AST::CallStmt *>(node)) {
+      std::vector<uint32_t> args;
+      for (const auto &arg : call->getArgs()) args.push_back(Eval(arg));
+      return Call(_funcs.at(call->getSymbol()), args);
+    }
+    DBG_ASSERT(0, "unsupported expression in tree walker");
+    return 0;
+  }
+
+  // execute statement, return true if it returns from function
+  bool Exec(AST::ASTPtr node) {
+    if (auto block = dynamic_cast<AST::CompoundStmt *>(node)) {
+      for (const auto &stmt : block->stmts()) {
+        if (Exec(stmt)) return true;
+      }
+    } else if (auto decl = dynamic_cast<AST::VariableDecl *>(node)) {
+      for (const auto &it : decl->getDefs()) {
+        auto def = static_cast<AST::VariableDefAST *>(it);
+        env()[def->getSymbol()] = def->hasInit() ? Eval(def->getInitValue()) : 0;
+      }
+    } else if (auto stmt = dynamic_cast<AST::IfElseStmt *>(node)) {
+      if (Eval(stmt->getCondition())) return Exec(stmt->getThen());
+      if (stmt->hasElse()) return Exec(stmt->getElse());
+    } else if (auto loop = dynamic_cast<AST::WhileStmt *>(node)) {
+      while (Eval(loop->getCondition())) {
+        if (Exec(loop->getBlock())) return true;
+      }
+    } else if (auto ret = dynamic_cast<AST::ReturnStmt *>(node)) {
+      if (ret->hasReturnVal()) _ret = Eval(ret->getReturn());
+      return true;
+    } else {
+      Eval(node);
+    }
+    return false;
+  }
+
+public:
+  explicit TreeWalker(AST::ASTPtr unit) {
+    for (const auto &decl : static_cast<AST::TranslationUnitDecl *>(unit)->Decls()) {
+      if (auto func = dynamic_cast<AST::FunctionDefAST *>(decl)) {
+        auto proto = static_cast<AST::ProtoTypeAST *>(func->getProtoType());
+        _funcs[proto->getSymbol()] = func;
+      }
+    }
+  }
+
+  // call 'main' function, return its return value
+  int RunMain() {
+    return static_cast<int>(Call(_funcs.at(lib::Intern("main")), {}));
+  }
+};
+
+}
+
+#endif //RJIT_TESTS_TREEWALK_H
@@ -0,0 +1,46 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "mid/ir/constant.h"
+#include "mid/ir/module.h"
+#include "mid/ir/ssa.h"
+
+using namespace RJIT::mid;
+
+// replace all uses of a value used one million times, uses are unlinked
+// in constant time, so that it takes linear time in total
+int main() {
+  constexpr std::size_t kUses = 1000000;
+  Module module;
+  auto old_value = module.New<ConstantInt>(1);
+  auto new_value = module.New<ConstantInt>(2);
+  auto pointer = module.New<AllocaInst>();
+  std::vector<StoreInst *> stores;
+  stores.reserve(kUses);
+  for (std::size_t i = 0; i < kUses; ++i) {
+    stores.push_back(module.New<StoreInst>(old_value, pointer));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  old_value->ReplaceBy(new_value);
+  std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+
+  std::size_t uses = 0;
+  for ([[maybe_unused]] const auto &use : new_value->uses()) ++uses;
+  if (!old_value->uses().empty() || uses != kUses) {
+    std::cerr << "error: " << uses << " uses after replacement, expected "
+              << kUses << std::endl;
+    return 1;
+  }
+  for (const auto &store : stores) {
+    if (store->value() != new_value) {
+      std::cerr << "error: store still uses replaced value" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "replaced " << kUses << " uses in " << time.count() << " ms" << std::endl;
+  return 0;
+}